@@ -0,0 +1,86 @@
+#version 450
+#extension GL_KHR_shader_subgroup_ballot : require
+
+// matches CULL_WORKGROUP_SIZE
+layout(local_size_x = 64) in;
+
+struct Object {
+    mat4 model;
+    uint textureIndex;
+    uint flags;
+    float boundingRadius;
+};
+
+layout(std140, set = 0, binding = 0) readonly buffer ObjectBuffer {
+    Object objects[];
+} objectData;
+
+// laid out as VkDrawIndexedIndirectCommand
+struct DrawCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer SourceDraws {
+    DrawCommand draws[];
+} sourceDraws;
+
+layout(std430, set = 0, binding = 2) buffer CulledDraws {
+    DrawCommand draws[];
+} culledDraws;
+
+layout(std430, set = 0, binding = 3) writeonly buffer VisibleInstances {
+    uint indices[];
+} visibleInstances;
+
+layout(push_constant) uniform CullParams {
+    vec4 planes[6];
+} cull;
+
+bool sphereVisible(vec3 center, float radius) {
+    for (int i = 0; i < 6; i++) {
+        if (dot(cull.planes[i].xyz, center) + cull.planes[i].w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void main() {
+    // one row of workgroups per draw, so a subgroup never mixes instances of different draws
+    uint draw = gl_WorkGroupID.y;
+    DrawCommand source = sourceDraws.draws[draw];
+
+    // the counts were cleared before the dispatch, the rest of the command is copied once per draw
+    if (gl_GlobalInvocationID.x == 0) {
+        culledDraws.draws[draw].indexCount = source.indexCount;
+        culledDraws.draws[draw].firstIndex = source.firstIndex;
+        culledDraws.draws[draw].vertexOffset = source.vertexOffset;
+        culledDraws.draws[draw].firstInstance = source.firstInstance;
+    }
+
+    bool visible = false;
+    uint instance = source.firstInstance + gl_GlobalInvocationID.x;
+    if (gl_GlobalInvocationID.x < source.instanceCount) {
+        mat4 model = objectData.objects[instance].model;
+        float scale = max(length(model[0].xyz), max(length(model[1].xyz), length(model[2].xyz)));
+        visible = sphereVisible(model[3].xyz, objectData.objects[instance].boundingRadius * scale);
+    }
+
+    // every lane takes part in the ballot, so one atomic reserves the slots of the whole subgroup and each visible
+    // lane's slot is its rank among the visible lanes
+    uvec4 ballot = subgroupBallot(visible);
+    uint visibleCount = subgroupBallotBitCount(ballot);
+    uint base = 0;
+    if (subgroupElect() && visibleCount > 0) {
+        base = atomicAdd(culledDraws.draws[draw].instanceCount, visibleCount);
+    }
+    base = subgroupBroadcastFirst(base);
+
+    if (visible) {
+        visibleInstances.indices[source.firstInstance + base + subgroupBallotExclusiveBitCount(ballot)] = instance;
+    }
+}
@@ -1,16 +1,91 @@
 #version 450
 
+#ifdef BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+#else
 layout(set = 1, binding = 0) uniform sampler2D material;
+#endif
+
+layout(set = 2, binding = 0) uniform sampler2D pageCache;
+layout(set = 2, binding = 1) uniform usampler2D pageTable;
+// storing from a fragment shader needs fragmentStoresAndAtomics, without it the virtual texture is off and this
+// is compiled out
+#ifndef NO_FEEDBACK
+layout(set = 2, binding = 2) buffer Feedback {
+    uint requests[];
+} feedback;
+#endif
+
+layout(push_constant) uniform VirtualTextureParams {
+    uint enabled;
+    uint feedbackJitter;
+    uint pageSize;
+    uint pageBorder;
+    uint pageCount;
+    uint mipCount;
+    uint cacheTiles;
+} virtualTexture;
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
 layout(location = 2) in vec3 fragNormal;
+layout(location = 3) flat in uint fragTextureIndex;
+layout(location = 4) flat in uint fragFlags;
+
+// matches OBJECT_FLAG_VIRTUAL_TEXTURE
+const uint objectFlagVirtualTexture = 1u;
 
 layout(location = 0) out vec4 outColor;
 
 const vec4 sunColor = vec4(1.0);
 const vec3 sunDirection = normalize(vec3(1.0, 1.0, -1.0));
 
+vec4 sampleVirtualTexture(vec2 uv) {
+    // pick the virtual mip from the screen space footprint of one virtual texel
+    float virtualSize = float(virtualTexture.pageCount * virtualTexture.pageSize);
+    vec2 dx = dFdx(uv) * virtualSize;
+    vec2 dy = dFdy(uv) * virtualSize;
+    float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1.0));
+    uint mip = min(uint(lod), virtualTexture.mipCount - 1);
+
+    vec2 wrapped = fract(uv);
+    uint pagesAtMip = virtualTexture.pageCount >> mip;
+    uvec2 page = min(uvec2(wrapped * float(pagesAtMip)), uvec2(pagesAtMip - 1));
+
+#ifndef NO_FEEDBACK
+    // one pixel of every 4x4 block reports what it wants, a different one each frame
+    uvec2 pixel = uvec2(gl_FragCoord.xy) & 3u;
+    if (pixel.x == (virtualTexture.feedbackJitter & 3u) && pixel.y == (virtualTexture.feedbackJitter >> 2)) {
+        uint offset = 0;
+        for (uint i = 0; i < mip; i++) {
+            uint pages = virtualTexture.pageCount >> i;
+            offset += pages * pages;
+        }
+        feedback.requests[offset + page.y * pagesAtMip + page.x] = 1;
+    }
+#endif
+
+    // the entry points at the finest resident page covering this one
+    uvec4 entry = texelFetch(pageTable, ivec2(page), int(mip));
+    uint pagesAtEntryMip = virtualTexture.pageCount >> entry.z;
+    vec2 inPage = fract(wrapped * float(pagesAtEntryMip));
+
+    float tileSize = float(virtualTexture.pageSize + 2 * virtualTexture.pageBorder);
+    vec2 cacheTexel = vec2(entry.xy) * tileSize + float(virtualTexture.pageBorder) + inPage * float(virtualTexture.pageSize);
+    return textureLod(pageCache, cacheTexel / (tileSize * float(virtualTexture.cacheTiles)), 0.0);
+}
+
+vec4 sampleMaterial(vec2 uv) {
+#ifdef BINDLESS
+    return texture(textures[nonuniformEXT(fragTextureIndex)], uv);
+#else
+    return texture(material, uv);
+#endif
+}
+
 void main() {
-    outColor = sunColor * max(0.0, dot(fragNormal, -sunDirection)) * vec4(fragColor, 1.0) * texture(material, fragTexCoord);
+    bool useVirtualTexture = virtualTexture.enabled != 0 && (fragFlags & objectFlagVirtualTexture) != 0;
+    vec4 albedo = useVirtualTexture ? sampleVirtualTexture(fragTexCoord) : sampleMaterial(fragTexCoord);
+    outColor = sunColor * max(0.0, dot(fragNormal, -sunDirection)) * vec4(fragColor, 1.0) * albedo;
 }
@@ -6,10 +6,24 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
     mat4 viewProjection;
 } cameraData;
 
+struct Object {
+    mat4 model;
+    uint textureIndex;
+    uint flags;
+    float boundingRadius;
+};
+
 layout(std140, set = 0, binding = 1) readonly buffer storageBuffer {
-    mat4 model[];
+    Object objects[];
 } ObjectData;
 
+#ifdef CULLING
+// written by the culling pass, where in the object data each surviving instance is
+layout(std430, set = 0, binding = 2) readonly buffer VisibleInstances {
+    uint indices[];
+} visibleInstances;
+#endif
+
 layout(location = 0) in vec3 vertexPosition;
 layout(location = 1) in vec3 vertexColor;
 layout(location = 2) in vec2 vertexTexCoord;
@@ -18,10 +32,20 @@ layout(location = 3) in vec3 vertexNormal;
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 layout(location = 2) out vec3 fragNormal;
+layout(location = 3) flat out uint fragTextureIndex;
+layout(location = 4) flat out uint fragFlags;
 
 void main() {
-    gl_Position = cameraData.viewProjection * ObjectData.model[gl_InstanceIndex] * vec4(vertexPosition, 1.0);
+#ifdef CULLING
+    uint objectIndex = visibleInstances.indices[gl_InstanceIndex];
+#else
+    uint objectIndex = gl_InstanceIndex;
+#endif
+    mat4 model = ObjectData.objects[objectIndex].model;
+    gl_Position = cameraData.viewProjection * model * vec4(vertexPosition, 1.0);
     fragColor = vertexColor;
     fragTexCoord = vertexTexCoord;
-    fragNormal = normalize((ObjectData.model[gl_InstanceIndex] * vec4(vertexNormal, 0.0)).xyz);
+    fragNormal = normalize((model * vec4(vertexNormal, 0.0)).xyz);
+    fragTextureIndex = ObjectData.objects[objectIndex].textureIndex;
+    fragFlags = ObjectData.objects[objectIndex].flags;
 }
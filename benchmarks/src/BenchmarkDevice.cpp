@@ -0,0 +1,83 @@
+#include "BenchmarkDevice.h"
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    BenchmarkDevice::BenchmarkDevice() {
+    }
+
+    BenchmarkDevice::~BenchmarkDevice() {
+    }
+
+    void BenchmarkDevice::init(const std::string& title) {
+        WindowCreationProperties properties;
+        properties.title = title;
+        m_window = std::make_shared<GLFWWindow>(properties);
+
+        createInstance(title);
+        createSurface();
+        m_vulkanDevice.pickPhysicalDevice(m_vkInstance, m_vkSurface);
+        m_vulkanDevice.createLogicalDevice(m_vkSurface);
+        createCommandPool();
+    }
+
+    void BenchmarkDevice::shutdown() {
+        m_vulkanDevice.logicalDevice().waitIdle();
+        m_vulkanDevice.deletionQueue().flush();
+        m_vulkanDevice.logicalDevice().destroyCommandPool(m_vkCommandPool);
+        m_vulkanDevice.shutdown();
+        m_vkInstance.destroySurfaceKHR(m_vkSurface);
+        m_vkInstance.destroy();
+        m_window.reset();
+    }
+
+    void BenchmarkDevice::createInstance(const std::string& title) {
+        vk::ApplicationInfo appInfo(title.c_str(), VK_MAKE_VERSION(1, 0, 0), "Genesis", VK_MAKE_VERSION(1, 0, 0), VK_API_VERSION_1_2);
+
+        // no validation layers, they would be timed along with the engine
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions = m_window->getRequiredVulkanInstanceExtensions(&glfwExtensionCount);
+        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+
+        vk::InstanceCreateInfo createInfo = {};
+        createInfo.pApplicationInfo = &appInfo;
+#if defined(GN_PLATFORM_MACOS)
+        extensions.emplace_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
+        createInfo.flags |= vk::InstanceCreateFlagBits::eEnumeratePortabilityKHR;
+#endif
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        createInfo.ppEnabledExtensionNames = extensions.data();
+
+        try {
+            m_vkInstance = vk::createInstance(createInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Unable to create Vulkan instance: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+    }
+
+    void BenchmarkDevice::createSurface() {
+        VkSurfaceKHR cStyleSurface;
+        if (!m_window->createVulkanSurface(m_vkInstance, &cStyleSurface)) {
+            std::string errMsg = "Failed to create window surface.";
+            GN_CORE_ERROR("{}", errMsg);
+            throw std::runtime_error(errMsg);
+        }
+        m_vkSurface = cStyleSurface;
+    }
+
+    void BenchmarkDevice::createCommandPool() {
+        vk::CommandPoolCreateInfo poolInfo = {};
+        poolInfo.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+        poolInfo.queueFamilyIndex = m_vulkanDevice.graphicsQueueFamily();
+
+        try {
+            m_vkCommandPool = m_vulkanDevice.logicalDevice().createCommandPool(poolInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create command pool: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+    }
+}  // namespace Genesis
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Platform/GLFWWindow.h"
+#include "Renderer/Vulkan/VulkanDevice.h"
+
+namespace Genesis {
+    // The window, instance, surface and device the renderer would create, without the renderer around them, so a
+    // benchmark can drive one engine component on its own. The device is picked and set up exactly as at runtime.
+    class BenchmarkDevice {
+        public:
+            BenchmarkDevice();
+            ~BenchmarkDevice();
+
+            BenchmarkDevice(const BenchmarkDevice&) = delete;
+            BenchmarkDevice& operator=(const BenchmarkDevice&) = delete;
+
+            std::shared_ptr<GLFWWindow> const& window() const { return m_window; }
+            vk::SurfaceKHR const& surface() const { return m_vkSurface; }
+            VulkanDevice& device() { return m_vulkanDevice; }
+            // graphics family, resettable command buffers
+            vk::CommandPool const& commandPool() const { return m_vkCommandPool; }
+
+            void init(const std::string& title);
+            void shutdown();
+
+        private:
+            void createInstance(const std::string& title);
+            void createSurface();
+            void createCommandPool();
+
+            std::shared_ptr<GLFWWindow> m_window;
+            vk::Instance m_vkInstance{nullptr};
+            vk::SurfaceKHR m_vkSurface;
+            VulkanDevice m_vulkanDevice;
+            vk::CommandPool m_vkCommandPool;
+    };
+}  // namespace Genesis
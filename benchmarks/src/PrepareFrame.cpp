@@ -0,0 +1,103 @@
+// Times VulkanSwapchain::prepareFrame, the per frame camera and object data writes, for a synthetic scene of a fixed
+// number of instances spread over the mesh types: once writing every instance, as with GPU culling, and once through
+// a visible list holding every other instance, as after CPU culling.
+//
+//     prepareframe [instance count, default one hundred thousand]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+#include "BenchmarkDevice.h"
+#include "Core/Logger.h"
+#include "Core/Scene.h"
+#include "Renderer/Vulkan/VulkanPipeline.h"
+#include "Renderer/Vulkan/VulkanSwapchain.h"
+
+// timings are the best of this many runs of PREPARED_FRAMES frames, cycling through the frames in flight
+static constexpr uint32_t BENCHMARK_RUNS = 10;
+static constexpr uint32_t PREPARED_FRAMES = 100;
+static constexpr size_t DEFAULT_INSTANCE_COUNT = 100000;
+
+static double bestOf(const std::function<void(uint32_t frame)>& prepare) {
+    // the first frames grow the frame allocator and allocate the descriptor sets, they are not timed
+    for (uint32_t frame = 0; frame < PREPARED_FRAMES; frame++) {
+        prepare(frame);
+    }
+
+    double best = 0.0;
+    for (uint32_t i = 0; i < BENCHMARK_RUNS; i++) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t frame = 0; frame < PREPARED_FRAMES; frame++) {
+            prepare(frame);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / PREPARED_FRAMES;
+        best = i == 0 ? seconds : std::min(best, seconds);
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    Genesis::Logger::init("Benchmark");
+    size_t instanceCount = argc > 1 ? std::stoull(argv[1]) : DEFAULT_INSTANCE_COUNT;
+
+    Genesis::BenchmarkDevice benchmarkDevice;
+    benchmarkDevice.init("prepareFrame benchmark");
+    Genesis::VulkanDevice& vulkanDevice = benchmarkDevice.device();
+
+    // the frames need the swapchain's extent for the camera and a render pass for their framebuffers, nothing is drawn
+    Genesis::VulkanSwapchain vulkanSwapchain;
+    Genesis::VulkanPipeline vulkanPipeline;
+    vulkanSwapchain.createSwapChain(vulkanDevice, benchmarkDevice.surface(), benchmarkDevice.window());
+    vulkanPipeline.createRenderPass(vulkanDevice, vulkanSwapchain);
+    vulkanSwapchain.createDescriptorSetLayouts(vulkanDevice);
+    vulkanSwapchain.createFrameResources(vulkanDevice, vulkanPipeline.renderPass(), benchmarkDevice.commandPool());
+
+    // instances on a grid in front of the camera, dealt out to the mesh types in turn
+    const std::array<Genesis::meshTypes, 3> objectTypes = {Genesis::meshTypes::GROUND, Genesis::meshTypes::GIRL, Genesis::meshTypes::SKULL};
+    Genesis::Scene scene;
+    std::unordered_map<Genesis::meshTypes, Genesis::ObjectMaterial> materials;
+    for (Genesis::meshTypes objectType : objectTypes) {
+        scene.positions[objectType].clear();
+        materials[objectType].boundingRadius = 1.0f;
+    }
+    size_t gridSize = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(instanceCount))));
+    for (size_t i = 0; i < instanceCount; i++) {
+        glm::vec3 position(static_cast<float>(i / gridSize) * 2.0f + 5.0f, static_cast<float>(i % gridSize) * 2.0f, 0.0f);
+        scene.positions[objectTypes[i % objectTypes.size()]].push_back(position);
+    }
+
+    // instances are numbered type after type in the scene's order, any ascending list of them is a valid culling result
+    std::vector<uint32_t> visibleInstances;
+    for (size_t i = 0; i < instanceCount; i += 2) {
+        visibleInstances.push_back(static_cast<uint32_t>(i));
+    }
+
+    uint32_t framesInFlight = vulkanSwapchain.framesInFlight();
+    double allSeconds = bestOf([&](uint32_t frame) { vulkanSwapchain.prepareFrame(vulkanDevice, frame % framesInFlight, scene, materials); });
+    double visibleSeconds = bestOf([&](uint32_t frame) {
+        vulkanSwapchain.prepareFrame(vulkanDevice, frame % framesInFlight, scene, materials, &visibleInstances);
+    });
+
+    GN_CLIENT_INFO("prepareFrame with {} instances: all written {:.1f} us ({:.1f} ns per instance), {} visible {:.1f} us ({:.1f} ns per instance).",
+                   instanceCount,
+                   allSeconds * 1e6,
+                   instanceCount > 0 ? allSeconds * 1e9 / instanceCount : 0.0,
+                   visibleInstances.size(),
+                   visibleSeconds * 1e6,
+                   !visibleInstances.empty() ? visibleSeconds * 1e9 / visibleInstances.size() : 0.0);
+
+    vulkanDevice.logicalDevice().waitIdle();
+    vulkanDevice.deletionQueue().flush();
+    vulkanSwapchain.cleanupSwapChain(vulkanDevice);
+    vulkanSwapchain.destroyFrames(vulkanDevice, benchmarkDevice.commandPool());
+    vulkanDevice.logicalDevice().destroyDescriptorSetLayout(vulkanSwapchain.frameDescriptorSetLayout());
+    vulkanDevice.logicalDevice().destroyDescriptorSetLayout(vulkanSwapchain.meshDescriptorSetLayout());
+    vulkanPipeline.destroy(vulkanDevice);
+    benchmarkDevice.shutdown();
+
+    quill::flush();
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Uploads the same textures, whole mip chains, through both streaming paths and times each until the images are
+// written: VulkanUploader's staging ring on the transfer queue, waited on with the uploader's waitIdle, and host image
+// copies on the thread pool, waited on with a latch over those jobs. The uploads are discarded again, not committed.
+//
+//     textureupload [image files, default the testbed textures]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <latch>
+
+#include "BenchmarkDevice.h"
+#include "Core/Logger.h"
+#include "Core/ThreadPool.h"
+#include "Renderer/Vulkan/VulkanBindlessTextures.h"
+#include "Renderer/Vulkan/VulkanTexture.h"
+#include "Renderer/Vulkan/VulkanUploadBatch.h"
+#include "Renderer/Vulkan/VulkanUploader.h"
+#include "Resources/TextureDecoder.h"
+
+// timings are the best of this many runs, the first one pays for the driver's first use of the memory
+static constexpr uint32_t BENCHMARK_RUNS = 5;
+
+static double bestOf(Genesis::VulkanDevice& vulkanDevice,
+                     const std::vector<std::unique_ptr<Genesis::VulkanTexture>>& textures,
+                     const std::function<void()>& run) {
+    double best = 0.0;
+    for (uint32_t i = 0; i < BENCHMARK_RUNS; i++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = i == 0 ? seconds : std::min(best, seconds);
+
+        // nothing is using the new images once run returns, they go before the next run allocates its own
+        for (const auto& texture : textures) {
+            texture->discardResidencyChange(vulkanDevice);
+        }
+        vulkanDevice.logicalDevice().waitIdle();
+        vulkanDevice.deletionQueue().flush();
+    }
+    return best;
+}
+
+static void uploadStaging(Genesis::VulkanDevice& vulkanDevice,
+                          Genesis::VulkanUploader& uploader,
+                          const std::vector<std::unique_ptr<Genesis::VulkanTexture>>& textures) {
+    for (const auto& texture : textures) {
+        vk::DeviceSize size = texture->mipChainSize(0);
+        Genesis::UploadStaging staging = uploader.stage(vulkanDevice, size);
+        if (!staging.data) {
+            // the ring is full of this run's earlier uploads, the streamer would wait a frame for them as well
+            uploader.submit(vulkanDevice);
+            uploader.waitIdle(vulkanDevice);
+            staging = uploader.stage(vulkanDevice, size);
+        }
+        texture->recordResidencyChange(vulkanDevice, uploader.commandBuffer(vulkanDevice), staging.buffer, staging.offset, staging.data, 0);
+        uploader.releaseImage(texture->pendingImage(), texture->pendingMipLevels());
+    }
+    uploader.submit(vulkanDevice);
+    uploader.waitIdle(vulkanDevice);
+}
+
+static void uploadHostCopy(Genesis::VulkanDevice& vulkanDevice,
+                           Genesis::ThreadPool& threadPool,
+                           const std::vector<std::unique_ptr<Genesis::VulkanTexture>>& textures) {
+    std::latch copied(static_cast<std::ptrdiff_t>(textures.size()));
+    std::atomic<bool> failed = false;
+    for (const auto& texture : textures) {
+        // created on this thread like the streamer does, only the copy runs on a worker
+        texture->createPendingImage(vulkanDevice, 0);
+        Genesis::VulkanTexture* pending = texture.get();
+        threadPool.submit([&vulkanDevice, &copied, &failed, pending] {
+            try {
+                pending->hostCopyResidencyChange(vulkanDevice);
+            } catch (std::exception err) {
+                GN_CLIENT_ERROR("Host copy of {} failed: {}", pending->filename(), err.what());
+                failed = true;
+            }
+            copied.count_down();
+        });
+    }
+    copied.wait();
+
+    if (failed) {
+        std::string errMsg = "Failed to upload textures with host image copies.";
+        GN_CLIENT_ERROR("{}", errMsg);
+        throw std::runtime_error(errMsg);
+    }
+}
+
+int main(int argc, char** argv) {
+    Genesis::Logger::init("Benchmark");
+
+    std::vector<std::string> filenames;
+    for (int i = 1; i < argc; i++) {
+        filenames.push_back(argv[i]);
+    }
+    if (filenames.empty()) {
+        filenames = {"assets/textures/ground.jpg", "assets/textures/none.png", "assets/textures/skull.png"};
+    }
+
+    Genesis::BenchmarkDevice benchmarkDevice;
+    benchmarkDevice.init("Texture upload benchmark");
+    Genesis::VulkanDevice& vulkanDevice = benchmarkDevice.device();
+    Genesis::ThreadPool threadPool;
+
+    // the textures are created as the renderer creates them, only their low resolution tails are resident
+    Genesis::VulkanBindlessTextures bindlessTextures;
+    bindlessTextures.init(vulkanDevice);
+    vk::DescriptorSetLayoutBinding samplerLayoutBinding = {};
+    samplerLayoutBinding.binding = 0;
+    samplerLayoutBinding.descriptorCount = 1;
+    samplerLayoutBinding.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+    samplerLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
+    vk::DescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &samplerLayoutBinding;
+    vk::DescriptorSetLayout textureLayout = vulkanDevice.logicalDevice().createDescriptorSetLayout(layoutInfo);
+
+    std::vector<std::unique_ptr<Genesis::VulkanTexture>> textures;
+    vk::DeviceSize totalBytes = 0;
+    {
+        Genesis::TextureDecoder textureDecoder(threadPool);
+        for (const std::string& filename : filenames) {
+            textureDecoder.submit(filename);
+        }
+        Genesis::VulkanUploadBatch uploadBatch;
+        uploadBatch.begin(vulkanDevice, benchmarkDevice.commandPool());
+        while (std::unique_ptr<Genesis::TextureData> textureData = textureDecoder.next()) {
+            textures.push_back(std::make_unique<Genesis::VulkanTexture>(vulkanDevice, std::move(textureData), uploadBatch, textureLayout, bindlessTextures));
+            totalBytes += textures.back()->mipChainSize(0);
+        }
+        uploadBatch.submit(vulkanDevice);
+        uploadBatch.wait(vulkanDevice);
+    }
+
+    Genesis::VulkanUploader uploader;
+    uploader.init(vulkanDevice);
+
+    double stagingSeconds = bestOf(vulkanDevice, textures, [&] { uploadStaging(vulkanDevice, uploader, textures); });
+    double megabytes = static_cast<double>(totalBytes) / (1024.0 * 1024.0);
+    GN_CLIENT_INFO("Uploading {} textures, {:.1f} MiB: staging buffer {:.3f} ms ({:.1f} MiB/s).",
+                   textures.size(),
+                   megabytes,
+                   stagingSeconds * 1e3,
+                   megabytes / stagingSeconds);
+
+    bool hostCopy = std::all_of(textures.begin(), textures.end(), [](const auto& texture) { return texture->usesHostImageCopy(); });
+    if (hostCopy) {
+        double hostCopySeconds = bestOf(vulkanDevice, textures, [&] { uploadHostCopy(vulkanDevice, threadPool, textures); });
+        GN_CLIENT_INFO("Uploading {} textures, {:.1f} MiB: host image copy on {} threads {:.3f} ms ({:.1f} MiB/s, {:.1f}x).",
+                       textures.size(),
+                       megabytes,
+                       threadPool.threadCount(),
+                       hostCopySeconds * 1e3,
+                       megabytes / hostCopySeconds,
+                       stagingSeconds / hostCopySeconds);
+    } else {
+        GN_CLIENT_INFO("The device cannot copy these textures from host memory, only the staging path was timed.");
+    }
+
+    uploader.shutdown(vulkanDevice);
+    textures.clear();
+    bindlessTextures.shutdown(vulkanDevice);
+    vulkanDevice.logicalDevice().waitIdle();
+    vulkanDevice.deletionQueue().flush();
+    vulkanDevice.logicalDevice().destroyDescriptorSetLayout(textureLayout);
+    benchmarkDevice.shutdown();
+
+    quill::flush();
+    return 0;
+}
@@ -27,16 +27,40 @@ namespace Genesis {
 
     void Application::run() {
         m_previousTime = Clock::now();
+        m_renderThread = std::thread(&Application::renderLoop, this);
 
-        while (m_isRunning) {
+        std::shared_ptr<GLFWWindow> window = std::dynamic_pointer_cast<GLFWWindow>(m_window);
+        time_point previousUpdate = Clock::now();
+        while (m_isRunning && !m_renderFailed) {
             m_window->onUpdate();
-            std::shared_ptr<GLFWWindow> window = std::dynamic_pointer_cast<GLFWWindow>(m_window);
+            // the window belongs to this thread, so a minimized window is waited out here and not on the render thread
+            while (m_isRunning && (window->getWindowWidth() == 0 || window->getWindowHeight() == 0)) {
+                int width, height;
+                window->waitForWindowToBeRestored(&width, &height);
+            }
             window->updateTitle(m_currentFps);
-            m_renderer->drawFrame(m_scene);
+
+            auto updateStart = Clock::now();
+            update(*m_scene, std::chrono::duration<double>(updateStart - previousUpdate).count());
+            previousUpdate = updateStart;
+            // blocks while the renderer is a full queue behind, which paces the simulation to the render rate
+            Scene* snapshot = m_frameQueue.beginWrite();
+            if (!snapshot) {
+                break;
+            }
+            *snapshot = *m_scene;
+            m_frameQueue.endWrite();
+
             calculateFrameRate();
         }
 
+        m_frameQueue.close();
+        m_renderThread.join();
         m_renderer->waitForIdle();
+
+        if (m_renderError) {
+            std::rethrow_exception(m_renderError);
+        }
     }
 
     void Application::shutdown() {
@@ -47,6 +71,25 @@ namespace Genesis {
         m_isRunning = false;
     }
 
+    void Application::renderLoop() {
+        try {
+            while (true) {
+                const Scene* snapshot = m_frameQueue.beginRead();
+                if (!snapshot) {
+                    break;
+                }
+                m_renderer->drawFrame(*snapshot);
+                m_frameQueue.endRead();
+            }
+        } catch (const std::exception& err) {
+            // handed to the main thread, which rethrows it once this thread is joined
+            GN_CORE_ERROR("Render thread failed: {}", err.what());
+            m_renderError = std::current_exception();
+            m_renderFailed = true;
+            m_frameQueue.close();
+        }
+    }
+
     void Application::calculateFrameRate() {
         using Clock = std::chrono::steady_clock;
         using duration = std::chrono::duration<double>;
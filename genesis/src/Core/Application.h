@@ -1,6 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <exception>
+#include <thread>
+
 #include "../Events/ApplicationEvents.h"
+#include "FrameQueue.h"
 #include "InputSystem.h"
 #include "Renderer.h"
 #include "Window.h"
@@ -17,7 +22,12 @@ namespace Genesis {
 
             void onCloseEvent(Event& e);
 
+        protected:
+            // called on the main thread once per frame, the scene is snapshotted for the render thread afterwards
+            virtual void update(Scene& scene, double deltaTime) {}
+
         private:
+            void renderLoop();
             void calculateFrameRate();
 
             std::string m_applicationName;
@@ -34,6 +44,12 @@ namespace Genesis {
             std::unique_ptr<InputSystem> m_inputSystem;
             std::unique_ptr<Renderer> m_renderer;
             std::shared_ptr<Scene> m_scene;
+
+            // the render thread draws frame N from its snapshot while the main thread simulates frame N + 1
+            FrameQueue m_frameQueue;
+            std::thread m_renderThread;
+            std::atomic<bool> m_renderFailed = false;
+            std::exception_ptr m_renderError;
     };
 
     Application* createApp();
@@ -0,0 +1,56 @@
+#include "FrameQueue.h"
+
+namespace Genesis {
+    FrameQueue::FrameQueue(uint32_t slotCount) : m_slots(slotCount > 1 ? slotCount : 2) {
+    }
+
+    FrameQueue::~FrameQueue() {
+    }
+
+    Scene* FrameQueue::beginWrite() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_slotFree.wait(lock, [this] { return m_closed || m_usedSlots < m_slots.size(); });
+        if (m_closed) {
+            return nullptr;
+        }
+
+        // assigning into the slot reuses the storage of the snapshot it held before
+        return &m_slots[(m_readIndex + m_usedSlots) % m_slots.size()];
+    }
+
+    void FrameQueue::endWrite() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_usedSlots++;
+        }
+        m_snapshotReady.notify_one();
+    }
+
+    const Scene* FrameQueue::beginRead() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_snapshotReady.wait(lock, [this] { return m_closed || m_usedSlots > 0; });
+        if (m_closed) {
+            return nullptr;
+        }
+
+        return &m_slots[m_readIndex];
+    }
+
+    void FrameQueue::endRead() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_readIndex = (m_readIndex + 1) % m_slots.size();
+            m_usedSlots--;
+        }
+        m_slotFree.notify_one();
+    }
+
+    void FrameQueue::close() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_slotFree.notify_all();
+        m_snapshotReady.notify_all();
+    }
+}  // namespace Genesis
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+
+#include "Scene.h"
+
+namespace Genesis {
+    // Hands scene snapshots from the simulation thread to the render thread. The queue is a fixed ring of slots, each
+    // holding a full copy of the scene, so the renderer reads frame N while the simulation writes frame N + 1 and
+    // neither ever sees the other's copy change under it. Once every slot is taken the writer blocks, which keeps the
+    // simulation at most the ring size ahead of what is being rendered.
+    class FrameQueue {
+        public:
+            static constexpr uint32_t DEFAULT_SLOT_COUNT = 2;
+
+            FrameQueue(uint32_t slotCount = DEFAULT_SLOT_COUNT);
+            ~FrameQueue();
+
+            FrameQueue(const FrameQueue&) = delete;
+            FrameQueue& operator=(const FrameQueue&) = delete;
+
+            // blocks until a slot is free and returns it for writing, nullptr once the queue is closed
+            Scene* beginWrite();
+            // publishes the slot returned by beginWrite to the reader
+            void endWrite();
+            // blocks until a snapshot is published and returns it, nullptr once the queue is closed
+            const Scene* beginRead();
+            // hands the slot returned by beginRead back to the writer
+            void endRead();
+            // wakes both sides, every later begin returns nullptr
+            void close();
+
+        private:
+            std::vector<Scene> m_slots;
+            // the oldest slot still owned by the reader, or the next one it will read
+            uint32_t m_readIndex = 0;
+            // published slots plus the one the reader holds, the writer's slot is the one after them
+            uint32_t m_usedSlots = 0;
+            bool m_closed = false;
+
+            std::mutex m_mutex;
+            std::condition_variable m_slotFree;
+            std::condition_variable m_snapshotReady;
+    };
+}  // namespace Genesis
@@ -0,0 +1,239 @@
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <latch>
+
+#include "Core/Logger.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define GN_CULL_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #endif
+#endif
+
+// GCC and Clang only emit AVX inside functions that ask for it, MSVC emits whatever intrinsics it is given
+#if defined(__GNUC__) || defined(__clang__)
+    #define GN_TARGET_AVX __attribute__((target("avx")))
+#else
+    #define GN_TARGET_AVX
+#endif
+
+namespace Genesis {
+    // below this many spheres per range handing work to the pool costs more than culling it, a multiple of 8 so
+    // only the last range has a scalar tail
+    static constexpr size_t MIN_SPHERES_PER_RANGE = 16384;
+
+    void SphereBounds::clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+        radius.clear();
+    }
+
+    void SphereBounds::reserve(size_t count) {
+        x.reserve(count);
+        y.reserve(count);
+        z.reserve(count);
+        radius.reserve(count);
+    }
+
+    void SphereBounds::push_back(const glm::vec3& center, float sphereRadius) {
+        x.push_back(center.x);
+        y.push_back(center.y);
+        z.push_back(center.z);
+        radius.push_back(sphereRadius);
+    }
+
+    static size_t cullRangeScalar(const FrustumPlanes& planes, const SphereBounds& bounds, size_t first, size_t last, uint32_t* visible) {
+        uint32_t* out = visible;
+        for (size_t i = first; i < last; i++) {
+            bool inside = true;
+            for (const glm::vec4& plane : planes) {
+                if (plane.x * bounds.x[i] + plane.y * bounds.y[i] + plane.z * bounds.z[i] + plane.w < -bounds.radius[i]) {
+                    inside = false;
+                    break;
+                }
+            }
+            if (inside) {
+                *out++ = static_cast<uint32_t>(i);
+            }
+        }
+        return out - visible;
+    }
+
+#ifdef GN_CULL_X86
+    static size_t cullRangeSse(const FrustumPlanes& planes, const SphereBounds& bounds, size_t first, size_t last, uint32_t* visible) {
+        __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+        for (size_t p = 0; p < planes.size(); p++) {
+            planeX[p] = _mm_set1_ps(planes[p].x);
+            planeY[p] = _mm_set1_ps(planes[p].y);
+            planeZ[p] = _mm_set1_ps(planes[p].z);
+            planeW[p] = _mm_set1_ps(planes[p].w);
+        }
+
+        uint32_t* out = visible;
+        size_t i = first;
+        for (; i + 4 <= last; i += 4) {
+            __m128 x = _mm_loadu_ps(bounds.x.data() + i);
+            __m128 y = _mm_loadu_ps(bounds.y.data() + i);
+            __m128 z = _mm_loadu_ps(bounds.z.data() + i);
+            __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(bounds.radius.data() + i));
+
+            int mask = 0xf;
+            for (size_t p = 0; p < planes.size() && mask != 0; p++) {
+                // summed in the same order as glm::dot plus w, so both paths round alike
+                __m128 distance = _mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y));
+                distance = _mm_add_ps(_mm_add_ps(distance, _mm_mul_ps(planeZ[p], z)), planeW[p]);
+                mask &= _mm_movemask_ps(_mm_cmpge_ps(distance, negRadius));
+            }
+
+            // one write per survivor, in lane order so the output stays sorted
+            while (mask != 0) {
+                *out++ = static_cast<uint32_t>(i + std::countr_zero(static_cast<unsigned>(mask)));
+                mask &= mask - 1;
+            }
+        }
+
+        return (out - visible) + cullRangeScalar(planes, bounds, i, last, out);
+    }
+
+    GN_TARGET_AVX static size_t cullRangeAvx(const FrustumPlanes& planes, const SphereBounds& bounds, size_t first, size_t last, uint32_t* visible) {
+        __m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+        for (size_t p = 0; p < planes.size(); p++) {
+            planeX[p] = _mm256_set1_ps(planes[p].x);
+            planeY[p] = _mm256_set1_ps(planes[p].y);
+            planeZ[p] = _mm256_set1_ps(planes[p].z);
+            planeW[p] = _mm256_set1_ps(planes[p].w);
+        }
+
+        uint32_t* out = visible;
+        size_t i = first;
+        for (; i + 8 <= last; i += 8) {
+            __m256 x = _mm256_loadu_ps(bounds.x.data() + i);
+            __m256 y = _mm256_loadu_ps(bounds.y.data() + i);
+            __m256 z = _mm256_loadu_ps(bounds.z.data() + i);
+            __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(bounds.radius.data() + i));
+
+            int mask = 0xff;
+            for (size_t p = 0; p < planes.size() && mask != 0; p++) {
+                __m256 distance = _mm256_add_ps(_mm256_mul_ps(planeX[p], x), _mm256_mul_ps(planeY[p], y));
+                distance = _mm256_add_ps(_mm256_add_ps(distance, _mm256_mul_ps(planeZ[p], z)), planeW[p]);
+                mask &= _mm256_movemask_ps(_mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+            }
+
+            while (mask != 0) {
+                *out++ = static_cast<uint32_t>(i + std::countr_zero(static_cast<unsigned>(mask)));
+                mask &= mask - 1;
+            }
+        }
+
+        return (out - visible) + cullRangeScalar(planes, bounds, i, last, out);
+    }
+
+    static bool cpuSupportsAvx() {
+    #if defined(__GNUC__) || defined(__clang__)
+        return __builtin_cpu_supports("avx");
+    #else
+        // the CPU has to support AVX and the OS has to save the YMM registers on a context switch
+        int info[4];
+        __cpuid(info, 1);
+        bool avx = (info[2] & (1 << 28)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        return avx && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+    #endif
+    }
+#endif
+
+    FrustumCuller::FrustumCuller() {
+    }
+
+    FrustumCuller::~FrustumCuller() {
+    }
+
+    void FrustumCuller::init(ThreadPool& threadPool) {
+        m_threadPool = &threadPool;
+        m_rangeCounts.resize(m_threadPool->threadCount());
+
+        m_cullRange = cullRangeScalar;
+        m_pathName = "scalar";
+#ifdef GN_CULL_X86
+        // SSE is part of x86-64, AVX has to be asked for
+        m_cullRange = cullRangeSse;
+        m_pathName = "SSE";
+        if (cpuSupportsAvx()) {
+            m_cullRange = cullRangeAvx;
+            m_pathName = "AVX";
+        }
+#endif
+
+        GN_CORE_TRACE("Frustum culling on the CPU uses {} on up to {} threads.", m_pathName, m_threadPool->threadCount());
+    }
+
+    void FrustumCuller::cull(const FrustumPlanes& planes, const SphereBounds& bounds, std::vector<uint32_t>& visible) {
+        size_t sphereCount = bounds.size();
+        if (m_scratch.size() < sphereCount) {
+            m_scratch.resize(sphereCount);
+        }
+
+        size_t ranges = std::clamp(sphereCount / MIN_SPHERES_PER_RANGE, size_t(1), size_t(m_threadPool->threadCount()));
+        // range boundaries rounded down to whole vectors
+        auto rangeStart = [sphereCount, ranges](size_t range) {
+            return range == ranges ? sphereCount : (sphereCount * range / ranges) & ~size_t(7);
+        };
+
+        if (ranges == 1) {
+            m_rangeCounts[0] = m_cullRange(planes, bounds, 0, sphereCount, m_scratch.data());
+        } else {
+            std::latch culled(ranges);
+            std::atomic<bool> failed = false;
+            for (size_t range = 0; range < ranges; range++) {
+                size_t first = rangeStart(range);
+                size_t last = rangeStart(range + 1);
+                m_threadPool->submit([this, &planes, &bounds, &culled, &failed, range, first, last] {
+                    try {
+                        m_rangeCounts[range] = m_cullRange(planes, bounds, first, last, m_scratch.data() + first);
+                    } catch (std::exception err) {
+                        // nothing may escape a worker, the calling thread throws once every range is accounted for
+                        GN_CORE_ERROR("Failed to cull spheres {} to {}: {}", first, last, err.what());
+                        failed = true;
+                    }
+                    culled.count_down();
+                });
+            }
+            culled.wait();
+
+            if (failed) {
+                std::string errMsg = "Failed to cull on the CPU.";
+                GN_CORE_ERROR("{}", errMsg);
+                throw std::runtime_error(errMsg);
+            }
+        }
+
+        visible.clear();
+        for (size_t range = 0; range < ranges; range++) {
+            const uint32_t* survivors = m_scratch.data() + rangeStart(range);
+            visible.insert(visible.end(), survivors, survivors + m_rangeCounts[range]);
+        }
+    }
+
+    FrustumPlanes FrustumCuller::extractPlanes(const glm::mat4& viewProjection) {
+        // the planes are rows of the view projection combined, normals pointing inwards; depth runs from zero to one
+        // so the near plane is the third row alone
+        FrustumPlanes planes;
+        glm::mat4 rows = glm::transpose(viewProjection);
+        planes[0] = rows[3] + rows[0];
+        planes[1] = rows[3] - rows[0];
+        planes[2] = rows[3] + rows[1];
+        planes[3] = rows[3] - rows[1];
+        planes[4] = rows[2];
+        planes[5] = rows[3] - rows[2];
+        for (glm::vec4& plane : planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return planes;
+    }
+}  // namespace Genesis
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "ThreadPool.h"
+
+namespace Genesis {
+    // world space planes as (normal, distance) with the normals pointing into the frustum
+    using FrustumPlanes = std::array<glm::vec4, 6>;
+
+    // Bounding spheres in structure of arrays form, so the culling loops load the same component of 4 or 8 spheres
+    // with one instruction.
+    struct SphereBounds {
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> z;
+            std::vector<float> radius;
+
+            size_t size() const { return radius.size(); }
+            void clear();
+            void reserve(size_t count);
+            void push_back(const glm::vec3& center, float radius);
+    };
+
+    // Frustum culling of bounding spheres on the CPU, for when the GPU cannot cull. Every plane is tested against 8
+    // spheres at once with AVX where the CPU has it, 4 with SSE otherwise, and with plain loops off x86. Large sets
+    // are split into ranges culled on the thread pool, each range writes its visible indices into its own part of a
+    // scratch buffer and the parts are joined in order, so the output is the same however the work was split.
+    class FrustumCuller {
+        public:
+            FrustumCuller();
+            ~FrustumCuller();
+
+            FrustumCuller(const FrustumCuller&) = delete;
+            FrustumCuller& operator=(const FrustumCuller&) = delete;
+
+            // the widest vector path the CPU supports, for logging
+            const char* path() const { return m_pathName; }
+
+            void init(ThreadPool& threadPool);
+            // indices of the spheres that touch the frustum, ascending
+            void cull(const FrustumPlanes& planes, const SphereBounds& bounds, std::vector<uint32_t>& visible);
+
+            // Gribb and Hartmann, for a zero to one depth range
+            static FrustumPlanes extractPlanes(const glm::mat4& viewProjection);
+
+        private:
+            using CullRangeFn = size_t (*)(const FrustumPlanes& planes, const SphereBounds& bounds, size_t first, size_t last, uint32_t* visible);
+
+            ThreadPool* m_threadPool = nullptr;
+            CullRangeFn m_cullRange = nullptr;
+            const char* m_pathName = "scalar";
+            // one slot per sphere, ranges write their survivors at their own first index
+            std::vector<uint32_t> m_scratch;
+            std::vector<size_t> m_rangeCounts;
+    };
+}  // namespace Genesis
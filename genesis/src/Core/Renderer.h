@@ -12,7 +12,8 @@ namespace Genesis {
             std::shared_ptr<Window> getWindow() const { return m_window; }
 
             virtual void init() = 0;
-            virtual bool drawFrame(std::shared_ptr<Scene>) = 0;
+            // called on the render thread, the scene is a snapshot that stays unchanged until drawFrame returns
+            virtual bool drawFrame(const Scene& scene) = 0;
             virtual void shutdown() = 0;
             virtual void waitForIdle() = 0;
 
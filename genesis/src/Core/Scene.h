@@ -9,10 +9,20 @@ namespace Genesis {
         SKULL
     };
 
+    struct Camera {
+            glm::vec3 eye = {0.0f, 0.0f, 1.0f};
+            glm::vec3 center = {1.0f, 0.0f, 1.0f};
+            glm::vec3 up = {0.0f, 0.0f, 1.0f};
+            float fovY = glm::radians(45.0f);
+            float nearPlane = 0.1f;
+            float farPlane = 100.0f;
+    };
+
     class Scene {
         public:
             Scene();
 
+            Camera camera;
             std::unordered_map<meshTypes, std::vector<glm::vec3>> positions;
     };
 }  // namespace Genesis
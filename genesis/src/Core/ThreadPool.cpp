@@ -0,0 +1,71 @@
+#include "ThreadPool.h"
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    ThreadPool::ThreadPool(uint32_t threadCount) {
+        if (threadCount == 0) {
+            uint32_t hardwareThreads = std::thread::hardware_concurrency();
+            threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+        }
+
+        for (uint32_t i = 0; i < threadCount; i++) {
+            m_workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_jobAvailable.notify_all();
+
+        for (std::thread& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push(std::move(job));
+        }
+        m_jobAvailable.notify_one();
+    }
+
+    void ThreadPool::waitIdle() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobsFinished.wait(lock, [this] { return m_jobs.empty() && m_activeJobs == 0; });
+    }
+
+    void ThreadPool::workerLoop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobAvailable.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+                if (m_stopping && m_jobs.empty()) {
+                    return;
+                }
+                job = std::move(m_jobs.front());
+                m_jobs.pop();
+                m_activeJobs++;
+            }
+
+            try {
+                job();
+            } catch (const std::exception& err) {
+                GN_CORE_ERROR("Worker job failed: {}", err.what());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_activeJobs--;
+                if (m_jobs.empty() && m_activeJobs == 0) {
+                    m_jobsFinished.notify_all();
+                }
+            }
+        }
+    }
+}  // namespace Genesis
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace Genesis {
+    class ThreadPool {
+        public:
+            // a thread count of zero leaves one hardware thread free for the main loop
+            ThreadPool(uint32_t threadCount = 0);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            uint32_t threadCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+            void submit(std::function<void()> job);
+            void waitIdle();
+
+        private:
+            void workerLoop();
+
+            std::vector<std::thread> m_workers;
+            std::queue<std::function<void()>> m_jobs;
+            std::mutex m_mutex;
+            std::condition_variable m_jobAvailable;
+            std::condition_variable m_jobsFinished;
+            uint32_t m_activeJobs = 0;
+            bool m_stopping = false;
+    };
+}  // namespace Genesis
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
@@ -35,8 +37,9 @@ namespace Genesis {
             std::string m_title;
             int16_t m_x;
             int16_t m_y;
-            uint16_t m_windowWidth;
-            uint16_t m_windowHeight;
+            // written by the main thread's callbacks, read by the render thread when the swapchain is rebuilt
+            std::atomic<uint16_t> m_windowWidth;
+            std::atomic<uint16_t> m_windowHeight;
 
             GLFWwindow* m_window;
     };
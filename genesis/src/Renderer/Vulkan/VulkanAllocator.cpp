@@ -0,0 +1,479 @@
+#include "VulkanAllocator.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    static constexpr vk::DeviceSize ALLOCATOR_BLOCK_SIZE = 64ull * 1024 * 1024;
+    // heaps below this size get blocks of an eighth of the heap instead
+    static constexpr vk::DeviceSize ALLOCATOR_SMALL_HEAP_SIZE = 1024ull * 1024 * 1024;
+    static constexpr vk::DeviceSize ALLOCATOR_MIN_SIZE = 256;
+    // updateBudget runs once a frame, so this logs the budget every few seconds
+    static constexpr uint32_t ALLOCATOR_BUDGET_LOG_INTERVAL = 600;
+    // a heap has to drop this far below the warning fraction before it warns again
+    static constexpr float ALLOCATOR_BUDGET_WARNING_HYSTERESIS = 0.05f;
+
+    const char* memoryCategoryName(MemoryCategory category) {
+        switch (category) {
+            case MemoryCategory::MESHES:
+                return "meshes";
+            case MemoryCategory::TEXTURES:
+                return "textures";
+            case MemoryCategory::FRAME_RESOURCES:
+                return "frame resources";
+            case MemoryCategory::STAGING:
+                return "staging";
+            default:
+                return "other";
+        }
+    }
+
+    VulkanAllocator::VulkanAllocator() {
+    }
+
+    VulkanAllocator::~VulkanAllocator() {
+    }
+
+    void VulkanAllocator::init(vk::PhysicalDevice physicalDevice, vk::Device device, bool dedicatedAllocationQuery, bool memoryBudgetQuery) {
+        m_vkPhysicalDevice = physicalDevice;
+        m_vkDevice = device;
+        m_vkMemoryProperties = physicalDevice.getMemoryProperties();
+        vk::PhysicalDeviceProperties properties = physicalDevice.getProperties();
+        m_bufferImageGranularity = properties.limits.bufferImageGranularity;
+        m_maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+        m_dedicatedAllocationQuery = dedicatedAllocationQuery;
+        m_memoryBudgetQuery = memoryBudgetQuery;
+        m_heapBytes.assign(m_vkMemoryProperties.memoryHeapCount, 0);
+        m_heapOverBudget.assign(m_vkMemoryProperties.memoryHeapCount, false);
+
+        GN_CORE_INFO("Vulkan allocator initialized: {} memory types, buffer image granularity {}, at most {} device allocations.",
+                     m_vkMemoryProperties.memoryTypeCount,
+                     m_bufferImageGranularity,
+                     m_maxAllocationCount);
+    }
+
+    uint32_t VulkanAllocator::findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) const {
+        for (uint32_t i = 0; i < m_vkMemoryProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) && (m_vkMemoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                return i;
+            }
+        }
+
+        std::string errMsg = "Failed to find suitable memory type for properties: ";
+        GN_CORE_ERROR("{}{}", errMsg, vk::to_string(properties));
+        throw std::runtime_error(errMsg + vk::to_string(properties));
+    }
+
+    VulkanAllocation VulkanAllocator::allocateBuffer(vk::Buffer buffer, vk::MemoryPropertyFlags properties, MemoryCategory category) {
+        vk::MemoryRequirements requirements;
+        bool dedicated = false;
+        if (m_dedicatedAllocationQuery) {
+            vk::BufferMemoryRequirementsInfo2 requirementsInfo = {};
+            requirementsInfo.buffer = buffer;
+            vk::MemoryDedicatedRequirements dedicatedRequirements = {};
+            vk::MemoryRequirements2 requirements2 = {};
+            requirements2.pNext = &dedicatedRequirements;
+            m_vkDevice.getBufferMemoryRequirements2(&requirementsInfo, &requirements2);
+            requirements = requirements2.memoryRequirements;
+            dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+        } else {
+            requirements = m_vkDevice.getBufferMemoryRequirements(buffer);
+        }
+
+        VulkanAllocation allocation = allocate(requirements, properties, true, dedicated, buffer, nullptr, category);
+        try {
+            m_vkDevice.bindBufferMemory(buffer, allocation.memory, allocation.offset);
+        } catch (vk::SystemError err) {
+            free(allocation);
+            std::string errMsg = "Failed to bind buffer memory: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+        return allocation;
+    }
+
+    VulkanAllocation VulkanAllocator::allocateImage(vk::Image image, vk::ImageTiling tiling, vk::MemoryPropertyFlags properties, MemoryCategory category) {
+        vk::MemoryRequirements requirements;
+        bool dedicated = false;
+        if (m_dedicatedAllocationQuery) {
+            vk::ImageMemoryRequirementsInfo2 requirementsInfo = {};
+            requirementsInfo.image = image;
+            vk::MemoryDedicatedRequirements dedicatedRequirements = {};
+            vk::MemoryRequirements2 requirements2 = {};
+            requirements2.pNext = &dedicatedRequirements;
+            m_vkDevice.getImageMemoryRequirements2(&requirementsInfo, &requirements2);
+            requirements = requirements2.memoryRequirements;
+            dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+        } else {
+            requirements = m_vkDevice.getImageMemoryRequirements(image);
+        }
+
+        VulkanAllocation allocation = allocate(requirements, properties, tiling == vk::ImageTiling::eLinear, dedicated, nullptr, image, category);
+        try {
+            m_vkDevice.bindImageMemory(image, allocation.memory, allocation.offset);
+        } catch (vk::SystemError err) {
+            free(allocation);
+            std::string errMsg = "Failed to bind image memory: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+        return allocation;
+    }
+
+    VulkanAllocation VulkanAllocator::allocate(const vk::MemoryRequirements& requirements,
+                                               vk::MemoryPropertyFlags properties,
+                                               bool linear,
+                                               bool dedicated,
+                                               vk::Buffer buffer,
+                                               vk::Image image,
+                                               MemoryCategory category) {
+        uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_categoryBytes[static_cast<size_t>(category)] += requirements.size;
+
+        // anything bigger than half a block would waste most of it, render targets and large textures go here
+        if (dedicated || requirements.size > blockSize(memoryTypeIndex) / 2) {
+            VulkanAllocation allocation = allocateDedicated(requirements, memoryTypeIndex, buffer, image);
+            allocation.category = category;
+            return allocation;
+        }
+
+        // with a granularity of one, buffers and optimal images can sit next to each other freely
+        bool blockLinear = m_bufferImageGranularity > 1 ? linear : true;
+        vk::DeviceSize pieceSize = std::bit_ceil(std::max({requirements.size, requirements.alignment, ALLOCATOR_MIN_SIZE}));
+        uint32_t order = static_cast<uint32_t>(std::countr_zero(pieceSize / ALLOCATOR_MIN_SIZE));
+
+        VulkanAllocation allocation = {};
+        allocation.size = requirements.size;
+        allocation.memoryTypeIndex = memoryTypeIndex;
+        allocation.order = order;
+        allocation.category = category;
+
+        bool allocated = false;
+        for (uint32_t i = 0; i < m_blocks.size() && !allocated; i++) {
+            if (m_blocks[i].memory && m_blocks[i].memoryTypeIndex == memoryTypeIndex && m_blocks[i].linear == blockLinear) {
+                allocated = allocateFromBlock(i, order, allocation);
+            }
+        }
+        if (!allocated) {
+            allocateFromBlock(createBlock(memoryTypeIndex, blockLinear), order, allocation);
+        }
+
+        m_allocationCount++;
+        m_usedBytes += pieceSize;
+        m_requestedBytes += requirements.size;
+        return allocation;
+    }
+
+    VulkanAllocation VulkanAllocator::allocateDedicated(const vk::MemoryRequirements& requirements, uint32_t memoryTypeIndex, vk::Buffer buffer, vk::Image image) {
+        vk::MemoryDedicatedAllocateInfo dedicatedInfo = {};
+        dedicatedInfo.buffer = buffer;
+        dedicatedInfo.image = image;
+
+        VulkanAllocation allocation = {};
+        allocation.memory = allocateMemory(requirements.size, memoryTypeIndex, m_dedicatedAllocationQuery ? &dedicatedInfo : nullptr);
+        allocation.offset = 0;
+        allocation.size = requirements.size;
+        allocation.mappedData = mapMemory(allocation.memory, memoryTypeIndex);
+        allocation.memoryTypeIndex = memoryTypeIndex;
+        allocation.blockIndex = UINT32_MAX;
+
+        m_dedicatedCount++;
+        m_dedicatedBytes += requirements.size;
+        m_allocationCount++;
+        m_requestedBytes += requirements.size;
+        return allocation;
+    }
+
+    bool VulkanAllocator::allocateFromBlock(uint32_t blockIndex, uint32_t order, VulkanAllocation& allocation) {
+        MemoryBlock& block = m_blocks[blockIndex];
+        if (order >= block.freeLists.size()) {
+            return false;
+        }
+
+        uint32_t freeOrder = order;
+        while (freeOrder < block.freeLists.size() && block.freeLists[freeOrder].empty()) {
+            freeOrder++;
+        }
+        if (freeOrder == block.freeLists.size()) {
+            return false;
+        }
+
+        // split the smallest free piece that fits, handing the upper halves back to the lower orders
+        vk::DeviceSize offset = *block.freeLists[freeOrder].begin();
+        block.freeLists[freeOrder].erase(block.freeLists[freeOrder].begin());
+        while (freeOrder > order) {
+            freeOrder--;
+            block.freeLists[freeOrder].insert(offset + (ALLOCATOR_MIN_SIZE << freeOrder));
+        }
+
+        block.allocationCount++;
+        allocation.memory = block.memory;
+        allocation.offset = offset;
+        allocation.mappedData = block.mappedData ? block.mappedData + offset : nullptr;
+        allocation.blockIndex = blockIndex;
+        return true;
+    }
+
+    uint32_t VulkanAllocator::createBlock(uint32_t memoryTypeIndex, bool linear) {
+        MemoryBlock block = {};
+        block.size = blockSize(memoryTypeIndex);
+        block.memoryTypeIndex = memoryTypeIndex;
+        block.linear = linear;
+        block.memory = allocateMemory(block.size, memoryTypeIndex, nullptr);
+        block.mappedData = static_cast<uint8_t*>(mapMemory(block.memory, memoryTypeIndex));
+        block.freeLists.resize(std::countr_zero(block.size / ALLOCATOR_MIN_SIZE) + 1);
+        block.freeLists.back().insert(0);
+        block.allocationCount = 0;
+
+        GN_CORE_TRACE("Vulkan allocator created a {} MiB block for memory type {}.", block.size / (1024 * 1024), memoryTypeIndex);
+
+        // reuse a slot of a released block so outstanding block indices stay valid
+        for (uint32_t i = 0; i < m_blocks.size(); i++) {
+            if (!m_blocks[i].memory) {
+                m_blocks[i] = std::move(block);
+                return i;
+            }
+        }
+        m_blocks.push_back(std::move(block));
+        return static_cast<uint32_t>(m_blocks.size()) - 1;
+    }
+
+    vk::DeviceMemory VulkanAllocator::allocateMemory(vk::DeviceSize size, uint32_t memoryTypeIndex, const void* pNext) {
+        if (m_deviceMemoryCount >= m_maxAllocationCount) {
+            GN_CORE_WARNING("Vulkan allocator is at the device limit of {} memory allocations.", m_maxAllocationCount);
+        }
+
+        vk::MemoryAllocateInfo allocInfo = {};
+        allocInfo.allocationSize = size;
+        allocInfo.memoryTypeIndex = memoryTypeIndex;
+        allocInfo.pNext = pNext;
+
+        vk::DeviceMemory memory;
+        try {
+            memory = m_vkDevice.allocateMemory(allocInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to allocate device memory: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+        m_deviceMemoryCount++;
+        m_heapBytes[m_vkMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex] += size;
+        return memory;
+    }
+
+    void VulkanAllocator::freeMemory(vk::DeviceMemory memory, vk::DeviceSize size, uint32_t memoryTypeIndex) {
+        m_vkDevice.freeMemory(memory);
+        m_deviceMemoryCount--;
+        m_heapBytes[m_vkMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex] -= size;
+    }
+
+    void* VulkanAllocator::mapMemory(vk::DeviceMemory memory, uint32_t memoryTypeIndex) {
+        if (!(m_vkMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible)) {
+            return nullptr;
+        }
+
+        try {
+            return m_vkDevice.mapMemory(memory, vk::DeviceSize(0), VK_WHOLE_SIZE, vk::MemoryMapFlags());
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to map device memory: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+    }
+
+    vk::DeviceSize VulkanAllocator::blockSize(uint32_t memoryTypeIndex) const {
+        vk::DeviceSize heapSize = m_vkMemoryProperties.memoryHeaps[m_vkMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+        if (heapSize < ALLOCATOR_SMALL_HEAP_SIZE) {
+            return std::max(std::bit_floor(heapSize / 8), ALLOCATOR_MIN_SIZE);
+        }
+        return ALLOCATOR_BLOCK_SIZE;
+    }
+
+    void VulkanAllocator::free(VulkanAllocation& allocation) {
+        if (!allocation.memory) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_allocationCount--;
+        m_requestedBytes -= allocation.size;
+        m_categoryBytes[static_cast<size_t>(allocation.category)] -= allocation.size;
+
+        if (allocation.blockIndex == UINT32_MAX) {
+            freeMemory(allocation.memory, allocation.size, allocation.memoryTypeIndex);
+            m_dedicatedCount--;
+            m_dedicatedBytes -= allocation.size;
+            allocation = VulkanAllocation();
+            return;
+        }
+
+        MemoryBlock& block = m_blocks[allocation.blockIndex];
+        m_usedBytes -= ALLOCATOR_MIN_SIZE << allocation.order;
+
+        // merge with the buddy for as long as it is free too
+        vk::DeviceSize offset = allocation.offset;
+        uint32_t order = allocation.order;
+        while (order + 1 < block.freeLists.size()) {
+            vk::DeviceSize buddy = offset ^ (ALLOCATOR_MIN_SIZE << order);
+            if (block.freeLists[order].erase(buddy) == 0) {
+                break;
+            }
+            offset = std::min(offset, buddy);
+            order++;
+        }
+        block.freeLists[order].insert(offset);
+        block.allocationCount--;
+
+        // keep one empty block per memory type around so a create/destroy pattern does not thrash the driver
+        if (block.allocationCount == 0) {
+            bool hasOtherBlock = false;
+            for (uint32_t i = 0; i < m_blocks.size(); i++) {
+                if (i != allocation.blockIndex && m_blocks[i].memory && m_blocks[i].memoryTypeIndex == block.memoryTypeIndex && m_blocks[i].linear == block.linear) {
+                    hasOtherBlock = true;
+                    break;
+                }
+            }
+            if (hasOtherBlock) {
+                freeMemory(block.memory, block.size, block.memoryTypeIndex);
+                block = MemoryBlock();
+            }
+        }
+
+        allocation = VulkanAllocation();
+    }
+
+    VulkanAllocatorStats VulkanAllocator::stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        VulkanAllocatorStats stats = {};
+        for (const MemoryBlock& block : m_blocks) {
+            if (block.memory) {
+                stats.blockCount++;
+                stats.blockBytes += block.size;
+            }
+        }
+        stats.dedicatedCount = m_dedicatedCount;
+        stats.allocationCount = m_allocationCount;
+        stats.usedBytes = m_usedBytes;
+        stats.requestedBytes = m_requestedBytes;
+        stats.dedicatedBytes = m_dedicatedBytes;
+        return stats;
+    }
+
+    void VulkanAllocator::logStats() const {
+        VulkanAllocatorStats current = stats();
+        GN_CORE_INFO("Vulkan allocator: {} allocations, {} blocks ({} MiB, {} MiB used, {} MiB requested), {} dedicated ({} MiB).",
+                     current.allocationCount,
+                     current.blockCount,
+                     current.blockBytes / (1024 * 1024),
+                     current.usedBytes / (1024 * 1024),
+                     (current.requestedBytes - current.dedicatedBytes) / (1024 * 1024),
+                     current.dedicatedCount,
+                     current.dedicatedBytes / (1024 * 1024));
+    }
+
+    void VulkanAllocator::updateBudget() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        vk::PhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+        if (m_memoryBudgetQuery) {
+            vk::PhysicalDeviceMemoryProperties2 memoryProperties = {};
+            memoryProperties.pNext = &budgetProperties;
+            m_vkPhysicalDevice.getMemoryProperties2(&memoryProperties);
+        }
+
+        m_heapBudgets.resize(m_vkMemoryProperties.memoryHeapCount);
+        for (uint32_t heap = 0; heap < m_vkMemoryProperties.memoryHeapCount; heap++) {
+            VulkanHeapBudget& heapBudget = m_heapBudgets[heap];
+            heapBudget.size = m_vkMemoryProperties.memoryHeaps[heap].size;
+            heapBudget.engineBytes = m_heapBytes[heap];
+            heapBudget.deviceLocal = static_cast<bool>(m_vkMemoryProperties.memoryHeaps[heap].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+            if (m_memoryBudgetQuery) {
+                heapBudget.budget = budgetProperties.heapBudget[heap];
+                heapBudget.usage = budgetProperties.heapUsage[heap];
+            } else {
+                heapBudget.budget = heapBudget.size;
+                heapBudget.usage = heapBudget.engineBytes;
+            }
+
+            if (heapBudget.budget == 0) {
+                continue;
+            }
+            float fraction = static_cast<float>(heapBudget.usage) / static_cast<float>(heapBudget.budget);
+            if (!m_heapOverBudget[heap] && fraction >= m_budgetWarningFraction) {
+                m_heapOverBudget[heap] = true;
+                GN_CORE_WARNING("GPU memory heap {} is at {:.0f}% of its budget ({} of {} MiB, {} MiB from the engine).",
+                                heap,
+                                fraction * 100.0f,
+                                heapBudget.usage / (1024 * 1024),
+                                heapBudget.budget / (1024 * 1024),
+                                heapBudget.engineBytes / (1024 * 1024));
+            } else if (m_heapOverBudget[heap] && fraction < m_budgetWarningFraction - ALLOCATOR_BUDGET_WARNING_HYSTERESIS) {
+                m_heapOverBudget[heap] = false;
+            }
+        }
+
+        bool logNow = m_budgetUpdates++ % ALLOCATOR_BUDGET_LOG_INTERVAL == 0;
+        lock.unlock();
+
+        if (logNow) {
+            logBudget();
+        }
+    }
+
+    std::vector<VulkanHeapBudget> VulkanAllocator::heapBudgets() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_heapBudgets;
+    }
+
+    vk::DeviceSize VulkanAllocator::categoryBytes(MemoryCategory category) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_categoryBytes[static_cast<size_t>(category)];
+    }
+
+    void VulkanAllocator::logBudget() const {
+        std::vector<VulkanHeapBudget> budgets = heapBudgets();
+        for (uint32_t heap = 0; heap < budgets.size(); heap++) {
+            if (budgets[heap].engineBytes == 0 && !budgets[heap].deviceLocal) {
+                continue;
+            }
+            GN_CORE_INFO("GPU memory heap {}{}: {} of {} MiB budget used, {} MiB by the engine.",
+                         heap,
+                         budgets[heap].deviceLocal ? " (device local)" : "",
+                         budgets[heap].usage / (1024 * 1024),
+                         budgets[heap].budget / (1024 * 1024),
+                         budgets[heap].engineBytes / (1024 * 1024));
+        }
+
+        std::string categories;
+        for (size_t category = 0; category < static_cast<size_t>(MemoryCategory::COUNT); category++) {
+            if (!categories.empty()) {
+                categories += ", ";
+            }
+            categories += std::string(memoryCategoryName(static_cast<MemoryCategory>(category))) + " " +
+                          std::to_string(categoryBytes(static_cast<MemoryCategory>(category)) / 1024) + " KiB";
+        }
+        GN_CORE_INFO("GPU memory by category: {}.", categories);
+    }
+
+    void VulkanAllocator::destroy() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_allocationCount > 0) {
+            GN_CORE_WARNING("Vulkan allocator destroyed with {} allocations still live.", m_allocationCount);
+        }
+
+        for (MemoryBlock& block : m_blocks) {
+            if (block.memory) {
+                m_vkDevice.freeMemory(block.memory);
+            }
+        }
+        m_blocks.clear();
+        m_deviceMemoryCount = 0;
+        m_heapBytes.assign(m_heapBytes.size(), 0);
+    }
+}  // namespace Genesis
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <set>
+
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    // what an allocation is used for, so memory use can be broken down in the telemetry
+    enum class MemoryCategory {
+        MESHES,
+        TEXTURES,
+        FRAME_RESOURCES,
+        STAGING,
+        OTHER,
+        COUNT
+    };
+
+    const char* memoryCategoryName(MemoryCategory category);
+
+    struct VulkanAllocation {
+            vk::DeviceMemory memory;
+            vk::DeviceSize offset = 0;
+            vk::DeviceSize size = 0;
+            // points at offset inside the persistently mapped block, null for memory that is not host visible
+            void* mappedData = nullptr;
+            uint32_t memoryTypeIndex = 0;
+            // UINT32_MAX for dedicated allocations that own their vk::DeviceMemory
+            uint32_t blockIndex = UINT32_MAX;
+            uint32_t order = 0;
+            MemoryCategory category = MemoryCategory::OTHER;
+    };
+
+    struct VulkanHeapBudget {
+            vk::DeviceSize size;
+            // what the process may use before the driver starts evicting, the heap size without VK_EXT_memory_budget
+            vk::DeviceSize budget;
+            // the whole process' use as the driver sees it, the engine's own device memory without VK_EXT_memory_budget
+            vk::DeviceSize usage;
+            // device memory allocated by this allocator
+            vk::DeviceSize engineBytes;
+            bool deviceLocal;
+    };
+
+    struct VulkanAllocatorStats {
+            uint32_t blockCount = 0;
+            uint32_t dedicatedCount = 0;
+            uint32_t allocationCount = 0;
+            vk::DeviceSize blockBytes = 0;
+            // bytes handed out from blocks, including the rounding up to a power of two
+            vk::DeviceSize usedBytes = 0;
+            // bytes the resources actually asked for
+            vk::DeviceSize requestedBytes = 0;
+            vk::DeviceSize dedicatedBytes = 0;
+    };
+
+    // Takes large vk::DeviceMemory blocks per memory type and hands out power of two pieces of them with a buddy
+    // scheme, so the driver sees a handful of allocations however many buffers and images the engine creates.
+    // Buddies are aligned to their own size, which covers every alignment requirement, and when the device has a
+    // bufferImageGranularity above one, linear and optimal resources are kept in separate blocks. Host visible
+    // blocks stay mapped for their whole lifetime.
+    class VulkanAllocator {
+        public:
+            VulkanAllocator();
+            ~VulkanAllocator();
+
+            VulkanAllocator(const VulkanAllocator&) = delete;
+            VulkanAllocator& operator=(const VulkanAllocator&) = delete;
+
+            void init(vk::PhysicalDevice physicalDevice, vk::Device device, bool dedicatedAllocationQuery, bool memoryBudgetQuery);
+            VulkanAllocation allocateBuffer(vk::Buffer buffer, vk::MemoryPropertyFlags properties, MemoryCategory category);
+            VulkanAllocation allocateImage(vk::Image image, vk::ImageTiling tiling, vk::MemoryPropertyFlags properties, MemoryCategory category);
+            void free(VulkanAllocation& allocation);
+            uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) const;
+            VulkanAllocatorStats stats() const;
+            void logStats() const;
+            // refreshes the heap budgets, warns about heaps above the warning fraction and logs them now and then
+            void updateBudget();
+            std::vector<VulkanHeapBudget> heapBudgets() const;
+            // bytes the resources of a category asked for
+            vk::DeviceSize categoryBytes(MemoryCategory category) const;
+            void setBudgetWarningFraction(float fraction) { m_budgetWarningFraction = fraction; }
+            void logBudget() const;
+            void destroy();
+
+        private:
+            struct MemoryBlock {
+                    vk::DeviceMemory memory;
+                    vk::DeviceSize size;
+                    uint32_t memoryTypeIndex;
+                    bool linear;
+                    uint8_t* mappedData;
+                    // free offsets per order, order n holds pieces of ALLOCATOR_MIN_SIZE << n bytes
+                    std::vector<std::set<vk::DeviceSize>> freeLists;
+                    uint32_t allocationCount;
+            };
+
+            VulkanAllocation allocate(const vk::MemoryRequirements& requirements,
+                                      vk::MemoryPropertyFlags properties,
+                                      bool linear,
+                                      bool dedicated,
+                                      vk::Buffer buffer,
+                                      vk::Image image,
+                                      MemoryCategory category);
+            VulkanAllocation allocateDedicated(const vk::MemoryRequirements& requirements, uint32_t memoryTypeIndex, vk::Buffer buffer, vk::Image image);
+            bool allocateFromBlock(uint32_t blockIndex, uint32_t order, VulkanAllocation& allocation);
+            uint32_t createBlock(uint32_t memoryTypeIndex, bool linear);
+            vk::DeviceMemory allocateMemory(vk::DeviceSize size, uint32_t memoryTypeIndex, const void* pNext);
+            void freeMemory(vk::DeviceMemory memory, vk::DeviceSize size, uint32_t memoryTypeIndex);
+            void* mapMemory(vk::DeviceMemory memory, uint32_t memoryTypeIndex);
+            vk::DeviceSize blockSize(uint32_t memoryTypeIndex) const;
+
+            vk::PhysicalDevice m_vkPhysicalDevice;
+            vk::Device m_vkDevice;
+            vk::PhysicalDeviceMemoryProperties m_vkMemoryProperties;
+            vk::DeviceSize m_bufferImageGranularity = 1;
+            uint32_t m_maxAllocationCount = 0;
+            bool m_dedicatedAllocationQuery = false;
+            bool m_memoryBudgetQuery = false;
+
+            mutable std::mutex m_mutex;
+            std::vector<MemoryBlock> m_blocks;
+            uint32_t m_deviceMemoryCount = 0;
+            uint32_t m_dedicatedCount = 0;
+            vk::DeviceSize m_dedicatedBytes = 0;
+            vk::DeviceSize m_usedBytes = 0;
+            vk::DeviceSize m_requestedBytes = 0;
+            uint32_t m_allocationCount = 0;
+            std::array<vk::DeviceSize, static_cast<size_t>(MemoryCategory::COUNT)> m_categoryBytes = {};
+            std::vector<vk::DeviceSize> m_heapBytes;
+
+            std::vector<VulkanHeapBudget> m_heapBudgets;
+            std::vector<bool> m_heapOverBudget;
+            float m_budgetWarningFraction = 0.9f;
+            uint32_t m_budgetUpdates = 0;
+    };
+}  // namespace Genesis
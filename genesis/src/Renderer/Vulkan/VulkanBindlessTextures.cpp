@@ -0,0 +1,132 @@
+#include "VulkanBindlessTextures.h"
+
+#include <algorithm>
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    static constexpr uint32_t BINDLESS_MAX_TEXTURES = 4096;
+
+    VulkanBindlessTextures::VulkanBindlessTextures() {
+    }
+
+    VulkanBindlessTextures::~VulkanBindlessTextures() {
+    }
+
+    void VulkanBindlessTextures::init(VulkanDevice& vulkanDevice) {
+        m_enabled = vulkanDevice.descriptorIndexingEnabled();
+        if (!m_enabled) {
+            GN_CORE_WARNING("Descriptor indexing unavailable, falling back to per material descriptor sets.");
+            return;
+        }
+
+        vk::PhysicalDeviceDescriptorIndexingProperties indexingProperties = {};
+        vk::PhysicalDeviceProperties2 properties = {};
+        properties.pNext = &indexingProperties;
+        vulkanDevice.physicalDevice().getProperties2(&properties);
+
+        m_capacity = std::min({BINDLESS_MAX_TEXTURES,
+                               indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                               indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                               indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                               indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers});
+
+        vk::DescriptorSetLayoutBinding texturesBinding = {};
+        texturesBinding.binding = 0;
+        texturesBinding.descriptorCount = m_capacity;
+        texturesBinding.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+        texturesBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
+
+        // slots that were never written are fine as long as the shader does not index them
+        vk::DescriptorBindingFlags bindingFlags = vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind;
+        vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+        bindingFlagsInfo.bindingCount = 1;
+        bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+        vk::DescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool;
+        layoutInfo.bindingCount = 1;
+        layoutInfo.pBindings = &texturesBinding;
+        layoutInfo.pNext = &bindingFlagsInfo;
+
+        vk::DescriptorPoolSize poolSize = {};
+        poolSize.type = vk::DescriptorType::eCombinedImageSampler;
+        poolSize.descriptorCount = m_capacity;
+
+        vk::DescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.flags = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        poolInfo.maxSets = 1;
+
+        try {
+            m_vkDescriptorSetLayout = vulkanDevice.logicalDevice().createDescriptorSetLayout(layoutInfo);
+            m_vkDescriptorPool = vulkanDevice.logicalDevice().createDescriptorPool(poolInfo);
+
+            vk::DescriptorSetAllocateInfo allocInfo = {};
+            allocInfo.descriptorPool = m_vkDescriptorPool;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &m_vkDescriptorSetLayout;
+            m_vkDescriptorSet = vulkanDevice.logicalDevice().allocateDescriptorSets(allocInfo)[0];
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create bindless texture descriptor set: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        GN_CORE_INFO("Vulkan bindless texture table created with {} slots.", m_capacity);
+    }
+
+    uint32_t VulkanBindlessTextures::registerTexture(VulkanDevice& vulkanDevice, vk::ImageView imageView, vk::Sampler sampler) {
+        uint32_t index;
+        if (!m_freeIndices.empty()) {
+            index = m_freeIndices.back();
+            m_freeIndices.pop_back();
+        } else if (m_nextIndex < m_capacity) {
+            index = m_nextIndex++;
+        } else {
+            std::string errMsg = "Bindless texture table is full.";
+            GN_CORE_ERROR("{}", errMsg);
+            throw std::runtime_error(errMsg);
+        }
+
+        updateTexture(vulkanDevice, index, imageView, sampler);
+        return index;
+    }
+
+    void VulkanBindlessTextures::updateTexture(VulkanDevice& vulkanDevice, uint32_t index, vk::ImageView imageView, vk::Sampler sampler) {
+        vk::DescriptorImageInfo imageDescriptor;
+        imageDescriptor.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        imageDescriptor.imageView = imageView;
+        imageDescriptor.sampler = sampler;
+
+        vk::WriteDescriptorSet descriptorWrite;
+        descriptorWrite.dstSet = m_vkDescriptorSet;
+        descriptorWrite.dstBinding = 0;
+        descriptorWrite.dstArrayElement = index;
+        descriptorWrite.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pImageInfo = &imageDescriptor;
+
+        vulkanDevice.logicalDevice().updateDescriptorSets(descriptorWrite, nullptr);
+    }
+
+    void VulkanBindlessTextures::releaseTexture(uint32_t index) {
+        m_freeIndices.push_back(index);
+    }
+
+    void VulkanBindlessTextures::bind(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t setIndex) {
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, setIndex, m_vkDescriptorSet, nullptr);
+    }
+
+    void VulkanBindlessTextures::shutdown(VulkanDevice& vulkanDevice) {
+        if (!m_enabled) {
+            return;
+        }
+
+        vulkanDevice.logicalDevice().destroyDescriptorPool(m_vkDescriptorPool);
+        vulkanDevice.logicalDevice().destroyDescriptorSetLayout(m_vkDescriptorSetLayout);
+        m_freeIndices.clear();
+        m_nextIndex = 0;
+    }
+}  // namespace Genesis
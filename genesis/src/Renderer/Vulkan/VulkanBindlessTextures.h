@@ -0,0 +1,39 @@
+#pragma once
+
+#include "VulkanDevice.h"
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    // One large, partially bound, update-after-bind array of combined image samplers. Textures register once and
+    // are referenced by index from the per-instance object data, so a whole pass needs a single material bind.
+    class VulkanBindlessTextures {
+        public:
+            VulkanBindlessTextures();
+            ~VulkanBindlessTextures();
+
+            VulkanBindlessTextures(const VulkanBindlessTextures&) = delete;
+            VulkanBindlessTextures& operator=(const VulkanBindlessTextures&) = delete;
+
+            bool isEnabled() const { return m_enabled; }
+            uint32_t capacity() const { return m_capacity; }
+            vk::DescriptorSetLayout const& descriptorSetLayout() const { return m_vkDescriptorSetLayout; }
+
+            void init(VulkanDevice& vulkanDevice);
+            uint32_t registerTexture(VulkanDevice& vulkanDevice, vk::ImageView imageView, vk::Sampler sampler);
+            // only for a slot no pending frame can sample, a live texture that changes its view registers a new slot
+            void updateTexture(VulkanDevice& vulkanDevice, uint32_t index, vk::ImageView imageView, vk::Sampler sampler);
+            void releaseTexture(uint32_t index);
+            void bind(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t setIndex);
+            void shutdown(VulkanDevice& vulkanDevice);
+
+        private:
+            bool m_enabled = false;
+            uint32_t m_capacity = 0;
+            uint32_t m_nextIndex = 0;
+            std::vector<uint32_t> m_freeIndices;
+
+            vk::DescriptorSetLayout m_vkDescriptorSetLayout;
+            vk::DescriptorPool m_vkDescriptorPool;
+            vk::DescriptorSet m_vkDescriptorSet;
+    };
+}  // namespace Genesis
@@ -12,7 +12,8 @@ namespace Genesis {
     void VulkanBuffer::createBuffer(VulkanDevice& vulkanDevice,
                                     vk::DeviceSize size,
                                     vk::BufferUsageFlags usage,
-                                    vk::MemoryPropertyFlags properties) {
+                                    vk::MemoryPropertyFlags properties,
+                                    MemoryCategory category) {
         vk::BufferCreateInfo bufferInfo = {};
         bufferInfo.size = size;
         bufferInfo.usage = usage;
@@ -26,21 +27,7 @@ namespace Genesis {
             throw std::runtime_error(errMsg + err.what());
         }
 
-        vk::MemoryRequirements memRequirements = vulkanDevice.logicalDevice().getBufferMemoryRequirements(m_vkBuffer);
-
-        vk::MemoryAllocateInfo allocInfo = {};
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = vulkanDevice.findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        try {
-            m_vkBufferMemory = vulkanDevice.logicalDevice().allocateMemory(allocInfo);
-        } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to allocate buffer memory: ";
-            GN_CORE_ERROR("{}{}", errMsg, err.what());
-            throw std::runtime_error(errMsg + err.what());
-        }
-
-        vulkanDevice.logicalDevice().bindBufferMemory(m_vkBuffer, m_vkBufferMemory, 0);
+        m_allocation = vulkanDevice.allocator().allocateBuffer(m_vkBuffer, properties, category);
     }
 
     void VulkanBuffer::copyBufferFrom(vk::Buffer srcBuffer, vk::DeviceSize size, VulkanDevice& vulkanDevice, VulkanCommandBuffer& commandBuffer) {
@@ -60,4 +47,16 @@ namespace Genesis {
 
         commandBuffer.endSingleTimeCommands(vulkanDevice);
     }
+
+    void VulkanBuffer::destroy(VulkanDevice& vulkanDevice) {
+        vulkanDevice.logicalDevice().destroyBuffer(m_vkBuffer);
+        vulkanDevice.allocator().free(m_allocation);
+        m_vkBuffer = nullptr;
+    }
+
+    void VulkanBuffer::destroyDeferred(VulkanDevice& vulkanDevice) {
+        vulkanDevice.deletionQueue().destroyBuffer(m_vkBuffer, m_allocation);
+        m_vkBuffer = nullptr;
+        m_allocation = VulkanAllocation();
+    }
 }  // namespace Genesis
@@ -11,16 +11,22 @@ namespace Genesis {
             ~VulkanBuffer();
 
             vk::Buffer const& buffer() const { return m_vkBuffer; }
-            vk::DeviceMemory const& memory() const { return m_vkBufferMemory; }
+            VulkanAllocation const& allocation() const { return m_allocation; }
+            // only set for host visible buffers, the allocator keeps their memory mapped
+            void* mappedData() const { return m_allocation.mappedData; }
 
             void createBuffer(VulkanDevice& vulkanDevice,
                               vk::DeviceSize size,
                               vk::BufferUsageFlags usage,
-                              vk::MemoryPropertyFlags properties);
+                              vk::MemoryPropertyFlags properties,
+                              MemoryCategory category);
             void copyBufferFrom(vk::Buffer srcBuffer, vk::DeviceSize size, VulkanDevice& vulkanDevice, VulkanCommandBuffer& commandBuffer);
+            void destroy(VulkanDevice& vulkanDevice);
+            // hands the buffer to the deletion queue, for buffers the GPU may still be reading
+            void destroyDeferred(VulkanDevice& vulkanDevice);
 
         private:
             vk::Buffer m_vkBuffer;
-            vk::DeviceMemory m_vkBufferMemory;
+            VulkanAllocation m_allocation;
     };
 }  // namespace Genesis
@@ -0,0 +1,122 @@
+#include "VulkanCommandRecorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <latch>
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    // below this many draws per chunk handing work to the pool costs more than recording it
+    static constexpr size_t MIN_DRAWS_PER_CHUNK = 64;
+
+    VulkanCommandRecorder::VulkanCommandRecorder() {
+    }
+
+    VulkanCommandRecorder::~VulkanCommandRecorder() {
+    }
+
+    void VulkanCommandRecorder::init(VulkanDevice& vulkanDevice, ThreadPool& threadPool, uint32_t frameCount) {
+        m_threadPool = &threadPool;
+        m_frames.resize(frameCount);
+        m_recorded.reserve(m_threadPool->threadCount());
+    }
+
+    void VulkanCommandRecorder::beginFrame(VulkanDevice& vulkanDevice, uint32_t frameIndex) {
+        m_frameIndex = frameIndex;
+        for (vk::CommandPool commandPool : m_frames[m_frameIndex].commandPools) {
+            vulkanDevice.logicalDevice().resetCommandPool(commandPool);
+        }
+    }
+
+    uint32_t VulkanCommandRecorder::chunkCount(size_t drawCount) const {
+        size_t chunks = (drawCount + MIN_DRAWS_PER_CHUNK - 1) / MIN_DRAWS_PER_CHUNK;
+        return static_cast<uint32_t>(std::clamp(chunks, size_t(1), size_t(m_threadPool->threadCount())));
+    }
+
+    const std::vector<vk::CommandBuffer>& VulkanCommandRecorder::record(VulkanDevice& vulkanDevice,
+                                                                        uint32_t chunkCount,
+                                                                        const vk::CommandBufferInheritanceInfo& inheritanceInfo,
+                                                                        const std::function<void(vk::CommandBuffer, uint32_t)>& recordChunk) {
+        RecorderFrame& frame = m_frames[m_frameIndex];
+        while (frame.commandPools.size() < chunkCount) {
+            createChunk(vulkanDevice, frame);
+        }
+
+        std::latch recorded(chunkCount);
+        std::atomic<bool> failed = false;
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+            vk::CommandBuffer commandBuffer = frame.commandBuffers[chunk];
+            m_threadPool->submit([commandBuffer, chunk, &inheritanceInfo, &recordChunk, &recorded, &failed] {
+                vk::CommandBufferBeginInfo beginInfo = {};
+                beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+                beginInfo.pInheritanceInfo = &inheritanceInfo;
+                try {
+                    commandBuffer.begin(beginInfo);
+                    recordChunk(commandBuffer, chunk);
+                    commandBuffer.end();
+                } catch (std::exception err) {
+                    // nothing may escape a worker, the main thread throws once every chunk is accounted for
+                    GN_CORE_ERROR("Failed to record secondary command buffer: {}", err.what());
+                    failed = true;
+                }
+                recorded.count_down();
+            });
+        }
+        recorded.wait();
+
+        if (failed) {
+            std::string errMsg = "Failed to record secondary command buffers.";
+            GN_CORE_ERROR("{}", errMsg);
+            throw std::runtime_error(errMsg);
+        }
+
+        m_recorded.assign(frame.commandBuffers.begin(), frame.commandBuffers.begin() + chunkCount);
+
+        return m_recorded;
+    }
+
+    void VulkanCommandRecorder::shutdown(VulkanDevice& vulkanDevice) {
+        // freeing the pools frees their command buffers with them
+        for (RecorderFrame& frame : m_frames) {
+            for (vk::CommandPool commandPool : frame.commandPools) {
+                vulkanDevice.logicalDevice().destroyCommandPool(commandPool);
+            }
+        }
+        m_frames.clear();
+        m_recorded.clear();
+    }
+
+    void VulkanCommandRecorder::createChunk(VulkanDevice& vulkanDevice, RecorderFrame& frame) {
+        vk::CommandPoolCreateInfo poolInfo = {};
+        // reset as a whole every frame, never buffer by buffer
+        poolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+        poolInfo.queueFamilyIndex = vulkanDevice.graphicsQueueFamily();
+
+        vk::CommandPool commandPool;
+        try {
+            commandPool = vulkanDevice.logicalDevice().createCommandPool(poolInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create secondary command pool: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        vk::CommandBufferAllocateInfo allocInfo = {};
+        allocInfo.commandPool = commandPool;
+        allocInfo.level = vk::CommandBufferLevel::eSecondary;
+        allocInfo.commandBufferCount = 1;
+
+        vk::CommandBuffer commandBuffer;
+        try {
+            commandBuffer = vulkanDevice.logicalDevice().allocateCommandBuffers(allocInfo)[0];
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to allocate secondary command buffer: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        frame.commandPools.push_back(commandPool);
+        frame.commandBuffers.push_back(commandBuffer);
+    }
+}  // namespace Genesis
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <functional>
+
+#include "Core/ThreadPool.h"
+#include "VulkanDevice.h"
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    // Records a frame's draws on the thread pool. The draw list is split into chunks, one per worker at most, and
+    // each chunk goes into a secondary command buffer allocated from a pool that belongs to that chunk and frame, so
+    // no two threads ever share a pool. A frame's pools are reset in bulk once its fence has signalled and the
+    // primary command buffer only executes the secondaries.
+    class VulkanCommandRecorder {
+        public:
+            VulkanCommandRecorder();
+            ~VulkanCommandRecorder();
+
+            VulkanCommandRecorder(const VulkanCommandRecorder&) = delete;
+            VulkanCommandRecorder& operator=(const VulkanCommandRecorder&) = delete;
+
+            void init(VulkanDevice& vulkanDevice, ThreadPool& threadPool, uint32_t frameCount);
+            // call once the frame slot's fence has signalled
+            void beginFrame(VulkanDevice& vulkanDevice, uint32_t frameIndex);
+            // how many chunks a draw list of this size is worth splitting into, one means record it inline
+            uint32_t chunkCount(size_t drawCount) const;
+            // records every chunk into its secondary command buffer in parallel and returns once all are done
+            const std::vector<vk::CommandBuffer>& record(VulkanDevice& vulkanDevice,
+                                                         uint32_t chunkCount,
+                                                         const vk::CommandBufferInheritanceInfo& inheritanceInfo,
+                                                         const std::function<void(vk::CommandBuffer, uint32_t)>& recordChunk);
+            void shutdown(VulkanDevice& vulkanDevice);
+
+        private:
+            struct RecorderFrame {
+                    // one per chunk, grown on demand up to the thread count
+                    std::vector<vk::CommandPool> commandPools;
+                    std::vector<vk::CommandBuffer> commandBuffers;
+            };
+
+            void createChunk(VulkanDevice& vulkanDevice, RecorderFrame& frame);
+
+            ThreadPool* m_threadPool = nullptr;
+            std::vector<RecorderFrame> m_frames;
+            uint32_t m_frameIndex = 0;
+            // the first chunk count command buffers of the current frame, what record() hands back
+            std::vector<vk::CommandBuffer> m_recorded;
+    };
+}  // namespace Genesis
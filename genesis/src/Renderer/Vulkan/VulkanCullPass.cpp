@@ -0,0 +1,263 @@
+#include "VulkanCullPass.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "Core/FrustumCuller.h"
+#include "Core/Logger.h"
+#include "VulkanShader.h"
+
+namespace Genesis {
+    // matches local_size_x in cull.comp.glsl
+    static constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+    // room for this many visible instances before a frame's index buffer first has to grow
+    static constexpr uint32_t INITIAL_VISIBLE_CAPACITY = 1024;
+    static constexpr uint32_t INITIAL_DRAW_CAPACITY = 64;
+    // one set per frame in flight, a pool holds them all
+    static constexpr uint32_t CULL_DESCRIPTOR_SETS_PER_POOL = 4;
+
+    VulkanCullPass::VulkanCullPass() {
+    }
+
+    VulkanCullPass::~VulkanCullPass() {
+    }
+
+    void VulkanCullPass::init(VulkanDevice& vulkanDevice, uint32_t frameCount) {
+        createPipeline(vulkanDevice);
+
+        m_descriptorAllocator.init(vulkanDevice.logicalDevice(),
+                                   CULL_DESCRIPTOR_SETS_PER_POOL,
+                                   {{vk::DescriptorType::eStorageBufferDynamic, 1.0f},
+                                    {vk::DescriptorType::eStorageBuffer, 3.0f}});
+        m_frames.resize(frameCount);
+
+        GN_CORE_INFO("GPU frustum culling enabled.");
+    }
+
+    void VulkanCullPass::prepareFrame(VulkanDevice& vulkanDevice,
+                                      uint32_t frameIndex,
+                                      const std::vector<vk::DrawIndexedIndirectCommand>& sourceCommands,
+                                      vk::Buffer sourceDraws,
+                                      vk::Buffer objectBuffer) {
+        CullFrame& frame = m_frames[frameIndex];
+
+        uint32_t instanceCount = 0;
+        frame.maxDrawInstances = 0;
+        for (const vk::DrawIndexedIndirectCommand& command : sourceCommands) {
+            instanceCount += command.instanceCount;
+            frame.maxDrawInstances = std::max(frame.maxDrawInstances, command.instanceCount);
+        }
+        frame.drawCount = static_cast<uint32_t>(sourceCommands.size());
+
+        // outgrown buffers may still be in use by an older submit of this frame slot, the deletion queue waits for it
+        if (frame.drawCapacity == 0 || frame.drawCount > frame.drawCapacity) {
+            if (frame.drawCapacity > 0) {
+                frame.drawBuffer.destroyDeferred(vulkanDevice);
+            }
+            frame.drawCapacity = std::max(INITIAL_DRAW_CAPACITY, std::bit_ceil(frame.drawCount));
+            frame.drawBuffer.createBuffer(vulkanDevice,
+                                          frame.drawCapacity * sizeof(vk::DrawIndexedIndirectCommand),
+                                          vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                                          vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                          MemoryCategory::FRAME_RESOURCES);
+        }
+        if (frame.instanceCapacity == 0 || instanceCount > frame.instanceCapacity) {
+            if (frame.instanceCapacity > 0) {
+                frame.visibleBuffer.destroyDeferred(vulkanDevice);
+            }
+            frame.instanceCapacity = std::max(INITIAL_VISIBLE_CAPACITY, std::bit_ceil(instanceCount));
+            frame.visibleBuffer.createBuffer(vulkanDevice,
+                                             frame.instanceCapacity * sizeof(uint32_t),
+                                             vk::BufferUsageFlagBits::eStorageBuffer,
+                                             vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                             MemoryCategory::FRAME_RESOURCES);
+            GN_CORE_TRACE("Culling output of frame {} grew to {} instances.", frameIndex, frame.instanceCapacity);
+        }
+
+        // nothing to cull, the source commands may not even have a buffer yet
+        if (frame.drawCount == 0) {
+            return;
+        }
+
+        if (!frame.descriptorSet) {
+            frame.descriptorSet = m_descriptorAllocator.allocate(m_vkDescriptorSetLayout);
+        }
+        if (frame.sourceDraws != sourceDraws || frame.objectBuffer != objectBuffer ||
+            frame.writtenDrawBuffer != frame.drawBuffer.buffer() || frame.writtenVisibleBuffer != frame.visibleBuffer.buffer()) {
+            frame.sourceDraws = sourceDraws;
+            frame.objectBuffer = objectBuffer;
+            writeDescriptorSet(vulkanDevice, frame);
+        }
+    }
+
+    void VulkanCullPass::record(vk::CommandBuffer commandBuffer, uint32_t frameIndex, uint32_t objectOffset, const glm::mat4& viewProjection) {
+        const CullFrame& frame = m_frames[frameIndex];
+        if (frame.drawCount == 0) {
+            return;
+        }
+
+        // the shader accumulates instance counts with atomics and writes every other field itself
+        commandBuffer.fillBuffer(frame.drawBuffer.buffer(), 0, frame.drawCount * sizeof(vk::DrawIndexedIndirectCommand), 0);
+
+        vk::MemoryBarrier clearBarrier = {};
+        clearBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        clearBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                      vk::PipelineStageFlagBits::eComputeShader,
+                                      vk::DependencyFlags(),
+                                      clearBarrier,
+                                      nullptr,
+                                      nullptr);
+
+        CullParams params = {};
+        FrustumPlanes planes = FrustumCuller::extractPlanes(viewProjection);
+        std::copy(planes.begin(), planes.end(), params.planes);
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_vkPipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_vkPipelineLayout, 0, 1, &frame.descriptorSet, 1, &objectOffset);
+        commandBuffer.pushConstants(m_vkPipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(CullParams), &params);
+        commandBuffer.dispatch((frame.maxDrawInstances + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, frame.drawCount, 1);
+
+        vk::MemoryBarrier cullBarrier = {};
+        cullBarrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+        cullBarrier.dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                      vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader,
+                                      vk::DependencyFlags(),
+                                      cullBarrier,
+                                      nullptr,
+                                      nullptr);
+    }
+
+    void VulkanCullPass::destroy(VulkanDevice& vulkanDevice) {
+        for (CullFrame& frame : m_frames) {
+            if (frame.drawCapacity > 0) {
+                frame.drawBuffer.destroy(vulkanDevice);
+            }
+            if (frame.instanceCapacity > 0) {
+                frame.visibleBuffer.destroy(vulkanDevice);
+            }
+        }
+        m_frames.clear();
+
+        m_descriptorAllocator.destroy();
+        vulkanDevice.logicalDevice().destroyPipeline(m_vkPipeline);
+        vulkanDevice.logicalDevice().destroyPipelineLayout(m_vkPipelineLayout);
+        vulkanDevice.logicalDevice().destroyDescriptorSetLayout(m_vkDescriptorSetLayout);
+    }
+
+    void VulkanCullPass::createPipeline(VulkanDevice& vulkanDevice) {
+        vk::DescriptorSetLayoutBinding objectBinding = {};
+        objectBinding.binding = 0;
+        objectBinding.descriptorCount = 1;
+        objectBinding.descriptorType = vk::DescriptorType::eStorageBufferDynamic;
+        objectBinding.stageFlags = vk::ShaderStageFlagBits::eCompute;
+
+        vk::DescriptorSetLayoutBinding sourceDrawBinding = {};
+        sourceDrawBinding.binding = 1;
+        sourceDrawBinding.descriptorCount = 1;
+        sourceDrawBinding.descriptorType = vk::DescriptorType::eStorageBuffer;
+        sourceDrawBinding.stageFlags = vk::ShaderStageFlagBits::eCompute;
+
+        vk::DescriptorSetLayoutBinding culledDrawBinding = {};
+        culledDrawBinding.binding = 2;
+        culledDrawBinding.descriptorCount = 1;
+        culledDrawBinding.descriptorType = vk::DescriptorType::eStorageBuffer;
+        culledDrawBinding.stageFlags = vk::ShaderStageFlagBits::eCompute;
+
+        vk::DescriptorSetLayoutBinding visibleBinding = {};
+        visibleBinding.binding = 3;
+        visibleBinding.descriptorCount = 1;
+        visibleBinding.descriptorType = vk::DescriptorType::eStorageBuffer;
+        visibleBinding.stageFlags = vk::ShaderStageFlagBits::eCompute;
+
+        std::array<vk::DescriptorSetLayoutBinding, 4> bindings = {objectBinding, sourceDrawBinding, culledDrawBinding, visibleBinding};
+        vk::DescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.flags = vk::DescriptorSetLayoutCreateFlags();
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        try {
+            m_vkDescriptorSetLayout = vulkanDevice.logicalDevice().createDescriptorSetLayout(layoutInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create culling descriptor set layout: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        vk::PushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eCompute;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(CullParams);
+
+        vk::PipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.flags = vk::PipelineLayoutCreateFlags();
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_vkDescriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        try {
+            m_vkPipelineLayout = vulkanDevice.logicalDevice().createPipelineLayout(pipelineLayoutInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create culling pipeline layout: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        VulkanShader cullShader(vulkanDevice, "assets/shaders/cull.comp.spv");
+
+        vk::ComputePipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.flags = vk::PipelineCreateFlags();
+        pipelineInfo.stage.stage = vk::ShaderStageFlagBits::eCompute;
+        pipelineInfo.stage.module = cullShader.shaderModule();
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = m_vkPipelineLayout;
+
+        try {
+            m_vkPipeline = vulkanDevice.logicalDevice().createComputePipeline(vulkanDevice.pipelineCache().pipelineCache(), pipelineInfo).value;
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create culling pipeline: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+    }
+
+    void VulkanCullPass::writeDescriptorSet(VulkanDevice& vulkanDevice, CullFrame& frame) {
+        // the object data offset is dynamic, the range runs from it to the end of the frame allocator page
+        vk::DescriptorBufferInfo objectInfo = {frame.objectBuffer, 0, VK_WHOLE_SIZE};
+        vk::DescriptorBufferInfo sourceDrawInfo = {frame.sourceDraws, 0, VK_WHOLE_SIZE};
+        vk::DescriptorBufferInfo culledDrawInfo = {frame.drawBuffer.buffer(), 0, VK_WHOLE_SIZE};
+        vk::DescriptorBufferInfo visibleInfo = {frame.visibleBuffer.buffer(), 0, VK_WHOLE_SIZE};
+
+        std::array<vk::WriteDescriptorSet, 4> descriptorWrites{};
+        descriptorWrites[0].dstSet = frame.descriptorSet;
+        descriptorWrites[0].dstBinding = 0;
+        descriptorWrites[0].descriptorType = vk::DescriptorType::eStorageBufferDynamic;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pBufferInfo = &objectInfo;
+
+        descriptorWrites[1].dstSet = frame.descriptorSet;
+        descriptorWrites[1].dstBinding = 1;
+        descriptorWrites[1].descriptorType = vk::DescriptorType::eStorageBuffer;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pBufferInfo = &sourceDrawInfo;
+
+        descriptorWrites[2].dstSet = frame.descriptorSet;
+        descriptorWrites[2].dstBinding = 2;
+        descriptorWrites[2].descriptorType = vk::DescriptorType::eStorageBuffer;
+        descriptorWrites[2].descriptorCount = 1;
+        descriptorWrites[2].pBufferInfo = &culledDrawInfo;
+
+        descriptorWrites[3].dstSet = frame.descriptorSet;
+        descriptorWrites[3].dstBinding = 3;
+        descriptorWrites[3].descriptorType = vk::DescriptorType::eStorageBuffer;
+        descriptorWrites[3].descriptorCount = 1;
+        descriptorWrites[3].pBufferInfo = &visibleInfo;
+
+        vulkanDevice.logicalDevice().updateDescriptorSets(descriptorWrites, nullptr);
+
+        frame.writtenDrawBuffer = frame.drawBuffer.buffer();
+        frame.writtenVisibleBuffer = frame.visibleBuffer.buffer();
+    }
+}  // namespace Genesis
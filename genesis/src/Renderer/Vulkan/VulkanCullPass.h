@@ -0,0 +1,66 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "VulkanDescriptorAllocator.h"
+#include "VulkanDevice.h"
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    // Frustum culling on the GPU. A compute pass before the render pass tests every instance's bounding sphere against
+    // the camera frustum, one invocation per instance and one row of workgroups per draw. Survivors are compacted per
+    // subgroup: a ballot counts the visible lanes, a single lane reserves that many slots with one atomic on the draw's
+    // instance count and each visible lane writes its instance index at its rank within the ballot. The graphics pass
+    // draws from the culled commands and reads its object data through the visible instance indices, the CPU only
+    // records one dispatch however many instances there are.
+    class VulkanCullPass {
+        public:
+            VulkanCullPass();
+            ~VulkanCullPass();
+
+            VulkanCullPass(const VulkanCullPass&) = delete;
+            VulkanCullPass& operator=(const VulkanCullPass&) = delete;
+
+            // the culled commands, what the indirect draws of the frame consume
+            vk::Buffer const& drawBuffer(uint32_t frameIndex) const { return m_frames[frameIndex].drawBuffer.buffer(); }
+            // indexed by gl_InstanceIndex, holds the index into the object data of each instance that survived
+            vk::Buffer const& visibleInstanceBuffer(uint32_t frameIndex) const { return m_frames[frameIndex].visibleBuffer.buffer(); }
+
+            void init(VulkanDevice& vulkanDevice, uint32_t frameCount);
+            // sizes the frame's output and points its descriptor set at this frame's object data and source commands,
+            // call once the frame's fence has signalled
+            void prepareFrame(VulkanDevice& vulkanDevice,
+                              uint32_t frameIndex,
+                              const std::vector<vk::DrawIndexedIndirectCommand>& sourceCommands,
+                              vk::Buffer sourceDraws,
+                              vk::Buffer objectBuffer);
+            // records the reset, the culling dispatch and the barriers that hand its output to the indirect draws,
+            // outside of any render pass
+            void record(vk::CommandBuffer commandBuffer, uint32_t frameIndex, uint32_t objectOffset, const glm::mat4& viewProjection);
+            void destroy(VulkanDevice& vulkanDevice);
+
+        private:
+            struct CullFrame {
+                    VulkanBuffer drawBuffer;
+                    uint32_t drawCapacity = 0;
+                    VulkanBuffer visibleBuffer;
+                    uint32_t instanceCapacity = 0;
+                    vk::DescriptorSet descriptorSet;
+                    // what the set was last written with, it is rewritten when any of them changes
+                    vk::Buffer sourceDraws;
+                    vk::Buffer objectBuffer;
+                    vk::Buffer writtenDrawBuffer;
+                    vk::Buffer writtenVisibleBuffer;
+                    uint32_t drawCount = 0;
+                    uint32_t maxDrawInstances = 0;
+            };
+
+            void createPipeline(VulkanDevice& vulkanDevice);
+            void writeDescriptorSet(VulkanDevice& vulkanDevice, CullFrame& frame);
+
+            vk::DescriptorSetLayout m_vkDescriptorSetLayout;
+            vk::PipelineLayout m_vkPipelineLayout;
+            vk::Pipeline m_vkPipeline;
+            VulkanDescriptorAllocator m_descriptorAllocator;
+            std::vector<CullFrame> m_frames;
+    };
+}  // namespace Genesis
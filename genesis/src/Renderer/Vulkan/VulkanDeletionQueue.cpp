@@ -0,0 +1,112 @@
+#include "VulkanDeletionQueue.h"
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    VulkanDeletionQueue::VulkanDeletionQueue() {
+    }
+
+    VulkanDeletionQueue::~VulkanDeletionQueue() {
+    }
+
+    void VulkanDeletionQueue::init(vk::Device device, VulkanAllocator& allocator) {
+        m_vkDevice = device;
+        m_allocator = &allocator;
+        m_slotFrames.clear();
+        m_frameNumber = 0;
+    }
+
+    void VulkanDeletionQueue::beginFrame(uint32_t frameIndex) {
+        std::vector<std::function<void()>> retired;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (frameIndex >= m_slotFrames.size()) {
+                m_slotFrames.resize(frameIndex + 1, 0);
+            }
+
+            // frame numbers only grow, so everything that has retired sits at the front
+            uint64_t completedFrame = m_slotFrames[frameIndex];
+            while (!m_deletions.empty() && m_deletions.front().frameNumber <= completedFrame) {
+                retired.push_back(std::move(m_deletions.front().destroy));
+                m_deletions.pop_front();
+            }
+
+            m_frameNumber++;
+        }
+
+        // outside the lock, a destroy may hand over more work
+        for (std::function<void()>& destroy : retired) {
+            destroy();
+        }
+    }
+
+    void VulkanDeletionQueue::endFrame(uint32_t frameIndex) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (frameIndex >= m_slotFrames.size()) {
+            m_slotFrames.resize(frameIndex + 1, 0);
+        }
+        m_slotFrames[frameIndex] = m_frameNumber;
+    }
+
+    void VulkanDeletionQueue::defer(std::function<void()> destroy) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_deletions.push_back({m_frameNumber, std::move(destroy)});
+    }
+
+    void VulkanDeletionQueue::destroyBuffer(vk::Buffer buffer, VulkanAllocation allocation) {
+        defer([this, buffer, allocation]() mutable {
+            m_vkDevice.destroyBuffer(buffer);
+            m_allocator->free(allocation);
+        });
+    }
+
+    void VulkanDeletionQueue::destroyImage(vk::Image image, VulkanAllocation allocation) {
+        defer([this, image, allocation]() mutable {
+            m_vkDevice.destroyImage(image);
+            m_allocator->free(allocation);
+        });
+    }
+
+    void VulkanDeletionQueue::destroyImageView(vk::ImageView imageView) {
+        defer([this, imageView]() { m_vkDevice.destroyImageView(imageView); });
+    }
+
+    void VulkanDeletionQueue::destroySampler(vk::Sampler sampler) {
+        defer([this, sampler]() { m_vkDevice.destroySampler(sampler); });
+    }
+
+    void VulkanDeletionQueue::destroyFramebuffer(vk::Framebuffer framebuffer) {
+        defer([this, framebuffer]() { m_vkDevice.destroyFramebuffer(framebuffer); });
+    }
+
+    void VulkanDeletionQueue::destroyPipeline(vk::Pipeline pipeline) {
+        defer([this, pipeline]() { m_vkDevice.destroyPipeline(pipeline); });
+    }
+
+    void VulkanDeletionQueue::destroySemaphore(vk::Semaphore semaphore) {
+        defer([this, semaphore]() { m_vkDevice.destroySemaphore(semaphore); });
+    }
+
+    void VulkanDeletionQueue::destroySwapchain(vk::SwapchainKHR swapchain) {
+        defer([this, swapchain]() { m_vkDevice.destroySwapchainKHR(swapchain); });
+    }
+
+    void VulkanDeletionQueue::freeDescriptorSet(vk::DescriptorPool descriptorPool, vk::DescriptorSet descriptorSet) {
+        defer([this, descriptorPool, descriptorSet]() { m_vkDevice.freeDescriptorSets(descriptorPool, descriptorSet); });
+    }
+
+    void VulkanDeletionQueue::flush() {
+        std::deque<Deletion> deletions;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            deletions.swap(m_deletions);
+        }
+
+        if (!deletions.empty()) {
+            GN_CORE_TRACE("Deletion queue flushed {} pending objects.", deletions.size());
+        }
+        for (Deletion& deletion : deletions) {
+            deletion.destroy();
+        }
+    }
+}  // namespace Genesis
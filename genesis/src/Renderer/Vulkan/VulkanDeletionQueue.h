@@ -0,0 +1,61 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "VulkanAllocator.h"
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    // Destroys objects once the GPU can no longer be using them. Everything handed over while frame N is recorded
+    // is tagged with N and destroyed when a later beginFrame learns that N has retired, which it does from the
+    // frame slot it is given: the slot's fence has signalled, so the frame last submitted from it and every frame
+    // submitted before that have completed. A slot only takes a frame number in endFrame, after its submit, so a
+    // frame abandoned before submitting retires nothing; its objects wait for the next frame that is submitted.
+    // Objects handed over before the first frame go on the first beginFrame.
+    // Owned by the device, so anything that can reach the device can free resources mid-frame without a stall.
+    class VulkanDeletionQueue {
+        public:
+            VulkanDeletionQueue();
+            ~VulkanDeletionQueue();
+
+            VulkanDeletionQueue(const VulkanDeletionQueue&) = delete;
+            VulkanDeletionQueue& operator=(const VulkanDeletionQueue&) = delete;
+
+            uint64_t frameNumber() const { return m_frameNumber; }
+
+            void init(vk::Device device, VulkanAllocator& allocator);
+            // call once the frame slot's fence has signalled and before anything of the new frame is recorded
+            void beginFrame(uint32_t frameIndex);
+            // call once the frame has been submitted with the slot's fence
+            void endFrame(uint32_t frameIndex);
+            void defer(std::function<void()> destroy);
+            void destroyBuffer(vk::Buffer buffer, VulkanAllocation allocation);
+            void destroyImage(vk::Image image, VulkanAllocation allocation);
+            void destroyImageView(vk::ImageView imageView);
+            void destroySampler(vk::Sampler sampler);
+            void destroyFramebuffer(vk::Framebuffer framebuffer);
+            void destroyPipeline(vk::Pipeline pipeline);
+            void destroySemaphore(vk::Semaphore semaphore);
+            void destroySwapchain(vk::SwapchainKHR swapchain);
+            void freeDescriptorSet(vk::DescriptorPool descriptorPool, vk::DescriptorSet descriptorSet);
+            // destroys everything still queued, the device must be idle
+            void flush();
+
+        private:
+            struct Deletion {
+                    uint64_t frameNumber;
+                    std::function<void()> destroy;
+            };
+
+            vk::Device m_vkDevice;
+            VulkanAllocator* m_allocator = nullptr;
+
+            std::mutex m_mutex;
+            std::deque<Deletion> m_deletions;
+            // frame number last submitted from each frame slot
+            std::vector<uint64_t> m_slotFrames;
+            uint64_t m_frameNumber = 0;
+    };
+}  // namespace Genesis
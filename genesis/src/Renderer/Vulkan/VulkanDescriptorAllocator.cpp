@@ -0,0 +1,148 @@
+#include "VulkanDescriptorAllocator.h"
+
+#include <algorithm>
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    // every new pool is this much larger than the last, up to the cap
+    static constexpr float DESCRIPTOR_POOL_GROWTH = 1.5f;
+    static constexpr uint32_t DESCRIPTOR_POOL_MAX_SETS = 4096;
+
+    VulkanDescriptorAllocator::VulkanDescriptorAllocator() {
+    }
+
+    VulkanDescriptorAllocator::~VulkanDescriptorAllocator() {
+    }
+
+    void VulkanDescriptorAllocator::init(vk::Device device,
+                                         uint32_t setsPerPool,
+                                         std::vector<DescriptorPoolRatio> ratios,
+                                         vk::DescriptorPoolCreateFlags flags) {
+        m_vkDevice = device;
+        m_setsPerPool = setsPerPool;
+        m_ratios = std::move(ratios);
+        m_flags = flags;
+    }
+
+    vk::DescriptorSet VulkanDescriptorAllocator::allocate(vk::DescriptorSetLayout layout) {
+        vk::DescriptorSetAllocateInfo allocInfo = {};
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &layout;
+
+        vk::DescriptorSet descriptorSet;
+        while (!descriptorSet) {
+            bool freshPool = m_readyPools.empty();
+            allocInfo.descriptorPool = readyPool();
+
+            std::string poolError;
+            try {
+                descriptorSet = m_vkDevice.allocateDescriptorSets(allocInfo)[0];
+            } catch (vk::OutOfPoolMemoryError err) {
+                poolError = err.what();
+            } catch (vk::FragmentedPoolError err) {
+                poolError = err.what();
+            } catch (vk::SystemError err) {
+                std::string errMsg = "Failed to allocate descriptor set: ";
+                GN_CORE_ERROR("{}{}", errMsg, err.what());
+                throw std::runtime_error(errMsg + err.what());
+            }
+
+            if (!poolError.empty()) {
+                // a set that does not fit an empty pool never will, the layout needs a type the ratios lack
+                if (freshPool) {
+                    std::string errMsg = "Failed to allocate descriptor set from a new pool: ";
+                    GN_CORE_ERROR("{}{}", errMsg, poolError);
+                    throw std::runtime_error(errMsg + poolError);
+                }
+                // the pool is done, move on to the next one
+                m_fullPools.push_back(m_readyPools.back());
+                m_readyPools.pop_back();
+            }
+        }
+
+        if (m_flags & vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet) {
+            m_setPools[static_cast<VkDescriptorSet>(descriptorSet)] = allocInfo.descriptorPool;
+        }
+        return descriptorSet;
+    }
+
+    void VulkanDescriptorAllocator::free(vk::DescriptorSet descriptorSet) {
+        auto it = m_setPools.find(static_cast<VkDescriptorSet>(descriptorSet));
+        if (it == m_setPools.end()) {
+            GN_CORE_WARNING("Descriptor set freed that was not allocated by this allocator or it cannot free sets.");
+            return;
+        }
+
+        vk::DescriptorPool pool = it->second;
+        m_vkDevice.freeDescriptorSets(pool, descriptorSet);
+        m_setPools.erase(it);
+
+        // a full pool has room again, put it behind the current one
+        auto full = std::find(m_fullPools.begin(), m_fullPools.end(), pool);
+        if (full != m_fullPools.end()) {
+            m_fullPools.erase(full);
+            m_readyPools.insert(m_readyPools.begin(), pool);
+        }
+    }
+
+    void VulkanDescriptorAllocator::reset() {
+        for (vk::DescriptorPool pool : m_readyPools) {
+            m_vkDevice.resetDescriptorPool(pool);
+        }
+        for (vk::DescriptorPool pool : m_fullPools) {
+            m_vkDevice.resetDescriptorPool(pool);
+            m_readyPools.push_back(pool);
+        }
+        m_fullPools.clear();
+        m_setPools.clear();
+    }
+
+    void VulkanDescriptorAllocator::destroy() {
+        for (vk::DescriptorPool pool : m_readyPools) {
+            m_vkDevice.destroyDescriptorPool(pool);
+        }
+        for (vk::DescriptorPool pool : m_fullPools) {
+            m_vkDevice.destroyDescriptorPool(pool);
+        }
+        m_readyPools.clear();
+        m_fullPools.clear();
+        m_setPools.clear();
+    }
+
+    vk::DescriptorPool VulkanDescriptorAllocator::readyPool() {
+        if (m_readyPools.empty()) {
+            m_readyPools.push_back(createPool(m_setsPerPool));
+            m_setsPerPool = std::min(static_cast<uint32_t>(m_setsPerPool * DESCRIPTOR_POOL_GROWTH), DESCRIPTOR_POOL_MAX_SETS);
+        }
+        return m_readyPools.back();
+    }
+
+    vk::DescriptorPool VulkanDescriptorAllocator::createPool(uint32_t setCount) {
+        std::vector<vk::DescriptorPoolSize> poolSizes;
+        for (const DescriptorPoolRatio& ratio : m_ratios) {
+            vk::DescriptorPoolSize poolSize = {};
+            poolSize.type = ratio.type;
+            poolSize.descriptorCount = std::max(1u, static_cast<uint32_t>(ratio.ratio * setCount));
+            poolSizes.push_back(poolSize);
+        }
+
+        vk::DescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.flags = m_flags;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = setCount;
+
+        vk::DescriptorPool pool;
+        try {
+            pool = m_vkDevice.createDescriptorPool(poolInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create descriptor pool: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        GN_CORE_TRACE("Descriptor pool created for {} sets, {} pools in use.", setCount, poolCount() + 1);
+        return pool;
+    }
+}  // namespace Genesis
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    // descriptors of a type per set in a pool, a pool of n sets holds n * ratio of them
+    struct DescriptorPoolRatio {
+            vk::DescriptorType type;
+            float ratio;
+    };
+
+    // Hands out descriptor sets from a list of pools. When a pool runs out of memory or is too fragmented for the
+    // next set it is put aside and a new, larger one takes over, so the number of sets is bounded by device memory
+    // only. reset() recycles every pool in bulk, which is how per-frame sets are released; allocators created with
+    // eFreeDescriptorSet can also free single sets.
+    class VulkanDescriptorAllocator {
+        public:
+            VulkanDescriptorAllocator();
+            ~VulkanDescriptorAllocator();
+
+            VulkanDescriptorAllocator(const VulkanDescriptorAllocator&) = delete;
+            VulkanDescriptorAllocator& operator=(const VulkanDescriptorAllocator&) = delete;
+
+            size_t poolCount() const { return m_readyPools.size() + m_fullPools.size(); }
+
+            void init(vk::Device device,
+                      uint32_t setsPerPool,
+                      std::vector<DescriptorPoolRatio> ratios,
+                      vk::DescriptorPoolCreateFlags flags = vk::DescriptorPoolCreateFlags());
+            vk::DescriptorSet allocate(vk::DescriptorSetLayout layout);
+            void free(vk::DescriptorSet descriptorSet);
+            void reset();
+            void destroy();
+
+        private:
+            vk::DescriptorPool readyPool();
+            vk::DescriptorPool createPool(uint32_t setCount);
+
+            vk::Device m_vkDevice;
+            vk::DescriptorPoolCreateFlags m_flags;
+            std::vector<DescriptorPoolRatio> m_ratios;
+            uint32_t m_setsPerPool = 0;
+
+            // the last ready pool is the one allocations go to
+            std::vector<vk::DescriptorPool> m_readyPools;
+            std::vector<vk::DescriptorPool> m_fullPools;
+            // only tracked when single sets can be freed
+            std::unordered_map<VkDescriptorSet, vk::DescriptorPool> m_setPools;
+    };
+}  // namespace Genesis
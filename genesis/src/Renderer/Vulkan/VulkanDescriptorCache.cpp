@@ -0,0 +1,128 @@
+#include "VulkanDescriptorCache.h"
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    static constexpr uint32_t DESCRIPTOR_CACHE_SETS_PER_POOL = 64;
+
+    template <typename T>
+    static void hashCombine(size_t& seed, const T& value) {
+        seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    static bool isImageDescriptor(vk::DescriptorType type) {
+        return type == vk::DescriptorType::eCombinedImageSampler || type == vk::DescriptorType::eSampledImage ||
+               type == vk::DescriptorType::eStorageImage || type == vk::DescriptorType::eSampler;
+    }
+
+    bool DescriptorSetKey::operator==(const DescriptorSetKey& other) const {
+        if (layout != other.layout || bindings.size() != other.bindings.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < bindings.size(); i++) {
+            const DescriptorBinding& a = bindings[i];
+            const DescriptorBinding& b = other.bindings[i];
+            if (a.binding != b.binding || a.type != b.type) {
+                return false;
+            }
+            if (isImageDescriptor(a.type)) {
+                if (a.image.imageView != b.image.imageView || a.image.sampler != b.image.sampler || a.image.imageLayout != b.image.imageLayout) {
+                    return false;
+                }
+            } else if (a.buffer.buffer != b.buffer.buffer || a.buffer.offset != b.buffer.offset || a.buffer.range != b.buffer.range) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t DescriptorSetKeyHash::operator()(const DescriptorSetKey& key) const {
+        size_t seed = 0;
+        hashCombine(seed, static_cast<VkDescriptorSetLayout>(key.layout));
+        for (const DescriptorBinding& binding : key.bindings) {
+            hashCombine(seed, binding.binding);
+            hashCombine(seed, static_cast<uint32_t>(binding.type));
+            if (isImageDescriptor(binding.type)) {
+                hashCombine(seed, static_cast<VkImageView>(binding.image.imageView));
+                hashCombine(seed, static_cast<VkSampler>(binding.image.sampler));
+                hashCombine(seed, static_cast<uint32_t>(binding.image.imageLayout));
+            } else {
+                hashCombine(seed, static_cast<VkBuffer>(binding.buffer.buffer));
+                hashCombine(seed, binding.buffer.offset);
+                hashCombine(seed, binding.buffer.range);
+            }
+        }
+        return seed;
+    }
+
+    VulkanDescriptorCache::VulkanDescriptorCache() {
+    }
+
+    VulkanDescriptorCache::~VulkanDescriptorCache() {
+    }
+
+    void VulkanDescriptorCache::init(vk::Device device) {
+        m_vkDevice = device;
+        m_allocator.init(m_vkDevice,
+                         DESCRIPTOR_CACHE_SETS_PER_POOL,
+                         {{vk::DescriptorType::eCombinedImageSampler, 2.0f},
+                          {vk::DescriptorType::eSampledImage, 1.0f},
+                          {vk::DescriptorType::eStorageImage, 0.5f},
+                          {vk::DescriptorType::eUniformBuffer, 1.0f},
+                          {vk::DescriptorType::eStorageBuffer, 1.0f}},
+                         vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet);
+    }
+
+    vk::DescriptorSet VulkanDescriptorCache::getDescriptorSet(vk::DescriptorSetLayout layout, const std::vector<DescriptorBinding>& bindings) {
+        DescriptorSetKey key = {layout, bindings};
+        auto it = m_sets.find(key);
+        if (it != m_sets.end()) {
+            it->second.references++;
+            return it->second.descriptorSet;
+        }
+
+        vk::DescriptorSet descriptorSet = m_allocator.allocate(layout);
+
+        std::vector<vk::WriteDescriptorSet> descriptorWrites(bindings.size());
+        for (size_t i = 0; i < bindings.size(); i++) {
+            descriptorWrites[i].dstSet = descriptorSet;
+            descriptorWrites[i].dstBinding = bindings[i].binding;
+            descriptorWrites[i].dstArrayElement = 0;
+            descriptorWrites[i].descriptorType = bindings[i].type;
+            descriptorWrites[i].descriptorCount = 1;
+            if (isImageDescriptor(bindings[i].type)) {
+                descriptorWrites[i].pImageInfo = &bindings[i].image;
+            } else {
+                descriptorWrites[i].pBufferInfo = &bindings[i].buffer;
+            }
+        }
+        m_vkDevice.updateDescriptorSets(descriptorWrites, nullptr);
+
+        m_sets.emplace(key, CachedSet{descriptorSet, 1});
+        m_keys.emplace(static_cast<VkDescriptorSet>(descriptorSet), std::move(key));
+        return descriptorSet;
+    }
+
+    void VulkanDescriptorCache::release(vk::DescriptorSet descriptorSet) {
+        auto it = m_keys.find(static_cast<VkDescriptorSet>(descriptorSet));
+        if (it == m_keys.end()) {
+            return;
+        }
+
+        auto cached = m_sets.find(it->second);
+        if (--cached->second.references > 0) {
+            return;
+        }
+
+        m_sets.erase(cached);
+        m_keys.erase(it);
+        m_allocator.free(descriptorSet);
+    }
+
+    void VulkanDescriptorCache::destroy() {
+        GN_CORE_TRACE("Descriptor cache destroyed with {} sets in {} pools.", m_sets.size(), m_allocator.poolCount());
+        m_sets.clear();
+        m_keys.clear();
+        m_allocator.destroy();
+    }
+}  // namespace Genesis
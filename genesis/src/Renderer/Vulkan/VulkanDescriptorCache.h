@@ -0,0 +1,56 @@
+#pragma once
+
+#include "VulkanDescriptorAllocator.h"
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    // one descriptor of a set, image or buffer depending on the type
+    struct DescriptorBinding {
+            uint32_t binding;
+            vk::DescriptorType type;
+            vk::DescriptorImageInfo image;
+            vk::DescriptorBufferInfo buffer;
+    };
+
+    struct DescriptorSetKey {
+            vk::DescriptorSetLayout layout;
+            std::vector<DescriptorBinding> bindings;
+
+            bool operator==(const DescriptorSetKey& other) const;
+    };
+
+    struct DescriptorSetKeyHash {
+            size_t operator()(const DescriptorSetKey& key) const;
+    };
+
+    // Long-lived descriptor sets keyed by their layout and contents. Asking for bindings that are already cached
+    // returns the existing set, so every material that uses the same image and sampler shares one. Sets come from a
+    // growable allocator and are counted, every getDescriptorSet is matched by a release and the last one frees the
+    // set. Release only once the GPU is done with the set, e.g. through the deletion queue. Owned by the device.
+    class VulkanDescriptorCache {
+        public:
+            VulkanDescriptorCache();
+            ~VulkanDescriptorCache();
+
+            VulkanDescriptorCache(const VulkanDescriptorCache&) = delete;
+            VulkanDescriptorCache& operator=(const VulkanDescriptorCache&) = delete;
+
+            size_t size() const { return m_sets.size(); }
+
+            void init(vk::Device device);
+            vk::DescriptorSet getDescriptorSet(vk::DescriptorSetLayout layout, const std::vector<DescriptorBinding>& bindings);
+            void release(vk::DescriptorSet descriptorSet);
+            void destroy();
+
+        private:
+            struct CachedSet {
+                    vk::DescriptorSet descriptorSet;
+                    uint32_t references;
+            };
+
+            vk::Device m_vkDevice;
+            VulkanDescriptorAllocator m_allocator;
+            std::unordered_map<DescriptorSetKey, CachedSet, DescriptorSetKeyHash> m_sets;
+            std::unordered_map<VkDescriptorSet, DescriptorSetKey> m_keys;
+    };
+}  // namespace Genesis
@@ -1,8 +1,13 @@
 #include "VulkanDevice.h"
 
+#include <algorithm>
+
 #include "Core/Logger.h"
 
 namespace Genesis {
+    // relative to the working directory, like the assets
+    static constexpr const char* PIPELINE_CACHE_PATH = "pipeline_cache.bin";
+
     VulkanDevice::VulkanDevice() {
     }
 
@@ -33,6 +38,7 @@ namespace Genesis {
             throw std::runtime_error(errMsg);
         }
 
+        m_vkInstance = instance;
         m_vkPhysicalDeviceProperties = m_vkPhysicalDevice.getProperties();
         m_msaaSamples = getMaxUsableSampleCount();
 
@@ -77,6 +83,36 @@ namespace Genesis {
         return indices.isComplete() && extensionSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
     }
 
+    bool VulkanDevice::supportsExtension(const char* extensionName) const {
+        return m_availableExtensions.contains(extensionName);
+    }
+
+    bool VulkanDevice::hostImageCopySupportsLayout(vk::ImageLayout layout) {
+        vk::PhysicalDeviceHostImageCopyPropertiesEXT hostImageCopyProperties = {};
+        vk::PhysicalDeviceProperties2 properties = {};
+        properties.pNext = &hostImageCopyProperties;
+        m_vkPhysicalDevice.getProperties2(&properties);
+
+        std::vector<vk::ImageLayout> copyDstLayouts(hostImageCopyProperties.copyDstLayoutCount);
+        hostImageCopyProperties.pCopyDstLayouts = copyDstLayouts.data();
+        m_vkPhysicalDevice.getProperties2(&properties);
+
+        return std::find(copyDstLayouts.begin(), copyDstLayouts.end(), layout) != copyDstLayouts.end();
+    }
+
+    bool VulkanDevice::supportsHostImageTransfer(vk::Format format) const {
+        if (!m_hostImageCopyEnabled) {
+            return false;
+        }
+
+        vk::FormatProperties3 formatProperties3 = {};
+        vk::FormatProperties2 formatProperties = {};
+        formatProperties.pNext = &formatProperties3;
+        m_vkPhysicalDevice.getFormatProperties2(format, &formatProperties);
+
+        return static_cast<bool>(formatProperties3.optimalTilingFeatures & vk::FormatFeatureFlagBits2::eHostImageTransferEXT);
+    }
+
     bool VulkanDevice::checkDeviceExtensionSupport(const vk::PhysicalDevice& device) {
         std::vector<vk::ExtensionProperties> availableExtensions = device.enumerateDeviceExtensionProperties();
 
@@ -127,6 +163,16 @@ namespace Genesis {
             i++;
         }
 
+        // a family without compute as well is the most likely to be a pure copy engine
+        for (uint32_t family = 0; family < queueFamilies.size(); family++) {
+            vk::QueueFlags flags = queueFamilies[family].queueFlags;
+            if ((flags & vk::QueueFlagBits::eTransfer) && !(flags & vk::QueueFlagBits::eGraphics)) {
+                if (!indices.transferFamily.has_value() || !(flags & vk::QueueFlagBits::eCompute)) {
+                    indices.transferFamily = family;
+                }
+            }
+        }
+
         return indices;
     }
 
@@ -137,6 +183,9 @@ namespace Genesis {
         std::set<uint32_t> uniqueQueueFamilies = {
             indices.graphicsFamily.value(),
             indices.presentFamily.value()};
+        if (indices.transferFamily.has_value()) {
+            uniqueQueueFamilies.insert(indices.transferFamily.value());
+        }
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -147,17 +196,129 @@ namespace Genesis {
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
-        vk::PhysicalDeviceFeatures deviceFeatures = vk::PhysicalDeviceFeatures();
-        deviceFeatures.samplerAnisotropy = true;
-        // deviceFeatures.sampleRateShading = VK_TRUE;  // NOTE: expensive! enable sample shading feature for the device
+        for (const vk::ExtensionProperties& extension : m_vkPhysicalDevice.enumerateDeviceExtensionProperties()) {
+            m_availableExtensions.insert(extension.extensionName);
+        }
+        std::vector<const char*> enabledExtensions(m_deviceExtensions.begin(), m_deviceExtensions.end());
+
+        // host image copy also needs copy_commands2 and format_feature_flags2, both core from 1.3
+        bool hostImageCopyAvailable = supportsExtension(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME) &&
+                                      (m_vkPhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_3 ||
+                                       (supportsExtension(VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME) && supportsExtension(VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME)));
+
+        vk::PhysicalDeviceTimelineSemaphoreFeatures supportedTimelineFeatures = {};
+        vk::PhysicalDeviceDescriptorIndexingFeatures supportedIndexingFeatures = {};
+        vk::PhysicalDeviceHostImageCopyFeaturesEXT supportedHostImageCopyFeatures = {};
+        vk::PhysicalDeviceFeatures2 supportedFeatures = {};
+        supportedFeatures.pNext = &supportedIndexingFeatures;
+        if (hostImageCopyAvailable) {
+            supportedIndexingFeatures.pNext = &supportedHostImageCopyFeatures;
+        }
+        if (m_vkPhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2) {
+            supportedTimelineFeatures.pNext = supportedFeatures.pNext;
+            supportedFeatures.pNext = &supportedTimelineFeatures;
+        }
+        bool pipelineLibraryAvailable = supportsExtension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) && supportsExtension(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+        vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT supportedPipelineLibraryFeatures = {};
+        if (pipelineLibraryAvailable) {
+            supportedPipelineLibraryFeatures.pNext = supportedFeatures.pNext;
+            supportedFeatures.pNext = &supportedPipelineLibraryFeatures;
+        }
+        m_vkPhysicalDevice.getFeatures2(&supportedFeatures);
+
+        vk::PhysicalDeviceFeatures2 deviceFeatures = {};
+        deviceFeatures.features.samplerAnisotropy = true;
+        // deviceFeatures.features.sampleRateShading = VK_TRUE;  // NOTE: expensive! enable sample shading feature for the device
+        // optional, lets the fragment shader write virtual texture feedback
+        deviceFeatures.features.fragmentStoresAndAtomics = supportedFeatures.features.fragmentStoresAndAtomics;
+        // optional, the GPU driven path draws the whole scene from one indirect buffer, each command starting at its
+        // own first instance
+        deviceFeatures.features.multiDrawIndirect = supportedFeatures.features.multiDrawIndirect;
+        deviceFeatures.features.drawIndirectFirstInstance = supportedFeatures.features.drawIndirectFirstInstance;
+
+        // optional, bindless materials need descriptor indexing which is core from 1.2 and an extension before that
+        bool indexingAvailable = m_vkPhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2 || supportsExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+        m_descriptorIndexingEnabled = indexingAvailable &&
+                                      supportedIndexingFeatures.runtimeDescriptorArray &&
+                                      supportedIndexingFeatures.descriptorBindingPartiallyBound &&
+                                      supportedIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+                                      supportedIndexingFeatures.shaderSampledImageArrayNonUniformIndexing;
+
+        vk::PhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+        if (m_descriptorIndexingEnabled) {
+            indexingFeatures.runtimeDescriptorArray = true;
+            indexingFeatures.descriptorBindingPartiallyBound = true;
+            indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = true;
+            indexingFeatures.shaderSampledImageArrayNonUniformIndexing = true;
+            indexingFeatures.pNext = deviceFeatures.pNext;
+            deviceFeatures.pNext = &indexingFeatures;
+            if (m_vkPhysicalDeviceProperties.apiVersion < VK_API_VERSION_1_2) {
+                enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+            }
+        }
+
+        // optional, lets textures be written straight from host memory without staging buffers or submits
+        m_hostImageCopyEnabled = hostImageCopyAvailable && supportedHostImageCopyFeatures.hostImageCopy && hostImageCopySupportsLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+        vk::PhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures = {};
+        if (m_hostImageCopyEnabled) {
+            hostImageCopyFeatures.hostImageCopy = true;
+            hostImageCopyFeatures.pNext = deviceFeatures.pNext;
+            deviceFeatures.pNext = &hostImageCopyFeatures;
+            enabledExtensions.push_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+            if (m_vkPhysicalDeviceProperties.apiVersion < VK_API_VERSION_1_3) {
+                enabledExtensions.push_back(VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME);
+                enabledExtensions.push_back(VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME);
+            }
+        }
+
+        // optional, lets the uploader run on the transfer queue and have the graphics queue wait on it; only the
+        // core 1.2 entry points are used, older devices upload on the graphics queue with fences
+        m_timelineSemaphoreEnabled = supportedTimelineFeatures.timelineSemaphore;
+        vk::PhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+        if (m_timelineSemaphoreEnabled) {
+            timelineFeatures.timelineSemaphore = true;
+            timelineFeatures.pNext = deviceFeatures.pNext;
+            deviceFeatures.pNext = &timelineFeatures;
+        }
+
+        // optional, lets pipelines be linked from separately compiled stages so the optimized compile can run in
+        // the background while draws use a quick link
+        m_graphicsPipelineLibraryEnabled = pipelineLibraryAvailable && supportedPipelineLibraryFeatures.graphicsPipelineLibrary;
+        vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures = {};
+        if (m_graphicsPipelineLibraryEnabled) {
+            pipelineLibraryFeatures.graphicsPipelineLibrary = true;
+            pipelineLibraryFeatures.pNext = deviceFeatures.pNext;
+            deviceFeatures.pNext = &pipelineLibraryFeatures;
+            enabledExtensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+            enabledExtensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+        }
+        m_vkEnabledFeatures = deviceFeatures.features;
+
+        // subgroup operations are core from 1.1 and need no enabling, only which stages and operations have them varies
+        if (m_vkPhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_1) {
+            vk::PhysicalDeviceSubgroupProperties subgroupProperties = {};
+            vk::PhysicalDeviceProperties2 properties = {};
+            properties.pNext = &subgroupProperties;
+            m_vkPhysicalDevice.getProperties2(&properties);
+            vk::SubgroupFeatureFlags ballotOperations = vk::SubgroupFeatureFlagBits::eBasic | vk::SubgroupFeatureFlagBits::eBallot;
+            m_subgroupBallotSupported = (subgroupProperties.supportedStages & vk::ShaderStageFlagBits::eCompute) &&
+                                        (subgroupProperties.supportedOperations & ballotOperations) == ballotOperations;
+        }
+
+        // optional, gives the driver's view of heap usage and budget, which includes other processes and the driver itself
+        m_memoryBudgetEnabled = m_vkPhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_1 && supportsExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (m_memoryBudgetEnabled) {
+            enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
 
         vk::DeviceCreateInfo createInfo = vk::DeviceCreateInfo(vk::DeviceCreateFlags(),
                                                                static_cast<uint32_t>(queueCreateInfos.size()),
                                                                queueCreateInfos.data(),
                                                                0, nullptr,
-                                                               static_cast<uint32_t>(m_deviceExtensions.size()),
-                                                               m_deviceExtensions.data(),
-                                                               &deviceFeatures);
+                                                               static_cast<uint32_t>(enabledExtensions.size()),
+                                                               enabledExtensions.data(),
+                                                               nullptr);
+        createInfo.pNext = &deviceFeatures;
 
         try {
             m_vkDevice = m_vkPhysicalDevice.createDevice(createInfo);
@@ -169,8 +330,41 @@ namespace Genesis {
 
         m_vkGraphicsQueue = m_vkDevice.getQueue(indices.graphicsFamily.value(), 0);
         m_vkPresentQueue = m_vkDevice.getQueue(indices.presentFamily.value(), 0);
+        m_graphicsQueueFamily = indices.graphicsFamily.value();
+        m_transferQueueFamily = indices.transferFamily.value_or(m_graphicsQueueFamily);
+        m_vkTransferQueue = m_vkDevice.getQueue(m_transferQueueFamily, 0);
+
+        // extension entry points are not exported by the loader, they are resolved through the device
+        m_vkDldd = vk::DispatchLoaderDynamic(m_vkInstance, vkGetInstanceProcAddr, m_vkDevice);
+
+        m_samplerCache.init(m_vkDevice, m_vkEnabledFeatures.samplerAnisotropy, m_vkPhysicalDeviceProperties.limits.maxSamplerAnisotropy);
+        // dedicated allocation hints are core from 1.1, older devices just get size based dedicated allocations
+        m_allocator.init(m_vkPhysicalDevice, m_vkDevice, m_vkPhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_1, m_memoryBudgetEnabled);
+        m_deletionQueue.init(m_vkDevice, m_allocator);
+        m_descriptorCache.init(m_vkDevice);
+        m_pipelineCache.init(m_vkDevice, m_vkPhysicalDeviceProperties, PIPELINE_CACHE_PATH);
 
         GN_CORE_INFO("Vulkan logical device created.");
+        GN_CORE_TRACE("\tDescriptor indexing: {}", m_descriptorIndexingEnabled ? "enabled" : "unavailable");
+        GN_CORE_TRACE("\tHost image copy: {}", m_hostImageCopyEnabled ? "enabled" : "unavailable");
+        GN_CORE_TRACE("\tTimeline semaphores: {}", m_timelineSemaphoreEnabled ? "enabled" : "unavailable");
+        GN_CORE_TRACE("\tMemory budget: {}", m_memoryBudgetEnabled ? "enabled" : "unavailable");
+        GN_CORE_TRACE("\tGraphics pipeline library: {}", m_graphicsPipelineLibraryEnabled ? "enabled" : "unavailable");
+        GN_CORE_TRACE("\tSubgroup ballot in compute: {}", m_subgroupBallotSupported ? "supported" : "unavailable");
+        GN_CORE_TRACE("\tTransfer queue family: {}", indices.transferFamily.has_value() ? std::to_string(m_transferQueueFamily) : "none");
+    }
+
+    void VulkanDevice::shutdown() {
+        m_deletionQueue.flush();
+        m_descriptorCache.destroy();
+        // every pipeline built this run is in the cache by now, the next launch starts from it
+        m_pipelineCache.save();
+        m_pipelineCache.destroy();
+        // cached samplers are shared by every texture, so they live exactly as long as the device
+        m_samplerCache.destroy();
+        m_allocator.logStats();
+        m_allocator.destroy();
+        m_vkDevice.destroy();
     }
 
     vk::SampleCountFlagBits VulkanDevice::getMaxUsableSampleCount() {
@@ -197,17 +391,4 @@ namespace Genesis {
 
         return vk::SampleCountFlagBits::e1;
     }
-
-    uint32_t VulkanDevice::findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) {
-        vk::PhysicalDeviceMemoryProperties memProperties = physicalDevice().getMemoryProperties();
-
-        for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-            if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-                return i;
-            }
-        }
-
-        GN_CORE_ERROR("Failed to find suitable memory type.");
-        return 0;
-    }
 }  // namespace Genesis
@@ -1,5 +1,10 @@
 #pragma once
 
+#include "VulkanAllocator.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanDescriptorCache.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanSamplerCache.h"
 #include "VulkanTypes.h"
 
 namespace Genesis {
@@ -13,29 +18,68 @@ namespace Genesis {
 
             vk::PhysicalDevice const& physicalDevice() const { return m_vkPhysicalDevice; }
             vk::PhysicalDeviceProperties const& physicalDeviceProperties() const { return m_vkPhysicalDeviceProperties; }
+            vk::PhysicalDeviceFeatures const& enabledFeatures() const { return m_vkEnabledFeatures; }
             vk::Device const& logicalDevice() const { return m_vkDevice; }
             vk::Queue const& graphicsQueue() const { return m_vkGraphicsQueue; }
             vk::Queue const& presentQueue() const { return m_vkPresentQueue; }
+            // the graphics queue when the device has no dedicated transfer family
+            vk::Queue const& transferQueue() const { return m_vkTransferQueue; }
+            uint32_t graphicsQueueFamily() const { return m_graphicsQueueFamily; }
+            uint32_t transferQueueFamily() const { return m_transferQueueFamily; }
             vk::SampleCountFlagBits const& msaaSamples() const { return m_msaaSamples; }
+            bool descriptorIndexingEnabled() const { return m_descriptorIndexingEnabled; }
+            bool hostImageCopyEnabled() const { return m_hostImageCopyEnabled; }
+            bool timelineSemaphoreEnabled() const { return m_timelineSemaphoreEnabled; }
+            bool memoryBudgetEnabled() const { return m_memoryBudgetEnabled; }
+            bool graphicsPipelineLibraryEnabled() const { return m_graphicsPipelineLibraryEnabled; }
+            // compute shaders may use the basic and ballot subgroup operations
+            bool subgroupBallotSupported() const { return m_subgroupBallotSupported; }
+            vk::DispatchLoaderDynamic const& dispatcher() const { return m_vkDldd; }
+            VulkanSamplerCache& samplerCache() { return m_samplerCache; }
+            VulkanAllocator& allocator() { return m_allocator; }
+            VulkanDeletionQueue& deletionQueue() { return m_deletionQueue; }
+            VulkanDescriptorCache& descriptorCache() { return m_descriptorCache; }
+            VulkanPipelineCache& pipelineCache() { return m_pipelineCache; }
 
             void pickPhysicalDevice(const vk::Instance& instance, const vk::SurfaceKHR surface);
             void createLogicalDevice(const vk::SurfaceKHR surface);
+            void shutdown();
 
             SwapChainSupportDetails querySwapChainSupport(const vk::PhysicalDevice& device, const vk::SurfaceKHR surface);
             QueueFamilyIndices findQueueFamilies(const vk::PhysicalDevice& device, const vk::SurfaceKHR surface);
-            uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties);
+            bool supportsExtension(const char* extensionName) const;
+            bool supportsHostImageTransfer(vk::Format format) const;
 
         private:
             bool isDeviceSuitable(const vk::PhysicalDevice& device, const vk::SurfaceKHR surface);
             bool checkDeviceExtensionSupport(const vk::PhysicalDevice& device);
+            bool hostImageCopySupportsLayout(vk::ImageLayout layout);
             vk::SampleCountFlagBits getMaxUsableSampleCount();
 
+            vk::Instance m_vkInstance{nullptr};
             vk::PhysicalDevice m_vkPhysicalDevice{nullptr};
             vk::PhysicalDeviceProperties m_vkPhysicalDeviceProperties;
+            vk::PhysicalDeviceFeatures m_vkEnabledFeatures;
             vk::Device m_vkDevice{nullptr};
             vk::Queue m_vkGraphicsQueue{nullptr};
             vk::Queue m_vkPresentQueue{nullptr};
+            vk::Queue m_vkTransferQueue{nullptr};
+            uint32_t m_graphicsQueueFamily = 0;
+            uint32_t m_transferQueueFamily = 0;
             const std::vector<const char*> m_deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+            std::set<std::string> m_availableExtensions;
+            bool m_descriptorIndexingEnabled = false;
+            bool m_hostImageCopyEnabled = false;
+            bool m_timelineSemaphoreEnabled = false;
+            bool m_memoryBudgetEnabled = false;
+            bool m_graphicsPipelineLibraryEnabled = false;
+            bool m_subgroupBallotSupported = false;
+            vk::DispatchLoaderDynamic m_vkDldd;
+            VulkanSamplerCache m_samplerCache;
+            VulkanAllocator m_allocator;
+            VulkanDeletionQueue m_deletionQueue;
+            VulkanDescriptorCache m_descriptorCache;
+            VulkanPipelineCache m_pipelineCache;
             vk::SampleCountFlagBits m_msaaSamples = vk::SampleCountFlagBits::e1;
     };
 }  // namespace Genesis
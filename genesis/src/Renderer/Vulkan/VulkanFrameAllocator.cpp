@@ -0,0 +1,84 @@
+#include "VulkanFrameAllocator.h"
+
+#include <algorithm>
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    static constexpr vk::DeviceSize FRAME_ALLOCATOR_PAGE_SIZE = 4 * 1024 * 1024;
+
+    VulkanFrameAllocator::VulkanFrameAllocator() {
+    }
+
+    VulkanFrameAllocator::~VulkanFrameAllocator() {
+    }
+
+    void VulkanFrameAllocator::init(VulkanDevice& vulkanDevice, uint32_t frameCount) {
+        const vk::PhysicalDeviceLimits& limits = vulkanDevice.physicalDeviceProperties().limits;
+        m_alignment = std::max({vk::DeviceSize(16), limits.minStorageBufferOffsetAlignment, limits.minUniformBufferOffsetAlignment});
+
+        m_frames.resize(frameCount);
+        for (FrameChain& frame : m_frames) {
+            frame.pages.clear();
+            frame.currentPage = 0;
+        }
+        m_frameIndex = 0;
+    }
+
+    void VulkanFrameAllocator::beginFrame(uint32_t frameIndex) {
+        m_frameIndex = frameIndex;
+
+        FrameChain& frame = m_frames[m_frameIndex];
+        for (FramePage& page : frame.pages) {
+            page.head = 0;
+        }
+        frame.currentPage = 0;
+    }
+
+    FrameAllocation VulkanFrameAllocator::allocate(VulkanDevice& vulkanDevice, vk::DeviceSize size) {
+        FrameChain& frame = m_frames[m_frameIndex];
+        size = std::max(size, vk::DeviceSize(1));
+
+        // pages before the current one are treated as full, so a frame never goes back to fill gaps
+        for (; frame.currentPage < frame.pages.size(); frame.currentPage++) {
+            FramePage& page = frame.pages[frame.currentPage];
+            vk::DeviceSize offset = (page.head + m_alignment - 1) / m_alignment * m_alignment;
+            if (offset + size <= page.size) {
+                page.head = offset + size;
+                return {page.buffer.buffer(), static_cast<uint32_t>(offset), static_cast<uint8_t*>(page.buffer.mappedData()) + offset};
+            }
+        }
+
+        FramePage page = {};
+        page.size = std::max(FRAME_ALLOCATOR_PAGE_SIZE, (size + m_alignment - 1) / m_alignment * m_alignment);
+        page.head = size;
+        page.buffer.createBuffer(vulkanDevice,
+                                 page.size,
+                                 vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eUniformBuffer,
+                                 vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                 MemoryCategory::FRAME_RESOURCES);
+        frame.pages.push_back(page);
+        frame.currentPage = frame.pages.size() - 1;
+
+        GN_CORE_TRACE("Frame allocator for frame {} grew to {} pages ({} KiB).", m_frameIndex, frame.pages.size(), capacity(m_frameIndex) / 1024);
+
+        return {page.buffer.buffer(), 0, page.buffer.mappedData()};
+    }
+
+    vk::DeviceSize VulkanFrameAllocator::capacity(uint32_t frameIndex) const {
+        vk::DeviceSize total = 0;
+        for (const FramePage& page : m_frames[frameIndex].pages) {
+            total += page.size;
+        }
+        return total;
+    }
+
+    void VulkanFrameAllocator::destroy(VulkanDevice& vulkanDevice) {
+        for (FrameChain& frame : m_frames) {
+            for (FramePage& page : frame.pages) {
+                page.buffer.destroy(vulkanDevice);
+            }
+        }
+        m_frames.clear();
+    }
+}  // namespace Genesis
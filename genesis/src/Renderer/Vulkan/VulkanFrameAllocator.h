@@ -0,0 +1,50 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    struct FrameAllocation {
+            vk::Buffer buffer;
+            // bind the whole buffer and pass this as the dynamic offset
+            uint32_t offset;
+            void* data;
+    };
+
+    // Bump allocator for data written by the CPU once per frame and read by the GPU in that frame only, e.g. per
+    // instance transforms. Every frame in flight owns a chain of persistently mapped pages; a frame that outgrows its
+    // chain appends a page, and the chain is kept, so after the first few frames nothing is allocated anymore.
+    // beginFrame rewinds a frame's chain and must only be called once that frame's fence has signalled.
+    class VulkanFrameAllocator {
+        public:
+            VulkanFrameAllocator();
+            ~VulkanFrameAllocator();
+
+            VulkanFrameAllocator(const VulkanFrameAllocator&) = delete;
+            VulkanFrameAllocator& operator=(const VulkanFrameAllocator&) = delete;
+
+            void init(VulkanDevice& vulkanDevice, uint32_t frameCount);
+            void beginFrame(uint32_t frameIndex);
+            // size bytes from the current frame, aligned for both uniform and storage buffer dynamic offsets
+            FrameAllocation allocate(VulkanDevice& vulkanDevice, vk::DeviceSize size);
+            vk::DeviceSize capacity(uint32_t frameIndex) const;
+            void destroy(VulkanDevice& vulkanDevice);
+
+        private:
+            struct FramePage {
+                    VulkanBuffer buffer;
+                    vk::DeviceSize size;
+                    vk::DeviceSize head;
+            };
+
+            struct FrameChain {
+                    std::vector<FramePage> pages;
+                    size_t currentPage;
+            };
+
+            std::vector<FrameChain> m_frames;
+            uint32_t m_frameIndex = 0;
+            vk::DeviceSize m_alignment = 16;
+    };
+}  // namespace Genesis
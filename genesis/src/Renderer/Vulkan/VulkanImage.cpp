@@ -21,14 +21,16 @@ namespace Genesis {
                                   vk::Format format,
                                   vk::ImageTiling tiling,
                                   vk::ImageUsageFlags usage,
-                                  vk::MemoryPropertyFlags properties) {
+                                  vk::MemoryPropertyFlags properties,
+                                  MemoryCategory category,
+                                  uint32_t arrayLayers) {
         vk::ImageCreateInfo imageInfo = {};
         imageInfo.imageType = vk::ImageType::e2D;
         imageInfo.extent.width = width;
         imageInfo.extent.height = height;
         imageInfo.extent.depth = 1;
         imageInfo.mipLevels = mipLevels;
-        imageInfo.arrayLayers = 1;
+        imageInfo.arrayLayers = arrayLayers;
         imageInfo.format = format;
         imageInfo.tiling = tiling;
         imageInfo.initialLayout = vk::ImageLayout::eUndefined;
@@ -44,20 +46,7 @@ namespace Genesis {
             throw std::runtime_error(errMsg + err.what());
         }
 
-        vk::MemoryRequirements memRequirements = vulkanDevice.logicalDevice().getImageMemoryRequirements(m_vkImage);
-
-        vk::MemoryAllocateInfo allocInfo = {};
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = vulkanDevice.findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        try {
-            m_vkImageMemory = vulkanDevice.logicalDevice().allocateMemory(allocInfo);
-            vulkanDevice.logicalDevice().bindImageMemory(m_vkImage, m_vkImageMemory, 0);
-        } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to allocate image memory: ";
-            GN_CORE_ERROR("{}{}", errMsg, err.what());
-            throw std::runtime_error(errMsg + err.what());
-        }
+        m_allocation = vulkanDevice.allocator().allocateImage(m_vkImage, tiling, properties, category);
 
         GN_CORE_INFO("Image loaded successfully.");
     }
@@ -66,10 +55,12 @@ namespace Genesis {
                                       vk::Image image,
                                       vk::Format format,
                                       vk::ImageAspectFlags aspectFlags,
-                                      uint32_t mipLevels) {
+                                      uint32_t mipLevels,
+                                      vk::ImageViewType viewType,
+                                      uint32_t arrayLayers) {
         vk::ImageViewCreateInfo viewInfo = {};
         viewInfo.image = image;
-        viewInfo.viewType = vk::ImageViewType::e2D;
+        viewInfo.viewType = viewType;
         viewInfo.format = format;
         viewInfo.components.r = vk::ComponentSwizzle::eIdentity;
         viewInfo.components.g = vk::ComponentSwizzle::eIdentity;
@@ -79,7 +70,7 @@ namespace Genesis {
         viewInfo.subresourceRange.baseMipLevel = 0;
         viewInfo.subresourceRange.levelCount = mipLevels;
         viewInfo.subresourceRange.baseArrayLayer = 0;
-        viewInfo.subresourceRange.layerCount = 1;
+        viewInfo.subresourceRange.layerCount = arrayLayers;
 
         try {
             m_vkImageView = vulkanDevice.logicalDevice().createImageView(viewInfo);
@@ -101,6 +92,29 @@ namespace Genesis {
                                             VulkanCommandBuffer& vulkanCommandBuffer) {
         vulkanCommandBuffer.beginSingleTimeCommands(vulkanDevice);
 
+        recordTransitionImageLayout(vulkanCommandBuffer.commandBuffer(), image, format, oldLayout, newLayout, mipLevels);
+
+        vulkanCommandBuffer.endSingleTimeCommands(vulkanDevice);
+    }
+
+    void VulkanImage::copyBufferToImage(VulkanDevice& vulkanDevice,
+                                        vk::Buffer buffer,
+                                        uint32_t width,
+                                        uint32_t height,
+                                        VulkanCommandBuffer& vulkanCommandBuffer) {
+        vulkanCommandBuffer.beginSingleTimeCommands(vulkanDevice);
+
+        recordCopyBufferToImage(vulkanCommandBuffer.commandBuffer(), buffer, 0, width, height, 0);
+
+        vulkanCommandBuffer.endSingleTimeCommands(vulkanDevice);
+    }
+
+    void VulkanImage::recordTransitionImageLayout(vk::CommandBuffer commandBuffer,
+                                                  vk::Image image,
+                                                  vk::Format format,
+                                                  vk::ImageLayout oldLayout,
+                                                  vk::ImageLayout newLayout,
+                                                  uint32_t mipLevels) {
         vk::ImageMemoryBarrier barrier = {};
         barrier.oldLayout = oldLayout;
         barrier.newLayout = newLayout;
@@ -150,42 +164,37 @@ namespace Genesis {
             throw std::runtime_error(errMsg);
         }
 
-        vulkanCommandBuffer.commandBuffer().pipelineBarrier(sourceStage,
-                                                            destinationStage,
-                                                            vk::DependencyFlags(),
-                                                            nullptr,
-                                                            nullptr,
-                                                            barrier);
-
-        vulkanCommandBuffer.endSingleTimeCommands(vulkanDevice);
+        commandBuffer.pipelineBarrier(sourceStage,
+                                      destinationStage,
+                                      vk::DependencyFlags(),
+                                      nullptr,
+                                      nullptr,
+                                      barrier);
     }
 
-    void VulkanImage::copyBufferToImage(VulkanDevice& vulkanDevice,
-                                        vk::Buffer buffer,
-                                        uint32_t width,
-                                        uint32_t height,
-                                        VulkanCommandBuffer& vulkanCommandBuffer) {
-        vulkanCommandBuffer.beginSingleTimeCommands(vulkanDevice);
-
+    void VulkanImage::recordCopyBufferToImage(vk::CommandBuffer commandBuffer,
+                                              vk::Buffer buffer,
+                                              vk::DeviceSize bufferOffset,
+                                              uint32_t width,
+                                              uint32_t height,
+                                              uint32_t mipLevel) {
         vk::BufferImageCopy region = {};
-        region.bufferOffset = 0;
+        region.bufferOffset = bufferOffset;
         region.bufferRowLength = 0;
         region.bufferImageHeight = 0;
 
         region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.mipLevel = mipLevel;
         region.imageSubresource.baseArrayLayer = 0;
         region.imageSubresource.layerCount = 1;
 
         region.imageOffset = vk::Offset3D(0, 0, 0);
         region.imageExtent = vk::Extent3D(width, height, 1);
 
-        vulkanCommandBuffer.commandBuffer().copyBufferToImage(buffer,
-                                                              m_vkImage,
-                                                              vk::ImageLayout::eTransferDstOptimal,
-                                                              region);
-
-        vulkanCommandBuffer.endSingleTimeCommands(vulkanDevice);
+        commandBuffer.copyBufferToImage(buffer,
+                                        m_vkImage,
+                                        vk::ImageLayout::eTransferDstOptimal,
+                                        region);
     }
 
     bool VulkanImage::hasStencilComponent(vk::Format format) {
@@ -203,7 +212,17 @@ namespace Genesis {
     }
 
     void VulkanImage::freeImageMemory(VulkanDevice& vulkanDevice) {
-        vulkanDevice.logicalDevice().freeMemory(m_vkImageMemory);
+        vulkanDevice.allocator().free(m_allocation);
         GN_CORE_TRACE("Vulkan image memory freed successfully.");
     }
+
+    void VulkanImage::destroyDeferred(VulkanDevice& vulkanDevice) {
+        if (m_vkImageView) {
+            vulkanDevice.deletionQueue().destroyImageView(m_vkImageView);
+        }
+        vulkanDevice.deletionQueue().destroyImage(m_vkImage, m_allocation);
+        m_vkImageView = nullptr;
+        m_vkImage = nullptr;
+        m_allocation = VulkanAllocation();
+    }
 }  // namespace Genesis
@@ -12,7 +12,7 @@ namespace Genesis {
 
             vk::Image const& image() const { return m_vkImage; }
             vk::ImageView const& imageView() const { return m_vkImageView; }
-            vk::DeviceMemory const& imageMemory() const { return m_vkImageMemory; }
+            VulkanAllocation const& allocation() const { return m_allocation; }
 
             void setImage(vk::Image image);
             void createImage(VulkanDevice& vulkanDevice,
@@ -23,12 +23,16 @@ namespace Genesis {
                              vk::Format format,
                              vk::ImageTiling tiling,
                              vk::ImageUsageFlags usage,
-                             vk::MemoryPropertyFlags properties);
+                             vk::MemoryPropertyFlags properties,
+                             MemoryCategory category,
+                             uint32_t arrayLayers = 1);
             void createImageView(VulkanDevice& device,
                                  vk::Image image,
                                  vk::Format format,
                                  vk::ImageAspectFlags aspectFlags,
-                                 uint32_t mipLevels);
+                                 uint32_t mipLevels,
+                                 vk::ImageViewType viewType = vk::ImageViewType::e2D,
+                                 uint32_t arrayLayers = 1);
             void transitionImageLayout(VulkanDevice& vulkanDevice,
                                        vk::Image image,
                                        vk::Format format,
@@ -41,16 +45,30 @@ namespace Genesis {
                                    uint32_t width,
                                    uint32_t height,
                                    VulkanCommandBuffer& vulkanCommandBuffer);
+            void recordTransitionImageLayout(vk::CommandBuffer commandBuffer,
+                                             vk::Image image,
+                                             vk::Format format,
+                                             vk::ImageLayout oldLayout,
+                                             vk::ImageLayout newLayout,
+                                             uint32_t mipLevels);
+            void recordCopyBufferToImage(vk::CommandBuffer commandBuffer,
+                                         vk::Buffer buffer,
+                                         vk::DeviceSize bufferOffset,
+                                         uint32_t width,
+                                         uint32_t height,
+                                         uint32_t mipLevel);
 
             void destroyImage(VulkanDevice& vulkanDevice);
             void destroyImageView(VulkanDevice& vulkanDevice);
             void freeImageMemory(VulkanDevice& vulkanDevice);
+            // hands the view, image and memory to the deletion queue, for images the GPU may still be reading
+            void destroyDeferred(VulkanDevice& vulkanDevice);
 
         private:
             bool hasStencilComponent(vk::Format format);
 
             vk::Image m_vkImage = {};
             vk::ImageView m_vkImageView;
-            vk::DeviceMemory m_vkImageMemory;
+            VulkanAllocation m_allocation;
     };
 }  // namespace Genesis
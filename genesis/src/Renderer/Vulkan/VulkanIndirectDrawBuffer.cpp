@@ -0,0 +1,83 @@
+#include "VulkanIndirectDrawBuffer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    // room for this many commands before a frame's buffer first has to grow
+    static constexpr uint32_t INITIAL_INDIRECT_CAPACITY = 64;
+
+    VulkanIndirectDrawBuffer::VulkanIndirectDrawBuffer() {
+    }
+
+    VulkanIndirectDrawBuffer::~VulkanIndirectDrawBuffer() {
+    }
+
+    void VulkanIndirectDrawBuffer::init(VulkanDevice& vulkanDevice, uint32_t frameCount) {
+        // without the feature every command still goes through the indirect buffer, one call each
+        m_multiDrawIndirect = vulkanDevice.enabledFeatures().multiDrawIndirect;
+        m_maxDrawCount = m_multiDrawIndirect ? std::max(vulkanDevice.physicalDeviceProperties().limits.maxDrawIndirectCount, 1u) : 1;
+
+        m_frames.resize(frameCount);
+        m_commands.clear();
+        m_generation = 1;
+
+        GN_CORE_INFO("Indirect draw buffer created, multi draw indirect {}.", m_multiDrawIndirect ? "enabled" : "not available");
+    }
+
+    void VulkanIndirectDrawBuffer::setCommands(const std::vector<vk::DrawIndexedIndirectCommand>& commands) {
+        if (commands == m_commands) {
+            return;
+        }
+
+        m_commands = commands;
+        m_generation++;
+    }
+
+    void VulkanIndirectDrawBuffer::prepareFrame(VulkanDevice& vulkanDevice, uint32_t frameIndex) {
+        IndirectFrame& frame = m_frames[frameIndex];
+        if (frame.generation == m_generation) {
+            return;
+        }
+
+        if (m_commands.size() > frame.capacity) {
+            // the previous buffer may still be read by an older submit of this frame slot
+            if (frame.capacity > 0) {
+                frame.buffer.destroyDeferred(vulkanDevice);
+            }
+            frame.capacity = std::max(INITIAL_INDIRECT_CAPACITY, std::bit_ceil(static_cast<uint32_t>(m_commands.size())));
+            // also a storage buffer, so a compute pass can write the commands instead of the CPU
+            frame.buffer.createBuffer(vulkanDevice,
+                                      frame.capacity * sizeof(vk::DrawIndexedIndirectCommand),
+                                      vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+                                      vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                      MemoryCategory::FRAME_RESOURCES);
+        }
+
+        std::memcpy(frame.buffer.mappedData(), m_commands.data(), m_commands.size() * sizeof(vk::DrawIndexedIndirectCommand));
+        frame.generation = m_generation;
+
+        GN_CORE_TRACE2("Indirect draws of frame {} rewritten, {} commands.", frameIndex, m_commands.size());
+    }
+
+    void VulkanIndirectDrawBuffer::record(vk::CommandBuffer commandBuffer, vk::Buffer buffer) const {
+        uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+        for (uint32_t first = 0; first < m_commands.size(); first += m_maxDrawCount) {
+            uint32_t count = std::min(m_maxDrawCount, static_cast<uint32_t>(m_commands.size()) - first);
+            commandBuffer.drawIndexedIndirect(buffer, vk::DeviceSize(first) * stride, count, stride);
+        }
+    }
+
+    void VulkanIndirectDrawBuffer::destroy(VulkanDevice& vulkanDevice) {
+        for (IndirectFrame& frame : m_frames) {
+            if (frame.capacity > 0) {
+                frame.buffer.destroy(vulkanDevice);
+            }
+        }
+        m_frames.clear();
+        m_commands.clear();
+    }
+}  // namespace Genesis
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    // Draw commands for the GPU driven path. Every frame in flight owns a persistently mapped buffer of
+    // vk::DrawIndexedIndirectCommand which the graphics pass consumes with drawIndexedIndirect. The current commands
+    // are kept on the CPU and only copied into a frame's buffer when they changed since that buffer was written, so
+    // while mesh types, instance counts and mesh ranges stay put a frame writes nothing and issues a single draw call,
+    // however many instances the scene has.
+    class VulkanIndirectDrawBuffer {
+        public:
+            VulkanIndirectDrawBuffer();
+            ~VulkanIndirectDrawBuffer();
+
+            VulkanIndirectDrawBuffer(const VulkanIndirectDrawBuffer&) = delete;
+            VulkanIndirectDrawBuffer& operator=(const VulkanIndirectDrawBuffer&) = delete;
+
+            uint32_t drawCount() const { return static_cast<uint32_t>(m_commands.size()); }
+            vk::Buffer const& buffer(uint32_t frameIndex) const { return m_frames[frameIndex].buffer.buffer(); }
+
+            void init(VulkanDevice& vulkanDevice, uint32_t frameCount);
+            // replaces the current commands, nothing is marked for rewriting when they are the same as before
+            void setCommands(const std::vector<vk::DrawIndexedIndirectCommand>& commands);
+            // brings the frame's buffer up to date with the current commands, call once its fence has signalled
+            void prepareFrame(VulkanDevice& vulkanDevice, uint32_t frameIndex);
+            // issues drawCount() commands from the buffer, in one call when multi draw indirect is available; the
+            // buffer is the frame's own or one holding the same commands after culling
+            void record(vk::CommandBuffer commandBuffer, vk::Buffer buffer) const;
+            void destroy(VulkanDevice& vulkanDevice);
+
+        private:
+            struct IndirectFrame {
+                    VulkanBuffer buffer;
+                    uint32_t capacity = 0;
+                    // the generation of the commands the buffer holds
+                    uint64_t generation = 0;
+            };
+
+            std::vector<IndirectFrame> m_frames;
+            std::vector<vk::DrawIndexedIndirectCommand> m_commands;
+            // bumped whenever the commands change, a frame holding an older generation is rewritten
+            uint64_t m_generation = 1;
+            bool m_multiDrawIndirect = false;
+            uint32_t m_maxDrawCount = 1;
+    };
+}  // namespace Genesis
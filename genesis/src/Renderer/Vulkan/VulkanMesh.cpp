@@ -62,27 +62,20 @@ namespace Genesis {
         stagingBuffer.createBuffer(vulkanDevice,
                                    bufferSize,
                                    vk::BufferUsageFlagBits::eTransferSrc,
-                                   vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-
-        try {
-            void* data = vulkanDevice.logicalDevice().mapMemory(stagingBuffer.memory(), vk::DeviceSize(0), bufferSize, vk::MemoryMapFlags());
-            memcpy(data, vertices.data(), (size_t)bufferSize);
-            vulkanDevice.logicalDevice().unmapMemory(stagingBuffer.memory());
-        } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to copy memory: ";
-            GN_CORE_ERROR("{}{}", errMsg, err.what());
-            throw std::runtime_error(errMsg + err.what());
-        }
+                                   vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                   MemoryCategory::STAGING);
+
+        memcpy(stagingBuffer.mappedData(), vertices.data(), (size_t)bufferSize);
 
         m_vertexBuffer.createBuffer(vulkanDevice,
                                     bufferSize,
                                     vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
-                                    vk::MemoryPropertyFlagBits::eDeviceLocal);
+                                    vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                    MemoryCategory::MESHES);
 
         m_vertexBuffer.copyBufferFrom(stagingBuffer.buffer(), bufferSize, vulkanDevice, vulkanCommandBuffer);
 
-        vulkanDevice.logicalDevice().destroyBuffer(stagingBuffer.buffer());
-        vulkanDevice.logicalDevice().freeMemory(stagingBuffer.memory());
+        stagingBuffer.destroy(vulkanDevice);
 
         GN_CORE_INFO("Vulkan vertex buffer created.");
     }
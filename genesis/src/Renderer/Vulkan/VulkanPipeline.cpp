@@ -1,5 +1,7 @@
 #include "VulkanPipeline.h"
 
+#include <chrono>
+
 #include "Core/Logger.h"
 #include "VulkanMesh.h"
 #include "VulkanShader.h"
@@ -11,9 +13,22 @@ namespace Genesis {
     VulkanPipeline::~VulkanPipeline() {
     }
 
-    void VulkanPipeline::createGraphicsPipeline(VulkanDevice& vulkanDevice, VulkanSwapchain& vulkanSwapchain) {
-        VulkanShader vertShader(vulkanDevice, "assets/shaders/shader.vert.spv");
-        VulkanShader fragShader(vulkanDevice, "assets/shaders/shader.frag.spv");
+    void VulkanPipeline::createGraphicsPipeline(VulkanDevice& vulkanDevice,
+                                                VulkanSwapchain& vulkanSwapchain,
+                                                vk::DescriptorSetLayout materialLayout,
+                                                vk::DescriptorSetLayout virtualTextureLayout,
+                                                bool bindless,
+                                                bool culled,
+                                                bool feedback,
+                                                ThreadPool& threadPool) {
+        auto pipelineStart = std::chrono::steady_clock::now();
+        // the culled variant is the same source compiled with CULLING defined, it reads instances through the
+        // visible instance indices
+        VulkanShader vertShader(vulkanDevice, culled ? "assets/shaders/shader.culled.vert.spv" : "assets/shaders/shader.vert.spv");
+        // the bindless variant is the same source compiled with BINDLESS defined, the variants without NO_FEEDBACK
+        // store virtual texture requests from the fragment shader and need fragmentStoresAndAtomics
+        std::string fragShaderPath = bindless ? "assets/shaders/shader.bindless" : "assets/shaders/shader";
+        VulkanShader fragShader(vulkanDevice, fragShaderPath + (feedback ? ".frag.spv" : ".nofeedback.frag.spv"));
 
         vk::PipelineShaderStageCreateInfo vertShaderStageInfo = {};
         vertShaderStageInfo.flags = vk::PipelineShaderStageCreateFlags();
@@ -43,25 +58,13 @@ namespace Genesis {
         inputAssembly.topology = vk::PrimitiveTopology::eTriangleList;
         inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-        vk::Viewport viewport = {};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = (float)vulkanSwapchain.extent().width;
-        viewport.height = (float)vulkanSwapchain.extent().height;
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-
-        vk::Rect2D scissor = {};
-        scissor.offset.x = 0;
-        scissor.offset.y = 0;
-        scissor.extent = vulkanSwapchain.extent();
-
+        // the viewport and scissor themselves are set while recording, see dynamicStates below
         vk::PipelineViewportStateCreateInfo viewportState = {};
         viewportState.flags = vk::PipelineViewportStateCreateFlags();
         viewportState.viewportCount = 1;
-        viewportState.pViewports = &viewport;
+        viewportState.pViewports = nullptr;
         viewportState.scissorCount = 1;
-        viewportState.pScissors = &scissor;
+        viewportState.pScissors = nullptr;
 
         vk::PipelineRasterizationStateCreateInfo rasterizer = {};
         rasterizer.flags = vk::PipelineRasterizationStateCreateFlags();
@@ -115,20 +118,27 @@ namespace Genesis {
         colorBlending.blendConstants[2] = 0.0f;  // Optional
         colorBlending.blendConstants[3] = 0.0f;  // Optional
 
-        // std::vector<vk::DynamicState> dynamicStates = {
-        //     vk::DynamicState::eViewport,
-        //     vk::DynamicState::eScissor};
-        // vk::PipelineDynamicStateCreateInfo dynamicState = {};
-        // dynamicState.flags = vk::PipelineDynamicStateCreateFlags();
-        // dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-        // dynamicState.pDynamicStates = dynamicStates.data();
+        std::vector<vk::DynamicState> dynamicStates = {
+            vk::DynamicState::eViewport,
+            vk::DynamicState::eScissor};
+        vk::PipelineDynamicStateCreateInfo dynamicState = {};
+        dynamicState.flags = vk::PipelineDynamicStateCreateFlags();
+        dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+        dynamicState.pDynamicStates = dynamicStates.data();
+
+        std::vector<vk::DescriptorSetLayout> descriptorSetLayouts = {vulkanSwapchain.frameDescriptorSetLayout(), materialLayout, virtualTextureLayout};
+
+        vk::PushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eFragment;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(VirtualTextureParams);
 
-        std::vector<vk::DescriptorSetLayout> descriptorSetLayouts = {vulkanSwapchain.frameDescriptorSetLayout(), vulkanSwapchain.meshDescriptorSetLayout()};
         vk::PipelineLayoutCreateInfo pipelineLayoutInfo = {};
         pipelineLayoutInfo.flags = vk::PipelineLayoutCreateFlags();
         pipelineLayoutInfo.setLayoutCount = descriptorSetLayouts.size();
         pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-        pipelineLayoutInfo.pushConstantRangeCount = 0;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
         try {
             m_vkPipelineLayout = vulkanDevice.logicalDevice().createPipelineLayout(pipelineLayoutInfo);
@@ -149,25 +159,158 @@ namespace Genesis {
         pipelineInfo.pMultisampleState = &multisampling;
         pipelineInfo.pDepthStencilState = &depthStencil;
         pipelineInfo.pColorBlendState = &colorBlending;
-        // pipelineInfo.pDynamicState = &dynamicState;
+        pipelineInfo.pDynamicState = &dynamicState;
         pipelineInfo.layout = m_vkPipelineLayout;
         pipelineInfo.renderPass = m_vkRenderPass;
         pipelineInfo.subpass = 0;
         pipelineInfo.basePipelineHandle = nullptr;  // Optional
         pipelineInfo.basePipelineIndex = -1;        // Optional
 
+        if (vulkanDevice.graphicsPipelineLibraryEnabled()) {
+            m_threadPool = &threadPool;
+            m_libraries.push_back(createLibrary(vulkanDevice, vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface, pipelineInfo));
+            m_libraries.push_back(createLibrary(vulkanDevice, vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders, pipelineInfo));
+            m_libraries.push_back(createLibrary(vulkanDevice, vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader, pipelineInfo));
+            m_libraries.push_back(createLibrary(vulkanDevice, vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface, pipelineInfo));
+
+            auto linkStart = std::chrono::steady_clock::now();
+            m_vkGraphicsPipeline = linkLibraries(vulkanDevice, vk::PipelineCreateFlags());
+            GN_CORE_TRACE("Vulkan pipeline libraries linked in {:.0f} us, optimizing in the background.",
+                          std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - linkStart).count());
+
+            m_threadPool->submit([this, &vulkanDevice] { compileOptimized(vulkanDevice); });
+        } else {
+            try {
+                m_vkGraphicsPipeline = vulkanDevice.logicalDevice().createGraphicsPipeline(vulkanDevice.pipelineCache().pipelineCache(), pipelineInfo).value;
+            } catch (vk::SystemError err) {
+                std::string errMsg = "Failed to create graphics pipeline: ";
+                GN_CORE_ERROR("{}{}", errMsg, err.what());
+                throw std::runtime_error(errMsg + err.what());
+            }
+        }
+
+        vulkanDevice.logicalDevice().destroyShaderModule(vertShader.shaderModule());
+        vulkanDevice.logicalDevice().destroyShaderModule(fragShader.shaderModule());
+
+        // compare against a launch without pipeline_cache.bin to see what the cache saves
+        GN_CORE_INFO("Vulkan pipeline created successfully in {:.2f} ms ({} pipeline cache).",
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pipelineStart).count(),
+                     vulkanDevice.pipelineCache().warm() ? "warm" : "cold");
+    }
+
+    void VulkanPipeline::update(VulkanDevice& vulkanDevice) {
+        if (m_optimizedSwapped || !m_optimizedReady.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        // earlier frames may still be drawing with the quick link
+        vulkanDevice.deletionQueue().destroyPipeline(m_vkGraphicsPipeline);
+        m_vkGraphicsPipeline = m_vkOptimizedPipeline;
+        m_optimizedSwapped = true;
+        GN_CORE_TRACE("Optimized Vulkan pipeline swapped in.");
+    }
+
+    void VulkanPipeline::destroy(VulkanDevice& vulkanDevice) {
+        // the optimized link may still be running on a worker
+        if (m_threadPool) {
+            m_threadPool->waitIdle();
+        }
+        if (m_optimizedReady && !m_optimizedSwapped) {
+            vulkanDevice.logicalDevice().destroyPipeline(m_vkOptimizedPipeline);
+        }
+
+        vulkanDevice.logicalDevice().destroyPipeline(m_vkGraphicsPipeline);
+        for (vk::Pipeline library : m_libraries) {
+            vulkanDevice.logicalDevice().destroyPipeline(library);
+        }
+        m_libraries.clear();
+        vulkanDevice.logicalDevice().destroyPipelineLayout(m_vkPipelineLayout);
+        vulkanDevice.logicalDevice().destroyRenderPass(m_vkRenderPass);
+    }
+
+    vk::Pipeline VulkanPipeline::createLibrary(VulkanDevice& vulkanDevice,
+                                               vk::GraphicsPipelineLibraryFlagsEXT stages,
+                                               vk::GraphicsPipelineCreateInfo pipelineInfo) {
+        // a library only takes the state of its own part of the pipeline, everything else is cleared
+        std::vector<vk::PipelineShaderStageCreateInfo> shaderStages;
+        for (uint32_t i = 0; i < pipelineInfo.stageCount; i++) {
+            bool vertexStage = pipelineInfo.pStages[i].stage == vk::ShaderStageFlagBits::eVertex;
+            if ((vertexStage && (stages & vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders)) ||
+                (!vertexStage && (stages & vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader))) {
+                shaderStages.push_back(pipelineInfo.pStages[i]);
+            }
+        }
+
+        bool vertexInput = static_cast<bool>(stages & vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface);
+        bool preRasterization = static_cast<bool>(stages & vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders);
+        bool fragmentShader = static_cast<bool>(stages & vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader);
+        bool fragmentOutput = static_cast<bool>(stages & vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface);
+
+        vk::GraphicsPipelineLibraryCreateInfoEXT libraryInfo = {};
+        libraryInfo.flags = stages;
+
+        pipelineInfo.pNext = &libraryInfo;
+        // keep what link-time optimization needs so the background link can use it
+        pipelineInfo.flags = vk::PipelineCreateFlagBits::eLibraryKHR | vk::PipelineCreateFlagBits::eRetainLinkTimeOptimizationInfoEXT;
+        pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+        pipelineInfo.pStages = shaderStages.empty() ? nullptr : shaderStages.data();
+        pipelineInfo.pVertexInputState = vertexInput ? pipelineInfo.pVertexInputState : nullptr;
+        pipelineInfo.pInputAssemblyState = vertexInput ? pipelineInfo.pInputAssemblyState : nullptr;
+        pipelineInfo.pViewportState = preRasterization ? pipelineInfo.pViewportState : nullptr;
+        pipelineInfo.pRasterizationState = preRasterization ? pipelineInfo.pRasterizationState : nullptr;
+        // viewport and scissor belong to pre-rasterization, the only dynamic state there is
+        pipelineInfo.pDynamicState = preRasterization ? pipelineInfo.pDynamicState : nullptr;
+        pipelineInfo.pDepthStencilState = fragmentShader ? pipelineInfo.pDepthStencilState : nullptr;
+        pipelineInfo.pMultisampleState = fragmentShader || fragmentOutput ? pipelineInfo.pMultisampleState : nullptr;
+        pipelineInfo.pColorBlendState = fragmentOutput ? pipelineInfo.pColorBlendState : nullptr;
+        pipelineInfo.layout = preRasterization || fragmentShader ? pipelineInfo.layout : nullptr;
+        pipelineInfo.renderPass = vertexInput ? nullptr : pipelineInfo.renderPass;
+
+        vk::Pipeline library;
         try {
-            m_vkGraphicsPipeline = vulkanDevice.logicalDevice().createGraphicsPipeline(nullptr, pipelineInfo).value;
+            library = vulkanDevice.logicalDevice().createGraphicsPipeline(vulkanDevice.pipelineCache().pipelineCache(), pipelineInfo).value;
         } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to create graphics pipeline: ";
+            std::string errMsg = "Failed to create graphics pipeline library: ";
             GN_CORE_ERROR("{}{}", errMsg, err.what());
             throw std::runtime_error(errMsg + err.what());
         }
 
-        vulkanDevice.logicalDevice().destroyShaderModule(vertShader.shaderModule());
-        vulkanDevice.logicalDevice().destroyShaderModule(fragShader.shaderModule());
+        return library;
+    }
+
+    vk::Pipeline VulkanPipeline::linkLibraries(VulkanDevice& vulkanDevice, vk::PipelineCreateFlags flags) {
+        vk::PipelineLibraryCreateInfoKHR libraryInfo = {};
+        libraryInfo.libraryCount = static_cast<uint32_t>(m_libraries.size());
+        libraryInfo.pLibraries = m_libraries.data();
+
+        vk::GraphicsPipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.pNext = &libraryInfo;
+        pipelineInfo.flags = flags;
+        pipelineInfo.layout = m_vkPipelineLayout;
 
-        GN_CORE_INFO("Vulkan pipeline created successfully.");
+        vk::Pipeline pipeline;
+        try {
+            pipeline = vulkanDevice.logicalDevice().createGraphicsPipeline(vulkanDevice.pipelineCache().pipelineCache(), pipelineInfo).value;
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to link graphics pipeline libraries: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        return pipeline;
+    }
+
+    void VulkanPipeline::compileOptimized(VulkanDevice& vulkanDevice) {
+        auto compileStart = std::chrono::steady_clock::now();
+        try {
+            m_vkOptimizedPipeline = linkLibraries(vulkanDevice, vk::PipelineCreateFlagBits::eLinkTimeOptimizationEXT);
+        } catch (std::runtime_error err) {
+            // already logged, draws simply keep the quick link
+            return;
+        }
+        GN_CORE_TRACE("Optimized Vulkan pipeline compiled in {:.2f} ms.",
+                      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count());
+        m_optimizedReady.store(true, std::memory_order_release);
     }
 
     void VulkanPipeline::createRenderPass(VulkanDevice& vulkanDevice, VulkanSwapchain& vulkanSwapchain) {
@@ -225,8 +368,10 @@ namespace Genesis {
         vk::SubpassDependency dependency = {};
         dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
         dependency.dstSubpass = 0;
-        dependency.srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests;
-        dependency.srcAccessMask = vk::AccessFlagBits::eNone;
+        // the color and depth attachments are shared by every frame in flight, the previous frame's writes must be
+        // done before this one clears them
+        dependency.srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests;
+        dependency.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
         dependency.dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests;
         dependency.dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
 
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <atomic>
+
+#include "Core/ThreadPool.h"
 #include "VulkanDevice.h"
 #include "VulkanSwapchain.h"
 #include "VulkanTypes.h"
 
 namespace Genesis {
+    // The graphics pipeline and its render pass. Where VK_EXT_graphics_pipeline_library is enabled the pipeline is
+    // built as four libraries (vertex input, pre-rasterization, fragment shader, fragment output) that are linked
+    // without optimization in well under a millisecond, so the first frame never waits on a full compile. A link
+    // with link-time optimization then runs on a worker thread and update() swaps it in once it is done. Without the
+    // extension the pipeline is built whole, up front, as before.
     class VulkanPipeline {
         public:
             VulkanPipeline();
@@ -16,13 +24,39 @@ namespace Genesis {
             vk::Pipeline const& pipeline() const { return m_vkGraphicsPipeline; }
             vk::PipelineLayout const& layout() const { return m_vkPipelineLayout; }
             vk::RenderPass const& renderPass() const { return m_vkRenderPass; }
+            // false while draws still use the unoptimized link
+            bool optimized() const { return m_libraries.empty() || m_optimizedSwapped; }
 
-            void createGraphicsPipeline(VulkanDevice& vulkanDevice, VulkanSwapchain& vulkanSwapchain);
+            void createGraphicsPipeline(VulkanDevice& vulkanDevice,
+                                        VulkanSwapchain& vulkanSwapchain,
+                                        vk::DescriptorSetLayout materialLayout,
+                                        vk::DescriptorSetLayout virtualTextureLayout,
+                                        bool bindless,
+                                        bool culled,
+                                        bool feedback,
+                                        ThreadPool& threadPool);
             void createRenderPass(VulkanDevice& vulkanDevice, VulkanSwapchain& vulkanSwapchain);
+            // call once per frame before recording, swaps in the optimized pipeline when its compile has finished
+            void update(VulkanDevice& vulkanDevice);
+            void destroy(VulkanDevice& vulkanDevice);
 
         private:
+            vk::Pipeline createLibrary(VulkanDevice& vulkanDevice,
+                                       vk::GraphicsPipelineLibraryFlagsEXT stages,
+                                       vk::GraphicsPipelineCreateInfo pipelineInfo);
+            vk::Pipeline linkLibraries(VulkanDevice& vulkanDevice, vk::PipelineCreateFlags flags);
+            void compileOptimized(VulkanDevice& vulkanDevice);
+
             vk::PipelineLayout m_vkPipelineLayout;
             vk::Pipeline m_vkGraphicsPipeline;
             vk::RenderPass m_vkRenderPass;
+
+            ThreadPool* m_threadPool = nullptr;
+            // empty when graphics pipeline libraries are unavailable
+            std::vector<vk::Pipeline> m_libraries;
+            // written by the worker, only read once m_optimizedReady is set
+            vk::Pipeline m_vkOptimizedPipeline;
+            std::atomic<bool> m_optimizedReady = false;
+            bool m_optimizedSwapped = false;
     };
 }  // namespace Genesis
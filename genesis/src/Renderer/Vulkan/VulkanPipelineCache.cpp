@@ -0,0 +1,140 @@
+#include "VulkanPipelineCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    VulkanPipelineCache::VulkanPipelineCache() {
+    }
+
+    VulkanPipelineCache::~VulkanPipelineCache() {
+    }
+
+    void VulkanPipelineCache::init(vk::Device device, const vk::PhysicalDeviceProperties& properties, const std::string& path) {
+        m_vkDevice = device;
+        m_path = path;
+
+        std::vector<char> data = loadFile();
+        if (!data.empty() && !isCompatible(data, properties)) {
+            data.clear();
+        }
+
+        vk::PipelineCacheCreateInfo createInfo = {};
+        createInfo.flags = vk::PipelineCacheCreateFlags();
+        createInfo.initialDataSize = data.size();
+        createInfo.pInitialData = data.data();
+
+        try {
+            m_vkPipelineCache = m_vkDevice.createPipelineCache(createInfo);
+            m_loadedSize = data.size();
+        } catch (vk::SystemError err) {
+            // the header matched but the driver still refused the contents, start over with an empty cache
+            GN_CORE_WARNING("Pipeline cache {} rejected by the driver: {}", m_path, err.what());
+            createInfo.initialDataSize = 0;
+            createInfo.pInitialData = nullptr;
+            try {
+                m_vkPipelineCache = m_vkDevice.createPipelineCache(createInfo);
+                m_loadedSize = 0;
+            } catch (vk::SystemError err) {
+                std::string errMsg = "Failed to create pipeline cache: ";
+                GN_CORE_ERROR("{}{}", errMsg, err.what());
+                throw std::runtime_error(errMsg + err.what());
+            }
+        }
+
+        GN_CORE_TRACE("Pipeline cache created, {} bytes loaded from {}.", m_loadedSize, m_path);
+    }
+
+    void VulkanPipelineCache::save() {
+        if (!m_vkPipelineCache) {
+            return;
+        }
+
+        std::vector<uint8_t> data;
+        try {
+            data = m_vkDevice.getPipelineCacheData(m_vkPipelineCache);
+        } catch (vk::SystemError err) {
+            GN_CORE_WARNING("Failed to read pipeline cache data: {}", err.what());
+            return;
+        }
+
+        // write next to the old file and swap it in, a crash mid-write leaves the previous cache intact
+        std::string tempPath = m_path + ".tmp";
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            GN_CORE_WARNING("Failed to open {} to save the pipeline cache.", tempPath);
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        file.close();
+        if (file.fail()) {
+            GN_CORE_WARNING("Failed to write the pipeline cache to {}.", tempPath);
+            std::filesystem::remove(tempPath);
+            return;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, m_path, error);
+        if (error) {
+            GN_CORE_WARNING("Failed to replace {} with the new pipeline cache: {}", m_path, error.message());
+            std::filesystem::remove(tempPath, error);
+            return;
+        }
+
+        GN_CORE_TRACE("Pipeline cache saved, {} bytes written to {}.", data.size(), m_path);
+    }
+
+    void VulkanPipelineCache::destroy() {
+        m_vkDevice.destroyPipelineCache(m_vkPipelineCache);
+        m_vkPipelineCache = nullptr;
+    }
+
+    std::vector<char> VulkanPipelineCache::loadFile() {
+        std::ifstream file(m_path, std::ios::ate | std::ios::binary);
+
+        // no file is the normal first launch, not an error
+        if (!file.is_open()) {
+            return std::vector<char>();
+        }
+
+        size_t fileSize(static_cast<size_t>(file.tellg()));
+        std::vector<char> buffer(fileSize);
+
+        file.seekg(0);
+        file.read(buffer.data(), fileSize);
+
+        if (!file) {
+            GN_CORE_WARNING("Failed to read pipeline cache {}.", m_path);
+            return std::vector<char>();
+        }
+
+        return buffer;
+    }
+
+    bool VulkanPipelineCache::isCompatible(const std::vector<char>& data, const vk::PhysicalDeviceProperties& properties) {
+        VkPipelineCacheHeaderVersionOne header = {};
+        if (data.size() < sizeof(header)) {
+            GN_CORE_WARNING("Pipeline cache {} is truncated, ignoring it.", m_path);
+            return false;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        if (header.headerSize < sizeof(header) || header.headerSize > data.size() ||
+            header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+            GN_CORE_WARNING("Pipeline cache {} has an unknown header, ignoring it.", m_path);
+            return false;
+        }
+
+        // a different GPU or driver build cannot use the blobs, the UUID changes with every driver update
+        if (header.vendorID != properties.vendorID || header.deviceID != properties.deviceID ||
+            std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE) != 0) {
+            GN_CORE_INFO("Pipeline cache {} was written by another device or driver, rebuilding it.", m_path);
+            return false;
+        }
+
+        return true;
+    }
+}  // namespace Genesis
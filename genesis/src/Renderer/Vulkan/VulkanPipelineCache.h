@@ -0,0 +1,34 @@
+#pragma once
+
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    // One vk::PipelineCache shared by every pipeline the device builds. It is seeded from a file at startup so the
+    // driver can skip compiling pipelines it has seen before, and written back on shutdown. A file written by another
+    // GPU or driver version fails the header check and is ignored, the cache then starts empty. Owned by the device.
+    class VulkanPipelineCache {
+        public:
+            VulkanPipelineCache();
+            ~VulkanPipelineCache();
+
+            VulkanPipelineCache(const VulkanPipelineCache&) = delete;
+            VulkanPipelineCache& operator=(const VulkanPipelineCache&) = delete;
+
+            vk::PipelineCache const& pipelineCache() const { return m_vkPipelineCache; }
+            // true when the cache was seeded from disk, pipeline creation should then mostly hit
+            bool warm() const { return m_loadedSize > 0; }
+
+            void init(vk::Device device, const vk::PhysicalDeviceProperties& properties, const std::string& path);
+            void save();
+            void destroy();
+
+        private:
+            std::vector<char> loadFile();
+            bool isCompatible(const std::vector<char>& data, const vk::PhysicalDeviceProperties& properties);
+
+            vk::Device m_vkDevice;
+            vk::PipelineCache m_vkPipelineCache;
+            std::string m_path;
+            size_t m_loadedSize = 0;
+    };
+}  // namespace Genesis
@@ -3,11 +3,13 @@
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
 
+#include <algorithm>
 #include <chrono>
 
 #include "Core/Logger.h"
 #include "Platform/GLFWWindow.h"
 #include "Resources/ObjMesh.h"
+#include "Resources/TextureDecoder.h"
 #include "VulkanShader.h"
 
 namespace Genesis {
@@ -33,16 +35,52 @@ namespace Genesis {
         m_vulkanSwapchain.createSwapChain(m_vulkanDevice, m_vkSurface, m_window);
         m_vulkanPipeline.createRenderPass(m_vulkanDevice, m_vulkanSwapchain);
         m_vulkanSwapchain.createDescriptorSetLayouts(m_vulkanDevice);
-        m_vulkanPipeline.createGraphicsPipeline(m_vulkanDevice, m_vulkanSwapchain);
+        m_bindlessTextures.init(m_vulkanDevice);
+        m_virtualTexture.createDescriptorSetLayout(m_vulkanDevice);
+        // draws in one indirect buffer cannot switch materials and each starts at its own instance
+        m_gpuDriven = m_bindlessTextures.isEnabled() && m_vulkanDevice.enabledFeatures().drawIndirectFirstInstance;
+        m_gpuCulling = m_gpuDriven && m_vulkanDevice.subgroupBallotSupported();
+        m_vulkanPipeline.createGraphicsPipeline(m_vulkanDevice,
+                                                m_vulkanSwapchain,
+                                                m_bindlessTextures.isEnabled() ? m_bindlessTextures.descriptorSetLayout() : m_vulkanSwapchain.meshDescriptorSetLayout(),
+                                                m_virtualTexture.descriptorSetLayout(),
+                                                m_bindlessTextures.isEnabled(),
+                                                m_gpuCulling,
+                                                m_vulkanDevice.enabledFeatures().fragmentStoresAndAtomics,
+                                                m_threadPool);
         createCommandPool();
         createCommandBuffers();
-        m_vulkanSwapchain.createFrameResources(m_vulkanDevice, m_vulkanPipeline.renderPass(), m_vkCommandPool, m_vulkanMainCommandBuffer);
+        m_commandRecorder.init(m_vulkanDevice, m_threadPool, m_vulkanSwapchain.framesInFlight());
+        if (m_gpuDriven) {
+            m_indirectDraws.init(m_vulkanDevice, m_vulkanSwapchain.framesInFlight());
+        }
+        if (m_gpuCulling) {
+            m_cullPass.init(m_vulkanDevice, m_vulkanSwapchain.framesInFlight());
+        }
+        m_frustumCuller.init(m_threadPool);
+        GN_CORE_INFO("Scene drawn with {}.", m_gpuCulling ? "GPU culled indirect draws" : m_gpuDriven ? "CPU culled indirect draws" : "CPU culled draw calls per mesh type");
+        // every startup copy and layout transition goes to the GPU in one submit, waited on once before the first frame
+        auto uploadStart = std::chrono::steady_clock::now();
+        VulkanUploadBatch uploadBatch;
+        uploadBatch.begin(m_vulkanDevice, m_vkCommandPool);
+        m_vulkanSwapchain.createFrameResources(m_vulkanDevice, m_vulkanPipeline.renderPass(), m_vkCommandPool);
         // loadModel();
-        createAssets();
+        m_uploader.init(m_vulkanDevice);
+        m_textureStreamer.init(m_uploader, m_threadPool);
+        createAssets(uploadBatch);
+        uploadBatch.submit(m_vulkanDevice);
+        uploadBatch.wait(m_vulkanDevice);
+        GN_CORE_INFO("Startup resources uploaded in {:.1f} ms.",
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count());
+        m_virtualTexture.init(m_vulkanDevice,
+                              m_vkCommandPool,
+                              m_threadPool,
+                              "assets/textures/ground.jpg",
+                              m_vulkanSwapchain.framesInFlight());
         EventSystem::registerEvent(EventType::WindowResize, this, GN_BIND_EVENT_FN(VulkanRenderer::onResizeEvent));
     }
 
-    bool VulkanRenderer::drawFrame(std::shared_ptr<Scene> scene) {
+    bool VulkanRenderer::drawFrame(const Scene& scene) {
         renderFrame(scene);
         return true;
     }
@@ -50,29 +88,36 @@ namespace Genesis {
     void VulkanRenderer::shutdown() {
         EventSystem::unregisterEvent(EventType::WindowResize, this, GN_BIND_EVENT_FN(VulkanRenderer::onResizeEvent));
 
-        m_vulkanDevice.logicalDevice().destroyDescriptorPool(m_vulkanSwapchain.meshDescriptorPool());
-        m_vulkanSwapchain.cleanupSwapChain(m_vulkanDevice, m_vkCommandPool);
+        // some of what is queued still points into the pools destroyed below
+        m_vulkanDevice.deletionQueue().flush();
+
+        m_vulkanSwapchain.cleanupSwapChain(m_vulkanDevice);
+        m_vulkanSwapchain.destroyFrames(m_vulkanDevice, m_vkCommandPool);
 
         m_vulkanDevice.logicalDevice().destroyDescriptorSetLayout(m_vulkanSwapchain.frameDescriptorSetLayout());
 
-        m_vulkanDevice.logicalDevice().destroyBuffer(m_vulkanMeshes.vertexBuffer().buffer());
-        m_vulkanDevice.logicalDevice().freeMemory(m_vulkanMeshes.vertexBuffer().memory());
-        m_vulkanDevice.logicalDevice().destroyBuffer(m_vulkanMeshes.indexBuffer().buffer());
-        m_vulkanDevice.logicalDevice().freeMemory(m_vulkanMeshes.indexBuffer().memory());
+        m_vulkanMeshes.destroy(m_vulkanDevice);
 
+        m_textureStreamer.shutdown(m_vulkanDevice);
+        m_uploader.shutdown(m_vulkanDevice);
+        m_virtualTexture.shutdown(m_vulkanDevice);
         for (const auto& [key, texture] : m_materials) {
             delete texture;
         }
+        m_bindlessTextures.shutdown(m_vulkanDevice);
 
         m_vulkanDevice.logicalDevice().destroyDescriptorSetLayout(m_vulkanSwapchain.meshDescriptorSetLayout());
 
+        if (m_gpuCulling) {
+            m_cullPass.destroy(m_vulkanDevice);
+        }
+        m_indirectDraws.destroy(m_vulkanDevice);
+        m_commandRecorder.shutdown(m_vulkanDevice);
         m_vulkanDevice.logicalDevice().destroyCommandPool(m_vkCommandPool);
 
-        m_vulkanDevice.logicalDevice().destroyPipeline(m_vulkanPipeline.pipeline());
-        m_vulkanDevice.logicalDevice().destroyPipelineLayout(m_vulkanPipeline.layout());
-        m_vulkanDevice.logicalDevice().destroyRenderPass(m_vulkanPipeline.renderPass());
+        m_vulkanPipeline.destroy(m_vulkanDevice);
 
-        m_vulkanDevice.logicalDevice().destroy();
+        m_vulkanDevice.shutdown();
 
         if (m_enableValidationLayers) {
             m_vkInstance.destroyDebugUtilsMessengerEXT(m_vkDebugMessenger, nullptr, m_vkDldi);
@@ -91,7 +136,7 @@ namespace Genesis {
                                     VK_MAKE_VERSION(1, 0, 0),
                                     "Genesis",
                                     VK_MAKE_VERSION(1, 0, 0),
-                                    VK_API_VERSION_1_1);
+                                    VK_API_VERSION_1_2);
 
         // confirm required extension support
         std::vector<const char*> extensions = getRequiredExtensions();
@@ -220,8 +265,8 @@ namespace Genesis {
         m_vulkanMainCommandBuffer.create(m_vulkanDevice, m_vkCommandPool);
     }
 
-    void VulkanRenderer::renderFrame(std::shared_ptr<Scene> scene) {
-        auto currentFrame = m_vulkanSwapchain.swapchainFrames()[m_currentFrame];
+    void VulkanRenderer::renderFrame(const Scene& scene) {
+        SwapChainFrame& currentFrame = m_vulkanSwapchain.swapchainFrame(m_currentFrame);
         vk::Result result;
         try {
             result = m_vulkanDevice.logicalDevice().waitForFences(1, &currentFrame.inFlightFence, VK_TRUE, UINT64_MAX);
@@ -231,12 +276,26 @@ namespace Genesis {
             throw std::runtime_error(errMsg + err.what());
         }
 
+        m_vulkanDevice.allocator().updateBudget();
+        m_vulkanDevice.deletionQueue().beginFrame(m_currentFrame);
+        m_vulkanPipeline.update(m_vulkanDevice);
+        m_commandRecorder.beginFrame(m_vulkanDevice, m_currentFrame);
+
+        m_textureStreamer.update(m_vulkanDevice, scene, static_cast<float>(m_vulkanSwapchain.extent().height));
+        m_virtualTexture.update(m_vulkanDevice, m_currentFrame);
+        // a committed residency change moves the texture to another bindless slot
+        if (m_bindlessTextures.isEnabled()) {
+            for (const auto& [object, texture] : m_materials) {
+                m_objectMaterials[object].textureIndex = texture->bindlessIndex();
+            }
+        }
+
         uint32_t imageIndex;
         try {
             auto result = m_vulkanDevice.logicalDevice().acquireNextImageKHR(m_vulkanSwapchain.swapchain(), UINT64_MAX, currentFrame.imageAvailableSemaphore, nullptr);
             imageIndex = result.value;
         } catch (vk::OutOfDateKHRError err) {
-            m_vulkanSwapchain.recreateSwapChain(m_vulkanDevice, m_vkSurface, m_window, m_vulkanPipeline.renderPass(), m_vkCommandPool, m_vulkanMainCommandBuffer);
+            m_vulkanSwapchain.recreateSwapChain(m_vulkanDevice, m_vkSurface, m_window, m_vulkanPipeline.renderPass());
             return;
         } catch (vk::SystemError err) {
             std::string errMsg = "Failed to aquire swap chain image: ";
@@ -253,10 +312,11 @@ namespace Genesis {
             throw std::runtime_error(errMsg + err.what());
         }
 
-        m_vulkanSwapchain.swapchainFrames()[m_currentFrame].vulkanCommandBuffer.commandBuffer().reset();
+        currentFrame.vulkanCommandBuffer.commandBuffer().reset();
 
+        buildDrawList(scene);
         try {
-            m_vulkanSwapchain.prepareFrame(m_vulkanDevice, m_currentFrame, scene);
+            m_vulkanSwapchain.prepareFrame(m_vulkanDevice, m_currentFrame, scene, m_objectMaterials, m_gpuCulling ? nullptr : &m_visibleInstances);
         } catch (std::exception err) {
             GN_CORE_ERROR("{}", err.what());
         }
@@ -265,16 +325,30 @@ namespace Genesis {
 
         vk::SubmitInfo submitInfo = {};
 
-        vk::Semaphore waitSemaphores[] = {currentFrame.imageAvailableSemaphore};
-        vk::PipelineStageFlags waitStages[] = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
+        vk::Semaphore waitSemaphores[] = {currentFrame.imageAvailableSemaphore, m_uploader.timelineSemaphore()};
+        vk::PipelineStageFlags waitStages[] = {vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eFragmentShader};
         submitInfo.waitSemaphoreCount = 1;
         submitInfo.pWaitSemaphores = waitSemaphores;
         submitInfo.pWaitDstStageMask = waitStages;
 
+        // textures acquired from the transfer queue this frame must not be sampled before their upload batch signalled,
+        // the values of binary semaphores are ignored
+        uint64_t waitValues[] = {0, m_uploader.acquireWaitValue()};
+        uint64_t signalValues[] = {0};
+        vk::TimelineSemaphoreSubmitInfo timelineInfo = {};
+        if (m_uploader.acquireWaitValue() > 0) {
+            submitInfo.waitSemaphoreCount = 2;
+            timelineInfo.waitSemaphoreValueCount = 2;
+            timelineInfo.pWaitSemaphoreValues = waitValues;
+            timelineInfo.signalSemaphoreValueCount = 1;
+            timelineInfo.pSignalSemaphoreValues = signalValues;
+            submitInfo.pNext = &timelineInfo;
+        }
+
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers = &currentFrame.vulkanCommandBuffer.commandBuffer();
 
-        vk::Semaphore signalSemaphores[] = {currentFrame.renderFinishedSemaphore};
+        vk::Semaphore signalSemaphores[] = {m_vulkanSwapchain.swapchainImages()[imageIndex].renderFinishedSemaphore};
         submitInfo.signalSemaphoreCount = 1;
         submitInfo.pSignalSemaphores = signalSemaphores;
 
@@ -285,6 +359,8 @@ namespace Genesis {
             GN_CORE_ERROR("{}{}", errMsg, err.what());
             throw std::runtime_error(errMsg + err.what());
         }
+        // only now does the slot's fence cover this frame, an early return above must not retire anything
+        m_vulkanDevice.deletionQueue().endFrame(m_currentFrame);
 
         vk::PresentInfoKHR presentInfo = {};
         presentInfo.waitSemaphoreCount = 1;
@@ -297,23 +373,23 @@ namespace Genesis {
 
         try {
             auto result = m_vulkanDevice.presentQueue().presentKHR(presentInfo);
-            if (result == vk::Result::eSuboptimalKHR || m_framebufferResized) {
-                m_framebufferResized = false;
-                m_vulkanSwapchain.recreateSwapChain(m_vulkanDevice, m_vkSurface, m_window, m_vulkanPipeline.renderPass(), m_vkCommandPool, m_vulkanMainCommandBuffer);
+            bool resized = m_framebufferResized.exchange(false);
+            if (result == vk::Result::eSuboptimalKHR || resized) {
+                m_vulkanSwapchain.recreateSwapChain(m_vulkanDevice, m_vkSurface, m_window, m_vulkanPipeline.renderPass());
             }
         } catch (vk::OutOfDateKHRError err) {
             m_framebufferResized = false;
-            m_vulkanSwapchain.recreateSwapChain(m_vulkanDevice, m_vkSurface, m_window, m_vulkanPipeline.renderPass(), m_vkCommandPool, m_vulkanMainCommandBuffer);
+            m_vulkanSwapchain.recreateSwapChain(m_vulkanDevice, m_vkSurface, m_window, m_vulkanPipeline.renderPass());
         } catch (vk::SystemError err) {
             std::string errMsg = "Failed to present swap chain image: ";
             GN_CORE_ERROR("{}{}", errMsg, err.what());
             throw std::runtime_error(errMsg + err.what());
         }
 
-        m_currentFrame = (m_currentFrame + 1) % m_vulkanSwapchain.swapchainFrames().size();
+        m_currentFrame = (m_currentFrame + 1) % m_vulkanSwapchain.framesInFlight();
     }
 
-    void VulkanRenderer::recordCommandBuffer(VulkanCommandBuffer& vulkanCommandBuffer, uint32_t imageIndex, std::shared_ptr<Scene> scene) {
+    void VulkanRenderer::recordCommandBuffer(VulkanCommandBuffer& vulkanCommandBuffer, uint32_t imageIndex, const Scene& scene) {
         vk::CommandBufferBeginInfo beginInfo = {};
         beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
 
@@ -325,9 +401,12 @@ namespace Genesis {
             throw std::runtime_error(errMsg + err.what());
         }
 
+        m_uploader.recordAcquireBarriers(vulkanCommandBuffer.commandBuffer());
+        m_vulkanMeshes.recordUpdates(m_vulkanDevice, vulkanCommandBuffer.commandBuffer());
+
         vk::RenderPassBeginInfo renderPassInfo = {};
         renderPassInfo.renderPass = m_vulkanPipeline.renderPass();
-        renderPassInfo.framebuffer = m_vulkanSwapchain.swapchainFrames()[imageIndex].framebuffer;
+        renderPassInfo.framebuffer = m_vulkanSwapchain.swapchainImages()[imageIndex].framebuffer;
         renderPassInfo.renderArea.offset.x = 0;
         renderPassInfo.renderArea.offset.y = 0;
         renderPassInfo.renderArea.extent = m_vulkanSwapchain.extent();
@@ -339,44 +418,45 @@ namespace Genesis {
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
         renderPassInfo.pClearValues = clearValues.data();
 
-        vulkanCommandBuffer.commandBuffer().beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
-
-        vulkanCommandBuffer.commandBuffer().bindPipeline(vk::PipelineBindPoint::eGraphics, m_vulkanPipeline.pipeline());
-
-        // vk::Viewport viewport = {};
-        // viewport.x = 0.0f;
-        // viewport.y = 0.0f;
-        // viewport.width = static_cast<float>(m_vulkanSwapchain.extent().width);
-        // viewport.height = static_cast<float>(m_vulkanSwapchain.extent().height);
-        // viewport.minDepth = 0.0f;
-        // viewport.maxDepth = 1.0f;
-        // commandBuffer.setViewport(0, 1, &viewport);
-
-        // vk::Rect2D scissor = {};
-        // scissor.offset.x = 0;
-        // scissor.offset.y = 0;
-        // scissor.extent = m_vulkanSwapchain.extent();
-        // commandBuffer.setScissor(0, 1, &scissor);
-
-        vk::Buffer vertexBuffers[] = {m_vulkanMeshes.vertexBuffer().buffer()};
-        vk::DeviceSize offsets[] = {0};
-        vulkanCommandBuffer.commandBuffer().bindVertexBuffers(0, 1, vertexBuffers, offsets);
-        vulkanCommandBuffer.commandBuffer().bindIndexBuffer(m_vulkanMeshes.indexBuffer().buffer(), 0, vk::IndexType::eUint32);
-
-        vulkanCommandBuffer.commandBuffer().bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
-                                                               m_vulkanPipeline.layout(),
-                                                               0,
-                                                               1,
-                                                               &m_vulkanSwapchain.swapchainFrames()[m_currentFrame].descriptorSet,
-                                                               0,
-                                                               nullptr);
+        uint32_t chunkCount = m_commandRecorder.chunkCount(m_drawList.size());
+        if (m_gpuDriven) {
+            updateIndirectDraws();
+
+            vk::Buffer drawBuffer = m_indirectDraws.buffer(m_currentFrame);
+            if (m_gpuCulling) {
+                // the dispatch has to be outside the render pass, the draws below read what it wrote
+                const SwapChainFrame& frame = m_vulkanSwapchain.swapchainFrames()[m_currentFrame];
+                m_cullPass.prepareFrame(m_vulkanDevice, m_currentFrame, m_indirectCommands, drawBuffer, frame.modelBufferDescriptor.buffer);
+                m_vulkanSwapchain.setVisibleInstanceBuffer(m_vulkanDevice, m_currentFrame, m_cullPass.visibleInstanceBuffer(m_currentFrame));
+                m_cullPass.record(vulkanCommandBuffer.commandBuffer(), m_currentFrame, frame.modelBufferOffset, frame.viewProjection);
+                drawBuffer = m_cullPass.drawBuffer(m_currentFrame);
+            }
 
-        uint32_t startInstance = 0;
-        for (auto pair : scene->positions) {
-            renderObjects(vulkanCommandBuffer, pair.first, startInstance, static_cast<uint32_t>(pair.second.size()));
+            // one draw call for the scene, recording it is not worth spreading over workers
+            vulkanCommandBuffer.commandBuffer().beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+            bindDrawState(vulkanCommandBuffer.commandBuffer());
+            m_indirectDraws.record(vulkanCommandBuffer.commandBuffer(), drawBuffer);
+        } else if (chunkCount > 1) {
+            vulkanCommandBuffer.commandBuffer().beginRenderPass(renderPassInfo, vk::SubpassContents::eSecondaryCommandBuffers);
+
+            vk::CommandBufferInheritanceInfo inheritanceInfo = {};
+            inheritanceInfo.renderPass = renderPassInfo.renderPass;
+            inheritanceInfo.subpass = 0;
+            inheritanceInfo.framebuffer = renderPassInfo.framebuffer;
+
+            size_t drawCount = m_drawList.size();
+            const std::vector<vk::CommandBuffer>& secondaries = m_commandRecorder.record(
+                m_vulkanDevice, chunkCount, inheritanceInfo, [this, drawCount, chunkCount](vk::CommandBuffer commandBuffer, uint32_t chunk) {
+                    recordDraws(commandBuffer, drawCount * chunk / chunkCount, drawCount * (chunk + 1) / chunkCount);
+                });
+            vulkanCommandBuffer.commandBuffer().executeCommands(secondaries);
+        } else {
+            vulkanCommandBuffer.commandBuffer().beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+            recordDraws(vulkanCommandBuffer.commandBuffer(), 0, m_drawList.size());
         }
 
         vulkanCommandBuffer.commandBuffer().endRenderPass();
+        m_virtualTexture.recordFeedbackBarrier(vulkanCommandBuffer.commandBuffer());
 
         try {
             vulkanCommandBuffer.commandBuffer().end();
@@ -387,12 +467,117 @@ namespace Genesis {
         }
     }
 
-    void VulkanRenderer::renderObjects(VulkanCommandBuffer& vulkanCommandBuffer, meshTypes objectType, uint32_t& startInstance, uint32_t instanceCount) {
-        int indexCount = m_vulkanMeshes.m_indexCounts.find(objectType)->second;
-        int firstIndex = m_vulkanMeshes.m_firstIndices.find(objectType)->second;
-        m_materials[objectType]->use(vulkanCommandBuffer, m_vulkanPipeline.layout());
-        vulkanCommandBuffer.commandBuffer().drawIndexed(indexCount, instanceCount, firstIndex, 0, startInstance);
-        startInstance += instanceCount;
+    void VulkanRenderer::buildDrawList(const Scene& scene) {
+        m_drawList.clear();
+        uint32_t startInstance = 0;
+        if (m_gpuCulling) {
+            // each type instanced over all its positions, the compute pass drops what is not visible
+            for (const auto& pair : scene.positions) {
+                uint32_t instanceCount = static_cast<uint32_t>(pair.second.size());
+                m_drawList.push_back({pair.first, startInstance, instanceCount});
+                startInstance += instanceCount;
+            }
+            return;
+        }
+
+        m_cullBounds.clear();
+        for (const auto& pair : scene.positions) {
+            auto material = m_objectMaterials.find(pair.first);
+            float radius = material != m_objectMaterials.end() ? material->second.boundingRadius : 0.0f;
+            for (const glm::vec3& position : pair.second) {
+                m_cullBounds.push_back(position, radius);
+            }
+        }
+        m_frustumCuller.cull(FrustumCuller::extractPlanes(m_vulkanSwapchain.viewProjection(scene.camera)), m_cullBounds, m_visibleInstances);
+
+        // instances are numbered type after type and the visible ones come back ascending, so each type's survivors
+        // are one run of the list and prepareFrame packs them in the same order
+        size_t typeEnd = 0;
+        auto visible = m_visibleInstances.begin();
+        for (const auto& pair : scene.positions) {
+            typeEnd += pair.second.size();
+            auto typeVisibleEnd = std::lower_bound(visible, m_visibleInstances.end(), static_cast<uint32_t>(typeEnd));
+            uint32_t instanceCount = static_cast<uint32_t>(typeVisibleEnd - visible);
+            m_drawList.push_back({pair.first, startInstance, instanceCount});
+            startInstance += instanceCount;
+            visible = typeVisibleEnd;
+        }
+    }
+
+    void VulkanRenderer::bindDrawState(vk::CommandBuffer commandBuffer) {
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_vulkanPipeline.pipeline());
+
+        // viewport and scissor are dynamic, so the pipeline survives a resize untouched
+        vk::Viewport viewport = {};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(m_vulkanSwapchain.extent().width);
+        viewport.height = static_cast<float>(m_vulkanSwapchain.extent().height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        commandBuffer.setViewport(0, 1, &viewport);
+
+        vk::Rect2D scissor = {};
+        scissor.offset.x = 0;
+        scissor.offset.y = 0;
+        scissor.extent = m_vulkanSwapchain.extent();
+        commandBuffer.setScissor(0, 1, &scissor);
+
+        vk::Buffer vertexBuffers[] = {m_vulkanMeshes.vertexBuffer().buffer()};
+        vk::DeviceSize offsets[] = {0};
+        commandBuffer.bindVertexBuffers(0, 1, vertexBuffers, offsets);
+        commandBuffer.bindIndexBuffer(m_vulkanMeshes.indexBuffer().buffer(), 0, vk::IndexType::eUint32);
+
+        const SwapChainFrame& frame = m_vulkanSwapchain.swapchainFrames()[m_currentFrame];
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                         m_vulkanPipeline.layout(),
+                                         0,
+                                         1,
+                                         &frame.descriptorSet,
+                                         1,
+                                         &frame.modelBufferOffset);
+        if (m_bindlessTextures.isEnabled()) {
+            // every material lives in the one bindless set, draws pick theirs through the object data
+            m_bindlessTextures.bind(commandBuffer, m_vulkanPipeline.layout(), 1);
+        }
+        m_virtualTexture.bind(commandBuffer, m_vulkanPipeline.layout(), m_currentFrame);
+        // which instances sample the virtual texture is in their object data, the parameters are the same for all
+        VirtualTextureParams virtualTextureParams = m_virtualTexture.params(true);
+        commandBuffer.pushConstants(m_vulkanPipeline.layout(), vk::ShaderStageFlagBits::eFragment, 0, sizeof(VirtualTextureParams), &virtualTextureParams);
+    }
+
+    void VulkanRenderer::recordDraws(vk::CommandBuffer commandBuffer, size_t firstDraw, size_t lastDraw) {
+        // secondary command buffers inherit no state, every chunk binds everything it draws with
+        bindDrawState(commandBuffer);
+
+        for (size_t i = firstDraw; i < lastDraw; i++) {
+            renderObjects(commandBuffer, m_drawList[i]);
+        }
+    }
+
+    void VulkanRenderer::updateIndirectDraws() {
+        // rebuilt from the mesh ranges every frame since recordUpdates may have moved a mesh, the buffer is only
+        // written when the result differs from what it holds
+        m_indirectCommands.clear();
+        for (const DrawCommand& draw : m_drawList) {
+            const MeshRange& mesh = m_vulkanMeshes.range(m_meshHandles.at(draw.objectType));
+            m_indirectCommands.push_back(vk::DrawIndexedIndirectCommand(mesh.indexCount,
+                                                                        draw.instanceCount,
+                                                                        mesh.firstIndex,
+                                                                        static_cast<int32_t>(mesh.firstVertex),
+                                                                        draw.startInstance));
+        }
+        m_indirectDraws.setCommands(m_indirectCommands);
+        m_indirectDraws.prepareFrame(m_vulkanDevice, m_currentFrame);
+    }
+
+    void VulkanRenderer::renderObjects(vk::CommandBuffer commandBuffer, const DrawCommand& draw) {
+        // may run on several workers at once, so only lookups that cannot insert
+        const MeshRange& mesh = m_vulkanMeshes.range(m_meshHandles.at(draw.objectType));
+        if (!m_bindlessTextures.isEnabled()) {
+            m_materials.at(draw.objectType)->use(commandBuffer, m_vulkanPipeline.layout());
+        }
+        commandBuffer.drawIndexed(mesh.indexCount, draw.instanceCount, mesh.firstIndex, static_cast<int32_t>(mesh.firstVertex), draw.startInstance);
     }
 
     // void VulkanRenderer::loadModel() {
@@ -437,7 +622,7 @@ namespace Genesis {
     //     GN_CORE_INFO("Model loadded successfully.");
     // }
 
-    void VulkanRenderer::createAssets() {
+    void VulkanRenderer::createAssets(VulkanUploadBatch& uploadBatch) {
         std::unordered_map<meshTypes, std::vector<std::string>> modelFilenames = {
             {meshTypes::GROUND, {"assets/models/ground.obj", "assets/models/ground.mtl"}},
             {meshTypes::GIRL, {"assets/models/girl.obj", "assets/models/girl.mtl"}},
@@ -450,27 +635,46 @@ namespace Genesis {
 
         for (auto pair : modelFilenames) {
             ObjMesh model(pair.second[0], pair.second[1], preTransforms[pair.first]);
-            m_vulkanMeshes.consume(pair.first, model.vertices, model.indices);
+            m_meshHandles[pair.first] = m_vulkanMeshes.addMesh(model.vertices, model.indices);
+            m_objectMaterials[pair.first].boundingRadius = m_vulkanMeshes.range(m_meshHandles[pair.first]).boundingRadius;
         }
 
-        m_vulkanMeshes.finalize(m_vulkanDevice, m_vulkanMainCommandBuffer);
         std::unordered_map<meshTypes, std::string> filenames = {
             {meshTypes::GROUND, "assets/textures/ground.jpg"},
             {meshTypes::GIRL, "assets/textures/none.png"},
             {meshTypes::SKULL, "assets/textures/skull.png"},
         };
 
-        m_vulkanSwapchain.createMeshDescriptorPool(m_vulkanDevice);
-
+        // decode every texture in parallel while the meshes upload, then create them in the order decoding finishes
+        auto decodeStart = std::chrono::steady_clock::now();
+        TextureDecoder textureDecoder(m_threadPool);
+        std::unordered_map<std::string, meshTypes> objectsByFilename;
         for (const auto& [object, filename] : filenames) {
+            objectsByFilename[filename] = object;
+            textureDecoder.submit(filename);
+        }
+
+        m_vulkanMeshes.finalize(m_vulkanDevice, uploadBatch);
+
+        while (std::unique_ptr<TextureData> textureData = textureDecoder.next()) {
+            meshTypes object = objectsByFilename[textureData->filename()];
             m_materials[object] = new VulkanTexture(m_vulkanDevice,
-                                                    filename,
-                                                    m_vulkanMainCommandBuffer,
-                                                    m_vulkanDevice.graphicsQueue(),
+                                                    std::move(textureData),
+                                                    uploadBatch,
                                                     m_vulkanSwapchain.meshDescriptorSetLayout(),
-                                                    m_vulkanSwapchain.meshDescriptorPool());
+                                                    m_bindlessTextures);
+            m_objectMaterials[object].textureIndex = m_materials[object]->bindlessIndex();
+            m_textureStreamer.registerTexture(object, m_materials[object], m_vulkanMeshes.range(m_meshHandles[object]).boundingRadius);
         }
 
+        // the ground is the one surface streamed through the virtual texture
+        m_objectMaterials[meshTypes::GROUND].flags |= OBJECT_FLAG_VIRTUAL_TEXTURE;
+
+        GN_CORE_INFO("{} textures decoded and staged in {:.1f} ms on {} workers.",
+                     filenames.size(),
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decodeStart).count(),
+                     m_threadPool.threadCount());
+
         GN_CORE_INFO("Vulkan vertex buffer created.");
     }
 
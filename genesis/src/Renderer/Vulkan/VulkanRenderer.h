@@ -1,22 +1,40 @@
 #pragma once
 
+#include <atomic>
+
 #include "Core/EventSystem.h"
+#include "Core/FrustumCuller.h"
+#include "Core/ThreadPool.h"
 #include "Core/Logger.h"
 #include "Core/Renderer.h"
+#include "VulkanBindlessTextures.h"
 #include "VulkanBuffer.h"
 #include "VulkanCommandBuffer.h"
+#include "VulkanCommandRecorder.h"
+#include "VulkanCullPass.h"
 #include "VulkanDevice.h"
+#include "VulkanIndirectDrawBuffer.h"
 #include "VulkanMesh.h"
 #include "VulkanPipeline.h"
 #include "VulkanSwapchain.h"
 #include "VulkanTexture.h"
+#include "VulkanTextureStreamer.h"
 #include "VulkanTypes.h"
+#include "VulkanUploadBatch.h"
+#include "VulkanUploader.h"
 #include "VulkanVertexMenagerie.h"
+#include "VulkanVirtualTexture.h"
 
 namespace Genesis {
     // const std::string MODEL_PATH = "assets/models/viking_room.obj";
     // const std::string TEXTURE_PATH = "assets/textures/viking_room.png";
 
+    struct DrawCommand {
+            meshTypes objectType;
+            uint32_t startInstance;
+            uint32_t instanceCount;
+    };
+
     class VulkanRenderer : public Renderer {
         public:
             VulkanRenderer(std::shared_ptr<Window> window);
@@ -26,7 +44,7 @@ namespace Genesis {
             VulkanRenderer& operator=(const VulkanRenderer&) = delete;
 
             void init();
-            bool drawFrame(std::shared_ptr<Scene> scene);
+            bool drawFrame(const Scene& scene);
             void shutdown();
 
             void waitForIdle();
@@ -43,12 +61,20 @@ namespace Genesis {
 
             void createCommandPool();
             void createCommandBuffers();
-            void renderFrame(std::shared_ptr<Scene> scene);
-            void recordCommandBuffer(VulkanCommandBuffer& commandBuffer, uint32_t imageIndex, std::shared_ptr<Scene> scene);
-            void renderObjects(VulkanCommandBuffer& commandBuffer, meshTypes objectType, uint32_t& startInstance, uint32_t instanceCount);
+            void renderFrame(const Scene& scene);
+            void recordCommandBuffer(VulkanCommandBuffer& commandBuffer, uint32_t imageIndex, const Scene& scene);
+            // one draw per mesh type; without GPU culling the instances are culled here and the draws only cover the visible ones
+            void buildDrawList(const Scene& scene);
+            // binds everything the draws of a frame share
+            void bindDrawState(vk::CommandBuffer commandBuffer);
+            // records draws [firstDraw, lastDraw) of the draw list along with all the state they need
+            void recordDraws(vk::CommandBuffer commandBuffer, size_t firstDraw, size_t lastDraw);
+            // turns the draw list into indirect commands for the current frame
+            void updateIndirectDraws();
+            void renderObjects(vk::CommandBuffer commandBuffer, const DrawCommand& draw);
 
             // void loadModel();
-            void createAssets();
+            void createAssets(VulkanUploadBatch& uploadBatch);
 
             vk::Instance m_vkInstance{nullptr};
             vk::SurfaceKHR m_vkSurface;
@@ -59,12 +85,34 @@ namespace Genesis {
 
             vk::CommandPool m_vkCommandPool;
             VulkanCommandBuffer m_vulkanMainCommandBuffer;
+            VulkanCommandRecorder m_commandRecorder;
+            // rebuilt every frame, kept to reuse its storage
+            std::vector<DrawCommand> m_drawList;
+            // the whole draw list in one indirect draw, there is no per draw state left once materials are bindless
+            bool m_gpuDriven = false;
+            VulkanIndirectDrawBuffer m_indirectDraws;
+            // the indirect draws are culled by a compute pass first, needs subgroup ballots in compute shaders
+            bool m_gpuCulling = false;
+            VulkanCullPass m_cullPass;
+            std::vector<vk::DrawIndexedIndirectCommand> m_indirectCommands;
+            // culls on the CPU when the compute pass is not available, both rebuilt every frame and kept for their storage
+            FrustumCuller m_frustumCuller;
+            SphereBounds m_cullBounds;
+            std::vector<uint32_t> m_visibleInstances;
 
             VulkanVertexMenagerie m_vulkanMeshes;
+            std::unordered_map<meshTypes, uint32_t> m_meshHandles;
             std::unordered_map<meshTypes, VulkanTexture*> m_materials;
+            std::unordered_map<meshTypes, ObjectMaterial> m_objectMaterials;
+            VulkanBindlessTextures m_bindlessTextures;
+            VulkanUploader m_uploader;
+            VulkanTextureStreamer m_textureStreamer;
+            ThreadPool m_threadPool;
+            VulkanVirtualTexture m_virtualTexture;
 
             uint32_t m_currentFrame = 0;
-            bool m_framebufferResized = false;
+            // set from the main thread's event callbacks, read on the render thread
+            std::atomic<bool> m_framebufferResized = false;
 
             void setupDebugMessenger();
             static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
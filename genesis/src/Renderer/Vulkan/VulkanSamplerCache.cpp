@@ -0,0 +1,154 @@
+#include "VulkanSamplerCache.h"
+
+#include <algorithm>
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    template <typename T>
+    static void hashCombine(size_t& seed, const T& value) {
+        seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    size_t SamplerKeyHash::operator()(const SamplerKey& key) const {
+        const vk::SamplerCreateInfo& createInfo = key.createInfo;
+        size_t seed = 0;
+        hashCombine(seed, static_cast<uint32_t>(createInfo.flags));
+        hashCombine(seed, static_cast<uint32_t>(createInfo.magFilter));
+        hashCombine(seed, static_cast<uint32_t>(createInfo.minFilter));
+        hashCombine(seed, static_cast<uint32_t>(createInfo.mipmapMode));
+        hashCombine(seed, static_cast<uint32_t>(createInfo.addressModeU));
+        hashCombine(seed, static_cast<uint32_t>(createInfo.addressModeV));
+        hashCombine(seed, static_cast<uint32_t>(createInfo.addressModeW));
+        hashCombine(seed, createInfo.mipLodBias);
+        hashCombine(seed, static_cast<uint32_t>(createInfo.anisotropyEnable));
+        hashCombine(seed, createInfo.maxAnisotropy);
+        hashCombine(seed, static_cast<uint32_t>(createInfo.compareEnable));
+        hashCombine(seed, static_cast<uint32_t>(createInfo.compareOp));
+        hashCombine(seed, createInfo.minLod);
+        hashCombine(seed, createInfo.maxLod);
+        hashCombine(seed, static_cast<uint32_t>(createInfo.borderColor));
+        hashCombine(seed, static_cast<uint32_t>(createInfo.unnormalizedCoordinates));
+        hashCombine(seed, static_cast<uint32_t>(key.reductionMode));
+        return seed;
+    }
+
+    static SamplerKey makeSamplerKey(const vk::SamplerCreateInfo& createInfo) {
+        SamplerKey key;
+        key.createInfo = createInfo;
+        key.createInfo.pNext = nullptr;
+
+        for (auto next = static_cast<const vk::BaseInStructure*>(createInfo.pNext); next; next = next->pNext) {
+            if (next->sType == vk::StructureType::eSamplerReductionModeCreateInfo) {
+                key.reductionMode = reinterpret_cast<const vk::SamplerReductionModeCreateInfo*>(next)->reductionMode;
+            } else {
+                std::string errMsg = "Unsupported structure chained to a sampler request: " + vk::to_string(next->sType);
+                GN_CORE_ERROR("{}", errMsg);
+                throw std::runtime_error(errMsg);
+            }
+        }
+
+        return key;
+    }
+
+    VulkanSamplerCache::VulkanSamplerCache() {
+    }
+
+    VulkanSamplerCache::~VulkanSamplerCache() {
+    }
+
+    void VulkanSamplerCache::init(vk::Device device, bool anisotropyEnabled, float maxAnisotropy) {
+        m_vkDevice = device;
+        m_anisotropyEnabled = anisotropyEnabled;
+        m_maxAnisotropy = maxAnisotropy;
+    }
+
+    size_t VulkanSamplerCache::size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_samplers.size();
+    }
+
+    vk::Sampler VulkanSamplerCache::getSampler(const vk::SamplerCreateInfo& createInfo) {
+        SamplerKey key = makeSamplerKey(createInfo);
+
+        // held across creation, two threads asking for the same new sampler must not both create it
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests++;
+
+        auto cached = m_samplers.find(key);
+        if (cached != m_samplers.end()) {
+            return cached->second;
+        }
+
+        // created from the key, the caller's chain may point at memory that is gone once this returns
+        vk::SamplerCreateInfo samplerInfo = key.createInfo;
+        vk::SamplerReductionModeCreateInfo reductionInfo = {};
+        if (key.reductionMode != vk::SamplerReductionMode::eWeightedAverage) {
+            reductionInfo.reductionMode = key.reductionMode;
+            samplerInfo.pNext = &reductionInfo;
+        }
+
+        vk::Sampler sampler;
+        try {
+            sampler = m_vkDevice.createSampler(samplerInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create sampler: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+        m_samplers[key] = sampler;
+
+        GN_CORE_TRACE("Vulkan sampler created, {} unique samplers for {} requests.", m_samplers.size(), m_requests);
+
+        return sampler;
+    }
+
+    vk::Sampler VulkanSamplerCache::getTextureSampler(SamplerQuality quality) {
+        vk::SamplerCreateInfo samplerInfo = {};
+        samplerInfo.flags = vk::SamplerCreateFlags();
+        samplerInfo.minFilter = vk::Filter::eLinear;
+        samplerInfo.magFilter = vk::Filter::eLinear;
+        samplerInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
+        samplerInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
+        samplerInfo.addressModeW = vk::SamplerAddressMode::eRepeat;
+        samplerInfo.borderColor = vk::BorderColor::eIntOpaqueBlack;
+        samplerInfo.unnormalizedCoordinates = false;
+        samplerInfo.compareEnable = false;
+        samplerInfo.compareOp = vk::CompareOp::eAlways;
+        samplerInfo.minLod = 0.0f;
+        // the image view limits the levels, so one sampler works for every texture regardless of its mip count
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+        float anisotropy = 1.0f;
+        switch (quality) {
+            case SamplerQuality::LOW:
+                samplerInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
+                samplerInfo.mipLodBias = 0.5f;
+                break;
+            case SamplerQuality::MEDIUM:
+                samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+                samplerInfo.mipLodBias = 0.0f;
+                anisotropy = 4.0f;
+                break;
+            case SamplerQuality::HIGH:
+                samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+                samplerInfo.mipLodBias = 0.0f;
+                anisotropy = m_maxAnisotropy;
+                break;
+        }
+
+        anisotropy = std::min(anisotropy, m_maxAnisotropy);
+        samplerInfo.anisotropyEnable = m_anisotropyEnabled && anisotropy > 1.0f;
+        samplerInfo.maxAnisotropy = samplerInfo.anisotropyEnable ? anisotropy : 1.0f;
+
+        return getSampler(samplerInfo);
+    }
+
+    void VulkanSamplerCache::destroy() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& [createInfo, sampler] : m_samplers) {
+            m_vkDevice.destroySampler(sampler);
+        }
+        m_samplers.clear();
+    }
+}  // namespace Genesis
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    enum class SamplerQuality {
+        LOW,
+        MEDIUM,
+        HIGH
+    };
+
+    // A sampler request with its pNext chain flattened into values, so requests chaining equal structures at
+    // different addresses compare equal and the key never points at the caller's memory.
+    struct SamplerKey {
+            // pNext is always null, the supported chained structures live in the fields below
+            vk::SamplerCreateInfo createInfo;
+            // what Vulkan uses when no vk::SamplerReductionModeCreateInfo is chained
+            vk::SamplerReductionMode reductionMode = vk::SamplerReductionMode::eWeightedAverage;
+
+            bool operator==(const SamplerKey& other) const = default;
+    };
+
+    struct SamplerKeyHash {
+            size_t operator()(const SamplerKey& key) const;
+    };
+
+    // Samplers are deduplicated on their full create info, identical requests share one vk::Sampler. The only
+    // structure that may be chained is vk::SamplerReductionModeCreateInfo, anything else is rejected. Safe to call
+    // from any thread. Owned by the device, every sampler handed out stays valid until the device is destroyed.
+    class VulkanSamplerCache {
+        public:
+            VulkanSamplerCache();
+            ~VulkanSamplerCache();
+
+            VulkanSamplerCache(const VulkanSamplerCache&) = delete;
+            VulkanSamplerCache& operator=(const VulkanSamplerCache&) = delete;
+
+            size_t size() const;
+            SamplerQuality textureQuality() const { return m_textureQuality; }
+            void setTextureQuality(SamplerQuality quality) { m_textureQuality = quality; }
+
+            void init(vk::Device device, bool anisotropyEnabled, float maxAnisotropy);
+            vk::Sampler getSampler(const vk::SamplerCreateInfo& createInfo);
+            // repeating, mipmapped sampler for material textures at the given (or current default) quality tier
+            vk::Sampler getTextureSampler(SamplerQuality quality);
+            vk::Sampler getTextureSampler() { return getTextureSampler(m_textureQuality); }
+            void destroy();
+
+        private:
+            vk::Device m_vkDevice;
+            bool m_anisotropyEnabled = false;
+            float m_maxAnisotropy = 1.0f;
+            std::atomic<SamplerQuality> m_textureQuality = SamplerQuality::HIGH;
+            uint32_t m_requests = 0;
+
+            mutable std::mutex m_mutex;
+            std::unordered_map<SamplerKey, vk::Sampler, SamplerKeyHash> m_samplers;
+    };
+}  // namespace Genesis
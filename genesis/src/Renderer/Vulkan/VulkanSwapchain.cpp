@@ -4,6 +4,9 @@
 #include "Platform/GLFWWindow.h"
 
 namespace Genesis {
+    // a frame keeps its one set for its whole life, a pool holds a few before another is added
+    static constexpr uint32_t FRAME_DESCRIPTOR_SETS_PER_POOL = 4;
+
     VulkanSwapchain::VulkanSwapchain() {
     }
 
@@ -49,7 +52,8 @@ namespace Genesis {
         createInfo.presentMode = presentMode;
         createInfo.clipped = true;
 
-        createInfo.oldSwapchain = vk::SwapchainKHR(nullptr);
+        // null on first creation, on recreation the old swapchain hands its resources over
+        createInfo.oldSwapchain = m_vkSwapchain;
 
         try {
             m_vkSwapchain = vulkanDevice.logicalDevice().createSwapchainKHR(createInfo);
@@ -65,19 +69,25 @@ namespace Genesis {
         GN_CORE_INFO("Vulkan swapchain created successfully.");
     }
 
-    void VulkanSwapchain::createFrameResources(VulkanDevice& vulkanDevice,
-                                               vk::RenderPass renderpass,
-                                               vk::CommandPool commandPool,
-                                               VulkanCommandBuffer& vulkanCommandBuffer) {
-        createImageViews(vulkanDevice);
-        createColorResources(vulkanDevice);
-        createDepthResources(vulkanDevice, vulkanCommandBuffer);
-        createFramebuffers(vulkanDevice, renderpass);
+    void VulkanSwapchain::createFrameResources(VulkanDevice& vulkanDevice, vk::RenderPass renderpass, vk::CommandPool commandPool) {
+        createImageResources(vulkanDevice, renderpass);
+
+        m_swapchainFrames.resize(m_framesInFlight);
         createCommandBuffers(vulkanDevice, commandPool);
         createSyncObjects(vulkanDevice);
         createDescriptorResources(vulkanDevice);
-        createFrameDescriptorPool(vulkanDevice);
-        createDescriptorSets(vulkanDevice);
+
+        GN_CORE_TRACE("{} frames in flight over {} swapchain images.", m_swapchainFrames.size(), m_swapchainImages.size());
+    }
+
+    void VulkanSwapchain::createImageResources(VulkanDevice& vulkanDevice, vk::RenderPass renderPass) {
+        createImageViews(vulkanDevice);
+        createColorResources(vulkanDevice);
+        createDepthResources(vulkanDevice);
+        createFramebuffers(vulkanDevice, renderPass);
+        for (SwapChainImage& image : m_swapchainImages) {
+            image.renderFinishedSemaphore = createSemaphore(vulkanDevice);
+        }
     }
 
     void VulkanSwapchain::createDescriptorSetLayouts(VulkanDevice& vulkanDevice) {
@@ -90,10 +100,17 @@ namespace Genesis {
         vk::DescriptorSetLayoutBinding storageBufferLayoutBinding = {};
         storageBufferLayoutBinding.binding = 1;
         storageBufferLayoutBinding.descriptorCount = 1;
-        storageBufferLayoutBinding.descriptorType = vk::DescriptorType::eStorageBuffer;
+        storageBufferLayoutBinding.descriptorType = vk::DescriptorType::eStorageBufferDynamic;
         storageBufferLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eVertex;
 
-        std::array<vk::DescriptorSetLayoutBinding, 2> frameBindings = {uboLayoutBinding, storageBufferLayoutBinding};
+        // the indices of the instances that survived GPU culling, unused by the pipeline that draws everything
+        vk::DescriptorSetLayoutBinding visibleInstanceLayoutBinding = {};
+        visibleInstanceLayoutBinding.binding = 2;
+        visibleInstanceLayoutBinding.descriptorCount = 1;
+        visibleInstanceLayoutBinding.descriptorType = vk::DescriptorType::eStorageBuffer;
+        visibleInstanceLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eVertex;
+
+        std::array<vk::DescriptorSetLayoutBinding, 3> frameBindings = {uboLayoutBinding, storageBufferLayoutBinding, visibleInstanceLayoutBinding};
         vk::DescriptorSetLayoutCreateInfo layoutInfo = {};
         layoutInfo.flags = vk::DescriptorSetLayoutCreateFlags();
         layoutInfo.bindingCount = static_cast<uint32_t>(frameBindings.size());
@@ -129,60 +146,12 @@ namespace Genesis {
         GN_CORE_INFO("Vulkan descriptor set layouts created successfully.");
     }
 
-    void VulkanSwapchain::createFrameDescriptorPool(VulkanDevice& vulkanDevice) {
-        std::array<vk::DescriptorPoolSize, 2> poolSizes{};
-        poolSizes[0].type = vk::DescriptorType::eUniformBuffer;
-        poolSizes[0].descriptorCount = static_cast<uint32_t>(m_swapchainFrames.size());
-        poolSizes[1].type = vk::DescriptorType::eStorageBuffer;
-        poolSizes[1].descriptorCount = static_cast<uint32_t>(m_swapchainFrames.size());
-        // poolSizes[1].type = vk::DescriptorType::eCombinedImageSampler;
-        // poolSizes[1].descriptorCount = static_cast<uint32_t>(m_maxFramesInFlight);
-
-        vk::DescriptorPoolCreateInfo poolInfo = {};
-        poolInfo.flags = vk::DescriptorPoolCreateFlags();
-        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-        poolInfo.pPoolSizes = poolSizes.data();
-        poolInfo.maxSets = static_cast<uint32_t>(m_swapchainFrames.size());
-
-        try {
-            m_vkFrameDescriptorPool = vulkanDevice.logicalDevice().createDescriptorPool(poolInfo);
-        } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to create frame descriptor pool: ";
-            GN_CORE_ERROR("{}{}", errMsg, err.what());
-            throw std::runtime_error(errMsg + err.what());
-        }
-
-        GN_CORE_INFO("Vulkan frame descriptor pool created successfully.");
-    }
-
-    void VulkanSwapchain::createMeshDescriptorPool(VulkanDevice& vulkanDevice) {
-        std::array<vk::DescriptorPoolSize, 1> poolSizes{};
-        poolSizes[0].type = vk::DescriptorType::eCombinedImageSampler;
-        poolSizes[0].descriptorCount = static_cast<uint32_t>(m_swapchainFrames.size());
-
-        vk::DescriptorPoolCreateInfo poolInfo = {};
-        poolInfo.flags = vk::DescriptorPoolCreateFlags();
-        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-        poolInfo.pPoolSizes = poolSizes.data();
-        poolInfo.maxSets = static_cast<uint32_t>(m_swapchainFrames.size());
-
-        try {
-            m_vkMeshDescriptorPool = vulkanDevice.logicalDevice().createDescriptorPool(poolInfo);
-        } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to create mesh descriptor pool: ";
-            GN_CORE_ERROR("{}{}", errMsg, err.what());
-            throw std::runtime_error(errMsg + err.what());
-        }
-
-        GN_CORE_INFO("Vulkan mesh descriptor pool created successfully.");
-    }
-
     void VulkanSwapchain::createImageViews(VulkanDevice& vulkanDevice) {
         std::vector<vk::Image> images = vulkanDevice.logicalDevice().getSwapchainImagesKHR(m_vkSwapchain);
-        m_swapchainFrames.resize(images.size());
+        m_swapchainImages.resize(images.size());
         for (size_t i = 0; i < images.size(); ++i) {
-            m_swapchainFrames[i].vulkanImage.setImage(images[i]);
-            m_swapchainFrames[i].vulkanImage.createImageView(vulkanDevice, images[i], m_vkSwapchainImageFormat, vk::ImageAspectFlagBits::eColor, 1);
+            m_swapchainImages[i].vulkanImage.setImage(images[i]);
+            m_swapchainImages[i].vulkanImage.createImageView(vulkanDevice, images[i], m_vkSwapchainImageFormat, vk::ImageAspectFlagBits::eColor, 1);
         }
     }
 
@@ -196,7 +165,8 @@ namespace Genesis {
                                  colorFormat,
                                  vk::ImageTiling::eOptimal,
                                  vk::ImageUsageFlagBits::eTransientAttachment | vk::ImageUsageFlagBits::eColorAttachment,
-                                 vk::MemoryPropertyFlagBits::eDeviceLocal);
+                                 vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                 MemoryCategory::FRAME_RESOURCES);
         m_colorImage.createImageView(vulkanDevice,
                                      m_colorImage.image(),
                                      colorFormat,
@@ -206,41 +176,32 @@ namespace Genesis {
         GN_CORE_INFO("Vulkan color resources created successfuly.");
     }
 
-    void VulkanSwapchain::createDepthResources(VulkanDevice& vulkanDevice, VulkanCommandBuffer& vulkanCommandBuffer) {
+    void VulkanSwapchain::createDepthResources(VulkanDevice& vulkanDevice) {
         vk::Format depthFormat = findDepthFormat(vulkanDevice);
 
-        for (size_t i = 0; i < m_swapchainFrames.size(); ++i) {
-            m_swapchainFrames[i].depthFormat = depthFormat;
-            m_swapchainFrames[i].depthBuffer.createImage(vulkanDevice,
-                                                         extent().width,
-                                                         extent().height,
-                                                         1,
-                                                         vulkanDevice.msaaSamples(),
-                                                         depthFormat,
-                                                         vk::ImageTiling::eOptimal,
-                                                         vk::ImageUsageFlagBits::eDepthStencilAttachment,
-                                                         vk::MemoryPropertyFlagBits::eDeviceLocal);
-            m_swapchainFrames[i].depthBuffer.createImageView(vulkanDevice,
-                                                             m_swapchainFrames[i].depthBuffer.image(),
-                                                             depthFormat,
-                                                             vk::ImageAspectFlagBits::eDepth,
-                                                             1);
-
-            m_swapchainFrames[i].depthBuffer.transitionImageLayout(vulkanDevice,
-                                                                   m_swapchainFrames[i].depthBuffer.image(),
-                                                                   depthFormat,
-                                                                   vk::ImageLayout::eUndefined,
-                                                                   vk::ImageLayout::eDepthStencilAttachmentOptimal,
-                                                                   1,
-                                                                   vulkanCommandBuffer);
-        }
+        m_depthBuffer.createImage(vulkanDevice,
+                                  extent().width,
+                                  extent().height,
+                                  1,
+                                  vulkanDevice.msaaSamples(),
+                                  depthFormat,
+                                  vk::ImageTiling::eOptimal,
+                                  vk::ImageUsageFlagBits::eDepthStencilAttachment,
+                                  vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                  MemoryCategory::FRAME_RESOURCES);
+        m_depthBuffer.createImageView(vulkanDevice,
+                                      m_depthBuffer.image(),
+                                      depthFormat,
+                                      vk::ImageAspectFlagBits::eDepth,
+                                      1);
+        // no layout transition, the render pass takes it from undefined and clears it every frame
 
         GN_CORE_INFO("Vulkan depth resources created successfully.");
     }
 
     void VulkanSwapchain::createFramebuffers(VulkanDevice& vulkanDevice, vk::RenderPass renderPass) {
-        for (size_t i = 0; i < m_swapchainFrames.size(); i++) {
-            std::array<vk::ImageView, 3> attachments = {m_colorImage.imageView(), m_swapchainFrames[i].depthBuffer.imageView(), m_swapchainFrames[i].vulkanImage.imageView()};
+        for (size_t i = 0; i < m_swapchainImages.size(); i++) {
+            std::array<vk::ImageView, 3> attachments = {m_colorImage.imageView(), m_depthBuffer.imageView(), m_swapchainImages[i].vulkanImage.imageView()};
 
             vk::FramebufferCreateInfo framebufferInfo = {};
             framebufferInfo.renderPass = renderPass;
@@ -251,7 +212,7 @@ namespace Genesis {
             framebufferInfo.layers = 1;
 
             try {
-                m_swapchainFrames[i].framebuffer = vulkanDevice.logicalDevice().createFramebuffer(framebufferInfo);
+                m_swapchainImages[i].framebuffer = vulkanDevice.logicalDevice().createFramebuffer(framebufferInfo);
             } catch (vk::SystemError err) {
                 std::string errMsg = "Failed to create framebuffer: ";
                 GN_CORE_ERROR("{}{}", errMsg, err.what());
@@ -271,7 +232,6 @@ namespace Genesis {
     void VulkanSwapchain::createSyncObjects(VulkanDevice& vulkanDevice) {
         for (size_t i = 0; i < m_swapchainFrames.size(); i++) {
             m_swapchainFrames[i].imageAvailableSemaphore = createSemaphore(vulkanDevice);
-            m_swapchainFrames[i].renderFinishedSemaphore = createSemaphore(vulkanDevice);
             m_swapchainFrames[i].inFlightFence = createFence(vulkanDevice);
         }
 
@@ -280,73 +240,130 @@ namespace Genesis {
 
     void VulkanSwapchain::createDescriptorResources(VulkanDevice& vulkanDevice) {
         vk::DeviceSize cameraBufferSize = sizeof(UniformBufferObject);
-        vk::DeviceSize storageBufferSize = 1024 * sizeof(glm::mat4);
+
+        m_frameAllocator.init(vulkanDevice, static_cast<uint32_t>(m_swapchainFrames.size()));
+
+        m_frameDescriptorAllocators.resize(m_swapchainFrames.size());
+        for (std::unique_ptr<VulkanDescriptorAllocator>& descriptorAllocator : m_frameDescriptorAllocators) {
+            descriptorAllocator = std::make_unique<VulkanDescriptorAllocator>();
+            descriptorAllocator->init(vulkanDevice.logicalDevice(),
+                                      FRAME_DESCRIPTOR_SETS_PER_POOL,
+                                      {{vk::DescriptorType::eUniformBuffer, 1.0f},
+                                       {vk::DescriptorType::eStorageBufferDynamic, 1.0f},
+                                       {vk::DescriptorType::eStorageBuffer, 1.0f}});
+        }
 
         for (size_t i = 0; i < m_swapchainFrames.size(); i++) {
             m_swapchainFrames[i].cameraDataBuffer.createBuffer(vulkanDevice,
                                                                cameraBufferSize,
                                                                vk::BufferUsageFlagBits::eUniformBuffer,
-                                                               vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-            m_swapchainFrames[i].cameraDataWriteLocation = vulkanDevice.logicalDevice().mapMemory(m_swapchainFrames[i].cameraDataBuffer.memory(),
-                                                                                                  vk::DeviceSize(0),
-                                                                                                  cameraBufferSize,
-                                                                                                  vk::MemoryMapFlags());
-            m_swapchainFrames[i].modelBuffer.createBuffer(vulkanDevice,
-                                                          storageBufferSize,
-                                                          vk::BufferUsageFlagBits::eStorageBuffer,
-                                                          vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-            m_swapchainFrames[i].modelBufferWriteLocation = vulkanDevice.logicalDevice().mapMemory(m_swapchainFrames[i].modelBuffer.memory(),
-                                                                                                   vk::DeviceSize(0),
-                                                                                                   storageBufferSize,
-                                                                                                   vk::MemoryMapFlags());
-            m_swapchainFrames[i].modelTransforms.reserve(1024);
-            for (int j = 0; j < 1024; ++j) {
-                m_swapchainFrames[i].modelTransforms.push_back(glm::mat4(1.0f));
-            }
+                                                               vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                                               MemoryCategory::FRAME_RESOURCES);
+            m_swapchainFrames[i].cameraDataWriteLocation = m_swapchainFrames[i].cameraDataBuffer.mappedData();
 
             m_swapchainFrames[i].uniformBufferDescriptor.buffer = m_swapchainFrames[i].cameraDataBuffer.buffer();
             m_swapchainFrames[i].uniformBufferDescriptor.offset = 0;
             m_swapchainFrames[i].uniformBufferDescriptor.range = sizeof(UniformBufferObject);
 
-            m_swapchainFrames[i].modelBufferDescriptor.buffer = m_swapchainFrames[i].modelBuffer.buffer();
+            // the buffer is picked per frame in prepareFrame, the range runs from the dynamic offset to the end of the page
+            m_swapchainFrames[i].modelBufferDescriptor.buffer = nullptr;
             m_swapchainFrames[i].modelBufferDescriptor.offset = 0;
-            m_swapchainFrames[i].modelBufferDescriptor.range = 1024 * sizeof(glm::mat4);
+            m_swapchainFrames[i].modelBufferDescriptor.range = VK_WHOLE_SIZE;
+            m_swapchainFrames[i].modelBufferOffset = 0;
+
+            m_swapchainFrames[i].visibleInstanceDescriptor.buffer = nullptr;
+            m_swapchainFrames[i].visibleInstanceDescriptor.offset = 0;
+            m_swapchainFrames[i].visibleInstanceDescriptor.range = VK_WHOLE_SIZE;
         }
 
         GN_CORE_INFO("Vulkan uniform buffers created successfully.");
     }
 
-    void VulkanSwapchain::prepareFrame(VulkanDevice& vulkanDevice, uint32_t imageIndex, std::shared_ptr<Scene> scene) {
-        // static auto startTime = std::chrono::high_resolution_clock::now();
-
-        SwapChainFrame frame = m_swapchainFrames[imageIndex];
-
-        // auto currentTime = std::chrono::high_resolution_clock::now();
-        // float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
-
-        UniformBufferObject ubo{};
-        glm::vec3 eye = {0.0f, 0.0f, 1.0f};
-        glm::vec3 center = {1.0f, 0.0f, 1.0f};
-        glm::vec3 up = {0.0f, 0.0f, 1.0f};
-        ubo.view = glm::lookAt(eye, center, up);
-        ubo.projection = glm::perspective(glm::radians(45.0f), m_vkSwapchainExtent.width / (float)m_vkSwapchainExtent.height, 0.1f, 100.0f);
-        ubo.projection[1][1] *= -1;
-        // ubo.viewProjection = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-
-        frame.cameraData.view = ubo.view;
-        frame.cameraData.projection = ubo.projection;
-        frame.cameraData.viewProjection = ubo.projection * ubo.view;
-        memcpy(frame.cameraDataWriteLocation, &frame.cameraData, sizeof(UniformBufferObject));
+    void VulkanSwapchain::prepareFrame(VulkanDevice& vulkanDevice,
+                                       uint32_t frameIndex,
+                                       const Scene& scene,
+                                       const std::unordered_map<meshTypes, ObjectMaterial>& materials,
+                                       const std::vector<uint32_t>* visibleInstances) {
+        SwapChainFrame& frame = m_swapchainFrames[frameIndex];
+
+        // written straight into the persistently mapped buffer, the GPU is done with it once the fence signalled
+        UniformBufferObject* cameraData = static_cast<UniformBufferObject*>(frame.cameraDataWriteLocation);
+        glm::mat4 view;
+        glm::mat4 projection;
+        cameraMatrices(scene.camera, view, projection);
+        cameraData->view = view;
+        cameraData->projection = projection;
+        cameraData->viewProjection = projection * view;
+        frame.viewProjection = projection * view;
+
+        // the fence for this frame has signalled, so last time's object data is no longer read
+        m_frameAllocator.beginFrame(frameIndex);
+
+        size_t instanceCount = 0;
+        if (visibleInstances) {
+            instanceCount = visibleInstances->size();
+        } else {
+            for (const auto& pair : scene.positions) {
+                instanceCount += pair.second.size();
+            }
+        }
+        FrameAllocation objectAllocation = m_frameAllocator.allocate(vulkanDevice, instanceCount * sizeof(ObjectData));
+        ObjectData* objectData = static_cast<ObjectData*>(objectAllocation.data);
 
         size_t i = 0;
-        for (auto pair : scene->positions) {
-            for (glm::vec3& position : pair.second) {
-                frame.modelTransforms[i++] = glm::translate(glm::mat4(1.0f), position);
+        // with a visible list only those instances are written, packed; it is ascending and numbers the instances
+        // type after type, so it is walked once alongside the types
+        size_t typeStart = 0;
+        size_t nextVisible = 0;
+        for (const auto& pair : scene.positions) {
+            auto material = materials.find(pair.first);
+            ObjectMaterial objectMaterial = material != materials.end() ? material->second : ObjectMaterial();
+            auto writeObject = [&](const glm::vec3& position) {
+                objectData[i].model = glm::translate(glm::mat4(1.0f), position);
+                objectData[i].textureIndex = objectMaterial.textureIndex;
+                objectData[i].flags = objectMaterial.flags;
+                objectData[i].boundingRadius = objectMaterial.boundingRadius;
+                i++;
+            };
+
+            if (visibleInstances) {
+                size_t typeEnd = typeStart + pair.second.size();
+                for (; nextVisible < visibleInstances->size() && (*visibleInstances)[nextVisible] < typeEnd; nextVisible++) {
+                    writeObject(pair.second[(*visibleInstances)[nextVisible] - typeStart]);
+                }
+                typeStart = typeEnd;
+            } else {
+                for (const glm::vec3& position : pair.second) {
+                    writeObject(position);
+                }
             }
         }
-        memcpy(frame.modelBufferWriteLocation, frame.modelTransforms.data(), i * sizeof(glm::mat4));
 
-        writeDescriptorSets(vulkanDevice, imageIndex);
+        frame.modelBufferOffset = objectAllocation.offset;
+
+        // the set is written once and only again when the object data moves to another buffer, which happens when
+        // the frame allocator grows; the offset within it is dynamic
+        if (!frame.descriptorSet) {
+            frame.descriptorSet = m_frameDescriptorAllocators[frameIndex]->allocate(m_vkFrameDescriptorSetLayout);
+            frame.modelBufferDescriptor.buffer = objectAllocation.buffer;
+            writeDescriptorSets(vulkanDevice, frameIndex);
+        } else if (frame.modelBufferDescriptor.buffer != objectAllocation.buffer) {
+            frame.modelBufferDescriptor.buffer = objectAllocation.buffer;
+            writeDescriptorSets(vulkanDevice, frameIndex);
+        }
+    }
+
+    glm::mat4 VulkanSwapchain::viewProjection(const Camera& camera) const {
+        glm::mat4 view;
+        glm::mat4 projection;
+        cameraMatrices(camera, view, projection);
+        return projection * view;
+    }
+
+    void VulkanSwapchain::cameraMatrices(const Camera& camera, glm::mat4& view, glm::mat4& projection) const {
+        view = glm::lookAt(camera.eye, camera.center, camera.up);
+        projection = glm::perspective(camera.fovY, m_vkSwapchainExtent.width / (float)m_vkSwapchainExtent.height, camera.nearPlane, camera.farPlane);
+        projection[1][1] *= -1;
     }
 
     vk::Semaphore VulkanSwapchain::createSemaphore(VulkanDevice& vulkanDevice) {
@@ -375,54 +392,35 @@ namespace Genesis {
         }
     }
 
-    void VulkanSwapchain::createDescriptorSets(VulkanDevice& vulkanDevice) {
-        std::vector<vk::DescriptorSetLayout> layouts(m_swapchainFrames.size(), m_vkFrameDescriptorSetLayout);
-        vk::DescriptorSetAllocateInfo allocInfo = {};
-        allocInfo.descriptorPool = m_vkFrameDescriptorPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(m_swapchainFrames.size());
-        allocInfo.pSetLayouts = layouts.data();
-
-        std::vector<vk::DescriptorSet> descriptorSets;
-        descriptorSets.resize(m_swapchainFrames.size());
-        try {
-            descriptorSets = vulkanDevice.logicalDevice().allocateDescriptorSets(allocInfo);
-        } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to allocate descriptor sets: ";
-            GN_CORE_ERROR("{}{}", errMsg, err.what());
-            throw std::runtime_error(errMsg + err.what());
-        }
-
-        for (size_t i = 0; i < m_swapchainFrames.size(); i++) {
-            m_swapchainFrames[i].descriptorSet = descriptorSets[i];
-
-            // m_swapchainFrames[i].uniformBufferDescriptor.buffer = m_swapchainFrames[i].cameraDataBuffer.buffer();
-            // m_swapchainFrames[i].uniformBufferDescriptor.offset = 0;
-            // m_swapchainFrames[i].uniformBufferDescriptor.range = sizeof(UniformBufferObject);
-        }
-
-        GN_CORE_INFO("Vulkan descriptor sets created successfully.");
-    }
-
-    void VulkanSwapchain::writeDescriptorSets(VulkanDevice& vulkanDevice, uint32_t imageIndex) {
+    void VulkanSwapchain::writeDescriptorSets(VulkanDevice& vulkanDevice, uint32_t frameIndex) {
         // vk::DescriptorImageInfo imageInfo = {};
         // imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
         // imageInfo.imageView = m_textureImage.imageView();
         // imageInfo.sampler = m_vkTextureSampler;
 
-        std::array<vk::WriteDescriptorSet, 2> descriptorWrites{};
-        descriptorWrites[0].dstSet = m_swapchainFrames[imageIndex].descriptorSet;
+        std::array<vk::WriteDescriptorSet, 3> descriptorWrites{};
+        descriptorWrites[0].dstSet = m_swapchainFrames[frameIndex].descriptorSet;
         descriptorWrites[0].dstBinding = 0;
         descriptorWrites[0].dstArrayElement = 0;
         descriptorWrites[0].descriptorType = vk::DescriptorType::eUniformBuffer;
         descriptorWrites[0].descriptorCount = 1;
-        descriptorWrites[0].pBufferInfo = &m_swapchainFrames[imageIndex].uniformBufferDescriptor;
+        descriptorWrites[0].pBufferInfo = &m_swapchainFrames[frameIndex].uniformBufferDescriptor;
 
-        descriptorWrites[1].dstSet = m_swapchainFrames[imageIndex].descriptorSet;
+        descriptorWrites[1].dstSet = m_swapchainFrames[frameIndex].descriptorSet;
         descriptorWrites[1].dstBinding = 1;
         descriptorWrites[1].dstArrayElement = 0;
-        descriptorWrites[1].descriptorType = vk::DescriptorType::eStorageBuffer;
+        descriptorWrites[1].descriptorType = vk::DescriptorType::eStorageBufferDynamic;
         descriptorWrites[1].descriptorCount = 1;
-        descriptorWrites[1].pBufferInfo = &m_swapchainFrames[imageIndex].modelBufferDescriptor;
+        descriptorWrites[1].pBufferInfo = &m_swapchainFrames[frameIndex].modelBufferDescriptor;
+
+        descriptorWrites[2].dstSet = m_swapchainFrames[frameIndex].descriptorSet;
+        descriptorWrites[2].dstBinding = 2;
+        descriptorWrites[2].dstArrayElement = 0;
+        descriptorWrites[2].descriptorType = vk::DescriptorType::eStorageBuffer;
+        descriptorWrites[2].descriptorCount = 1;
+        descriptorWrites[2].pBufferInfo = &m_swapchainFrames[frameIndex].visibleInstanceDescriptor;
+        // a null buffer is not a valid write, the binding stays empty until culling provides one
+        uint32_t writeCount = m_swapchainFrames[frameIndex].visibleInstanceDescriptor.buffer ? 3 : 2;
 
         // descriptorWrites[1].dstSet = m_vkDescriptorSets[i];
         // descriptorWrites[1].dstBinding = 1;
@@ -432,7 +430,7 @@ namespace Genesis {
         // descriptorWrites[1].pImageInfo = &imageInfo;
 
         try {
-            vulkanDevice.logicalDevice().updateDescriptorSets(static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+            vulkanDevice.logicalDevice().updateDescriptorSets(writeCount, descriptorWrites.data(), 0, nullptr);
         } catch (vk::SystemError err) {
             std::string errMsg = "Failed to update descriptor sets: ";
             GN_CORE_ERROR("{}{}", errMsg, err.what());
@@ -442,6 +440,18 @@ namespace Genesis {
         GN_CORE_TRACE2("Vulkan descriptor sets written successfully.");
     }
 
+    void VulkanSwapchain::setVisibleInstanceBuffer(VulkanDevice& vulkanDevice, uint32_t frameIndex, vk::Buffer buffer) {
+        SwapChainFrame& frame = m_swapchainFrames[frameIndex];
+        if (frame.visibleInstanceDescriptor.buffer == buffer) {
+            return;
+        }
+
+        frame.visibleInstanceDescriptor.buffer = buffer;
+        if (frame.descriptorSet) {
+            writeDescriptorSets(vulkanDevice, frameIndex);
+        }
+    }
+
     vk::SurfaceFormatKHR VulkanSwapchain::chooseSwapSurfaceFormat(const std::vector<vk::SurfaceFormatKHR>& availableFormats) {
         for (const auto& availableFormat : availableFormats) {
             if (availableFormat.format == vk::Format::eB8G8R8A8Srgb && availableFormat.colorSpace == vk::ColorSpaceKHR::eSrgbNonlinear) {
@@ -467,12 +477,11 @@ namespace Genesis {
         if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
             return capabilities.currentExtent;
         } else {
-            int width, height;
-            glfwGetFramebufferSize((GLFWwindow*)glfwwindow->getWindow(), &width, &height);
-
+            // the size cached by the window callbacks, glfw may only be queried from the main thread and this can
+            // run on the render thread
             vk::Extent2D actualExtent = {
-                static_cast<uint32_t>(width),
-                static_cast<uint32_t>(height)};
+                static_cast<uint32_t>(glfwwindow->getWindowWidth()),
+                static_cast<uint32_t>(glfwwindow->getWindowHeight())};
 
             actualExtent.width = std::clamp(actualExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
             actualExtent.height = std::clamp(actualExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
@@ -484,56 +493,74 @@ namespace Genesis {
     void VulkanSwapchain::recreateSwapChain(VulkanDevice& vulkanDevice,
                                             const vk::SurfaceKHR& surface,
                                             std::shared_ptr<Window> window,
-                                            vk::RenderPass renderPass,
-                                            vk::CommandPool commandPool,
-                                            VulkanCommandBuffer& vulkanCommandBuffer) {
+                                            vk::RenderPass renderPass) {
         std::shared_ptr<GLFWWindow> glfwwindow = std::dynamic_pointer_cast<GLFWWindow>(window);
-        int width = (int)glfwwindow->getWindowWidth();
-        int height = (int)glfwwindow->getWindowHeight();
-        while (width == 0 || height == 0) {
-            glfwwindow->waitForWindowToBeRestored(&width, &height);
+        // a minimized window has nothing to present to, keep the old swapchain and try again on a later frame, the
+        // main thread blocks until the window is restored so this does not spin
+        if (glfwwindow->getWindowWidth() == 0 || glfwwindow->getWindowHeight() == 0) {
+            return;
         }
 
-        vulkanDevice.logicalDevice().waitIdle();
-
-        cleanupSwapChain(vulkanDevice, commandPool);
-
+        // no wait for idle, frames still in flight keep the old swapchain and attachments until their fences
+        // signal, the deletion queue destroys them after that
+        vk::SwapchainKHR oldSwapchain = m_vkSwapchain;
         createSwapChain(vulkanDevice, surface, window);
-        createFrameResources(vulkanDevice, renderPass, commandPool, vulkanCommandBuffer);
+        retireImageResources(vulkanDevice);
+        vulkanDevice.deletionQueue().destroySwapchain(oldSwapchain);
+
+        createImageResources(vulkanDevice, renderPass);
 
-        GN_CORE_INFO("Vulkan swapchain recreated.");
+        GN_CORE_INFO("Vulkan swapchain recreated at {}x{}.", m_vkSwapchainExtent.width, m_vkSwapchainExtent.height);
     }
 
-    void VulkanSwapchain::cleanupSwapChain(VulkanDevice& vulkanDevice, vk::CommandPool commandPool) {
+    void VulkanSwapchain::cleanupSwapChain(VulkanDevice& vulkanDevice) {
         m_colorImage.destroyImageView(vulkanDevice);
         m_colorImage.destroyImage(vulkanDevice);
         m_colorImage.freeImageMemory(vulkanDevice);
 
-        for (auto frame : m_swapchainFrames) {
-            vulkanDevice.logicalDevice().destroyImageView(frame.depthBuffer.imageView());
-            vulkanDevice.logicalDevice().destroyImage(frame.depthBuffer.image());
-            vulkanDevice.logicalDevice().freeMemory(frame.depthBuffer.imageMemory());
+        m_depthBuffer.destroyImageView(vulkanDevice);
+        m_depthBuffer.destroyImage(vulkanDevice);
+        m_depthBuffer.freeImageMemory(vulkanDevice);
 
-            vulkanDevice.logicalDevice().unmapMemory(frame.cameraDataBuffer.memory());
-            vulkanDevice.logicalDevice().freeMemory(frame.cameraDataBuffer.memory());
-            vulkanDevice.logicalDevice().destroyBuffer(frame.cameraDataBuffer.buffer());
+        for (SwapChainImage& image : m_swapchainImages) {
+            vulkanDevice.logicalDevice().destroySemaphore(image.renderFinishedSemaphore);
+            vulkanDevice.logicalDevice().destroyFramebuffer(image.framebuffer);
+            image.vulkanImage.destroyImageView(vulkanDevice);
+        }
+        m_swapchainImages.clear();
+
+        vulkanDevice.logicalDevice().destroySwapchainKHR(m_vkSwapchain);
+    }
+
+    void VulkanSwapchain::retireImageResources(VulkanDevice& vulkanDevice) {
+        m_colorImage.destroyDeferred(vulkanDevice);
+        m_depthBuffer.destroyDeferred(vulkanDevice);
 
-            vulkanDevice.logicalDevice().unmapMemory(frame.modelBuffer.memory());
-            vulkanDevice.logicalDevice().freeMemory(frame.modelBuffer.memory());
-            vulkanDevice.logicalDevice().destroyBuffer(frame.modelBuffer.buffer());
+        for (SwapChainImage& image : m_swapchainImages) {
+            vulkanDevice.deletionQueue().destroySemaphore(image.renderFinishedSemaphore);
+            vulkanDevice.deletionQueue().destroyFramebuffer(image.framebuffer);
+            vulkanDevice.deletionQueue().destroyImageView(image.vulkanImage.imageView());
+        }
+        m_swapchainImages.clear();
+    }
+
+    void VulkanSwapchain::destroyFrames(VulkanDevice& vulkanDevice, vk::CommandPool commandPool) {
+        for (SwapChainFrame& frame : m_swapchainFrames) {
+            frame.cameraDataBuffer.destroy(vulkanDevice);
 
             vulkanDevice.logicalDevice().destroyFence(frame.inFlightFence);
-            vulkanDevice.logicalDevice().destroySemaphore(frame.renderFinishedSemaphore);
             vulkanDevice.logicalDevice().destroySemaphore(frame.imageAvailableSemaphore);
 
             vulkanDevice.logicalDevice().freeCommandBuffers(commandPool, frame.vulkanCommandBuffer.commandBuffer());
-            vulkanDevice.logicalDevice().destroyFramebuffer(frame.framebuffer);
-            frame.vulkanImage.destroyImageView(vulkanDevice);
         }
+        m_swapchainFrames.clear();
 
-        vulkanDevice.logicalDevice().destroyDescriptorPool(m_vkFrameDescriptorPool);
+        m_frameAllocator.destroy(vulkanDevice);
 
-        vulkanDevice.logicalDevice().destroySwapchainKHR(m_vkSwapchain);
+        for (std::unique_ptr<VulkanDescriptorAllocator>& descriptorAllocator : m_frameDescriptorAllocators) {
+            descriptorAllocator->destroy();
+        }
+        m_frameDescriptorAllocators.clear();
     }
 
     vk::Format VulkanSwapchain::findSupportedFormat(VulkanDevice& vulkanDevice,
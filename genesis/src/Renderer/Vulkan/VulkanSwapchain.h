@@ -1,38 +1,51 @@
 #pragma once
 
+#include <algorithm>
+
 #include "Core/Scene.h"
 #include "Platform/GLFWWindow.h"
 #include "VulkanBuffer.h"
 #include "VulkanCommandBuffer.h"
+#include "VulkanDescriptorAllocator.h"
 #include "VulkanDevice.h"
+#include "VulkanFrameAllocator.h"
 #include "VulkanImage.h"
 #include "VulkanTypes.h"
 
 namespace Genesis {
-    struct SwapChainFrame {
-            VulkanImage vulkanImage;
-            vk::Framebuffer framebuffer;
-            VulkanImage depthBuffer;
-            vk::Format depthFormat;
+    // how many frames the CPU may record ahead of the GPU unless the renderer asks for another count
+    static constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
 
+    // Everything one frame in flight records into and waits on. There are framesInFlight() of these no matter how
+    // many images the swapchain has, each is reused once its fence has signalled.
+    struct SwapChainFrame {
             VulkanCommandBuffer vulkanCommandBuffer;
 
             vk::Semaphore imageAvailableSemaphore;
-            vk::Semaphore renderFinishedSemaphore;
             vk::Fence inFlightFence;
 
-            UniformBufferObject cameraData;
             VulkanBuffer cameraDataBuffer;
             void* cameraDataWriteLocation;
-            std::vector<glm::mat4> modelTransforms;
-            VulkanBuffer modelBuffer;
-            void* modelBufferWriteLocation;
+            // a CPU copy of what went into the camera data, the culling pass builds its frustum from it
+            glm::mat4 viewProjection;
+            // the object data lives in the frame allocator, this is its offset into modelBufferDescriptor.buffer
+            uint32_t modelBufferOffset;
 
             vk::DescriptorBufferInfo uniformBufferDescriptor;
             vk::DescriptorBufferInfo modelBufferDescriptor;
+            // only bound when the GPU culls, its buffer is null otherwise
+            vk::DescriptorBufferInfo visibleInstanceDescriptor;
             vk::DescriptorSet descriptorSet;
     };
 
+    // Per swapchain image, only what presenting that image needs. The present waits on the semaphore of the image
+    // rather than of the frame, an image is only acquired again after its previous present has consumed it.
+    struct SwapChainImage {
+            VulkanImage vulkanImage;
+            vk::Framebuffer framebuffer;
+            vk::Semaphore renderFinishedSemaphore;
+    };
+
     class VulkanSwapchain {
         public:
             VulkanSwapchain();
@@ -42,29 +55,39 @@ namespace Genesis {
             VulkanSwapchain& operator=(const VulkanSwapchain&) = delete;
 
             vk::SwapchainKHR const& swapchain() const { return m_vkSwapchain; }
+            // indexed by frame in flight
             std::vector<SwapChainFrame> const& swapchainFrames() { return m_swapchainFrames; }
+            SwapChainFrame& swapchainFrame(uint32_t frameIndex) { return m_swapchainFrames[frameIndex]; }
+            // indexed by the image index from acquire
+            std::vector<SwapChainImage> const& swapchainImages() { return m_swapchainImages; }
+            uint32_t framesInFlight() const { return m_framesInFlight; }
+            // only takes effect before createFrameResources
+            void setFramesInFlight(uint32_t framesInFlight) { m_framesInFlight = std::max(framesInFlight, 1u); }
             vk::Format const& format() const { return m_vkSwapchainImageFormat; }
             vk::Extent2D const& extent() const { return m_vkSwapchainExtent; }
             vk::DescriptorSetLayout const& frameDescriptorSetLayout() const { return m_vkFrameDescriptorSetLayout; }
-            vk::DescriptorPool const& frameDescriptorPool() const { return m_vkFrameDescriptorPool; }
             vk::DescriptorSetLayout const& meshDescriptorSetLayout() const { return m_vkMeshDescriptorSetLayout; }
-            vk::DescriptorPool const& meshDescriptorPool() const { return m_vkMeshDescriptorPool; }
 
             void createSwapChain(VulkanDevice& vulkanDevice, const vk::SurfaceKHR& surface, std::shared_ptr<Window> window);
-            void createFrameResources(VulkanDevice& vulkanDevice, vk::RenderPass renderPass, vk::CommandPool commandPool, VulkanCommandBuffer& vulkanCommandBuffer);
+            void createFrameResources(VulkanDevice& vulkanDevice, vk::RenderPass renderPass, vk::CommandPool commandPool);
             void createDescriptorSetLayouts(VulkanDevice& vulkanDevice);
-            void createFrameDescriptorPool(VulkanDevice& vulkanDevice);
-            void createMeshDescriptorPool(VulkanDevice& vulkanDevice);
-            void prepareFrame(VulkanDevice& vulkanDevice, uint32_t imageIndex, std::shared_ptr<Scene> scene);
-            void writeDescriptorSets(VulkanDevice& vulkanDevice, uint32_t imageIndex);
+            void prepareFrame(VulkanDevice& vulkanDevice,
+                              uint32_t frameIndex,
+                              const Scene& scene,
+                              const std::unordered_map<meshTypes, ObjectMaterial>& materials,
+                              const std::vector<uint32_t>* visibleInstances = nullptr);
+            glm::mat4 viewProjection(const Camera& camera) const;
+            void writeDescriptorSets(VulkanDevice& vulkanDevice, uint32_t frameIndex);
+            // points the frame's visible instance binding at the culling output, the set is only rewritten on a change
+            void setVisibleInstanceBuffer(VulkanDevice& vulkanDevice, uint32_t frameIndex, vk::Buffer buffer);
 
             void recreateSwapChain(VulkanDevice& vulkanDevice,
                                    const vk::SurfaceKHR& surface,
                                    std::shared_ptr<Window> window,
-                                   vk::RenderPass renderpass,
-                                   vk::CommandPool commandPool,
-                                   VulkanCommandBuffer& vulkanCommandBuffer);
-            void cleanupSwapChain(VulkanDevice& vulkanDevice, vk::CommandPool commandPool);
+                                   vk::RenderPass renderpass);
+            void cleanupSwapChain(VulkanDevice& vulkanDevice);
+            // the frames in flight outlive swapchain recreation, they go at shutdown
+            void destroyFrames(VulkanDevice& vulkanDevice, vk::CommandPool commandPool);
             vk::Format findSupportedFormat(VulkanDevice& vulkanDevice,
                                            const std::vector<vk::Format>& candidates,
                                            vk::ImageTiling tiling,
@@ -72,14 +95,17 @@ namespace Genesis {
             vk::Format findDepthFormat(VulkanDevice& vulkanDevice);
 
         private:
+            void createImageResources(VulkanDevice& vulkanDevice, vk::RenderPass renderPass);
+            // hands everything built on the swapchain images to the deletion queue
+            void retireImageResources(VulkanDevice& vulkanDevice);
             void createImageViews(VulkanDevice& vulkanDevice);
             void createColorResources(VulkanDevice& vulkanDevice);
-            void createDepthResources(VulkanDevice& vulkanDevice, VulkanCommandBuffer& vulkanCommandBuffer);
+            void createDepthResources(VulkanDevice& vulkanDevice);
             void createFramebuffers(VulkanDevice& vulkanDevice, vk::RenderPass renderPass);
             void createCommandBuffers(VulkanDevice& vulkanDevice, vk::CommandPool& commandPool);
             void createSyncObjects(VulkanDevice& vulkanDevice);
             void createDescriptorResources(VulkanDevice& vulkanDevice);
-            void createDescriptorSets(VulkanDevice& vulkanDevice);
+            void cameraMatrices(const Camera& camera, glm::mat4& view, glm::mat4& projection) const;
 
             vk::Semaphore createSemaphore(VulkanDevice& vulkanDevice);
             vk::Fence createFence(VulkanDevice& vulkanDevice);
@@ -91,13 +117,18 @@ namespace Genesis {
             vk::Format m_vkSwapchainImageFormat;
             vk::Extent2D m_vkSwapchainExtent;
 
+            uint32_t m_framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
             std::vector<SwapChainFrame> m_swapchainFrames;
+            std::vector<SwapChainImage> m_swapchainImages;
 
-            vk::DescriptorPool m_vkFrameDescriptorPool;
             vk::DescriptorSetLayout m_vkFrameDescriptorSetLayout;
-            vk::DescriptorPool m_vkMeshDescriptorPool;
             vk::DescriptorSetLayout m_vkMeshDescriptorSetLayout;
+            // one per frame in flight, each frame allocates its set once
+            std::vector<std::unique_ptr<VulkanDescriptorAllocator>> m_frameDescriptorAllocators;
 
+            // one of each is enough, frames in flight are ordered on the one graphics queue by the render pass
             VulkanImage m_colorImage;
+            VulkanImage m_depthBuffer;
+            VulkanFrameAllocator m_frameAllocator;
     };
 }  // namespace Genesis
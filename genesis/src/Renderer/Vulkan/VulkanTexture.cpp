@@ -1,282 +1,262 @@
 #include "VulkanTexture.h"
 
-// this code is to work around a GCC bug when also using FMT (which is included by quill logger)
-#if defined(__GNUC__) && !defined(NDEBUG) && defined(__OPTIMIZE__)
-    #undef __OPTIMIZE__
-#endif
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
-
 #include "Core/Logger.h"
 #include "VulkanBuffer.h"
 
 namespace Genesis {
+    // mips at or below this size are uploaded up front so the texture is usable immediately
+    static constexpr uint32_t TEXTURE_TAIL_SIZE = 64;
+
     VulkanTexture::VulkanTexture(VulkanDevice& vulkanDevice,
-                                 std::string filename,
-                                 VulkanCommandBuffer& vulkanCommandBuffer,
-                                 vk::Queue queue,
+                                 std::unique_ptr<TextureData> textureData,
+                                 VulkanUploadBatch& uploadBatch,
                                  vk::DescriptorSetLayout layout,
-                                 vk::DescriptorPool descriptorPool) {
-        m_vkLogicalDevice = vulkanDevice.logicalDevice();
-        m_filename = filename;
-        m_vulkanCommandBuffer = vulkanCommandBuffer;
-        m_vkDescriptorPool = descriptorPool;
+                                 VulkanBindlessTextures& bindlessTextures) : m_textureData(std::move(textureData)) {
+        m_vulkanDevice = &vulkanDevice;
         m_vkLayout = layout;
+        m_bindlessTextures = &bindlessTextures;
 
-        load();
+        m_vkMipLevels = m_textureData->mipLevels();
+        m_tailMip = 0;
+        while (m_tailMip + 1 < m_vkMipLevels &&
+               std::max(m_textureData->width(m_tailMip), m_textureData->height(m_tailMip)) > TEXTURE_TAIL_SIZE) {
+            m_tailMip++;
+        }
+        m_residentMip = m_vkMipLevels;
+        m_hostImageCopy = vulkanDevice.supportsHostImageTransfer(vk::Format::eR8G8B8A8Srgb);
 
-        m_textureImage.createImage(vulkanDevice,
-                                   m_width,
-                                   m_height,
-                                   m_vkMipLevels,
-                                   vk::SampleCountFlagBits::e1,
-                                   vk::Format::eR8G8B8A8Srgb,
-                                   vk::ImageTiling::eOptimal,
-                                   vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
-                                   vk::MemoryPropertyFlagBits::eDeviceLocal);
+        createTextureSampler(vulkanDevice);
 
-        populate(vulkanDevice);
+        populate(vulkanDevice, uploadBatch);
 
-        stbi_image_free(m_pixels);
+        GN_CORE_INFO("Texture successfully loaded: {} ({} of {} mips resident)", filename().c_str(), m_vkMipLevels - m_residentMip, m_vkMipLevels);
+    }
 
-        m_textureImage.createImageView(vulkanDevice,
-                                       m_textureImage.image(),
-                                       vk::Format::eR8G8B8A8Srgb,  // NOTE: unorm here???
-                                       vk::ImageAspectFlagBits::eColor,
-                                       m_vkMipLevels);
+    VulkanTexture::~VulkanTexture() {
+        // a texture unloaded at runtime may still be sampled by frames in flight, its slot and images outlive those
+        if (m_bindlessIndex != UINT32_MAX) {
+            VulkanBindlessTextures* bindlessTextures = m_bindlessTextures;
+            uint32_t bindlessIndex = m_bindlessIndex;
+            m_vulkanDevice->deletionQueue().defer([bindlessTextures, bindlessIndex]() { bindlessTextures->releaseTexture(bindlessIndex); });
+        }
+        releaseDescriptorSet(*m_vulkanDevice);
+        if (m_hasPendingImage) {
+            m_pendingImage.destroyDeferred(*m_vulkanDevice);
+        }
+        m_textureImage.destroyDeferred(*m_vulkanDevice);
+    }
 
-        createTextureSampler(vulkanDevice);
+    void VulkanTexture::use(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout) {
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 1, m_vkDescriptorSet, nullptr);
+    }
+
+    vk::DeviceSize VulkanTexture::mipChainSize(uint32_t baseMip) const {
+        return static_cast<vk::DeviceSize>(m_textureData->size() - m_textureData->mipOffset(baseMip));
+    }
 
-        makeDescriptorSet(vulkanDevice);
+    void VulkanTexture::populate(VulkanDevice& vulkanDevice, VulkanUploadBatch& uploadBatch) {
+        if (m_hostImageCopy) {
+            createPendingImage(vulkanDevice, m_tailMip);
+            hostCopyResidencyChange(vulkanDevice);
+            commitResidencyChange(vulkanDevice);
+            return;
+        }
 
-        // // generateMipmaps(m_textureImage.image(), vk::Format::eR8G8B8A8Srgb, texWidth, texHeight, m_vkMipLevels);
+        vk::DeviceSize imageSize = mipChainSize(m_tailMip);
+        VulkanBuffer stagingBuffer = uploadBatch.stage(vulkanDevice, imageSize);
 
-        GN_CORE_INFO("Texture successfully loaded: {}", m_filename.c_str());
-    }
+        // only the low resolution tail goes up now, the streamer brings in the larger mips later; nothing samples the
+        // texture before the batch has completed, so it can be committed right away
+        recordResidencyChange(vulkanDevice, uploadBatch.commandBuffer(), stagingBuffer.buffer(), 0, stagingBuffer.mappedData(), m_tailMip);
+        m_pendingImage.recordTransitionImageLayout(uploadBatch.commandBuffer(),
+                                                   m_pendingImage.image(),
+                                                   vk::Format::eR8G8B8A8Srgb,
+                                                   vk::ImageLayout::eTransferDstOptimal,
+                                                   vk::ImageLayout::eShaderReadOnlyOptimal,
+                                                   pendingMipLevels());
 
-    VulkanTexture::~VulkanTexture() {
-        m_vkLogicalDevice.freeMemory(m_textureImage.imageMemory());
-        m_vkLogicalDevice.destroyImage(m_textureImage.image());
-        m_vkLogicalDevice.destroyImageView(m_textureImage.imageView());
-        m_vkLogicalDevice.destroySampler(m_vkSampler);
+        commitResidencyChange(vulkanDevice);
     }
 
-    void VulkanTexture::use(VulkanCommandBuffer& vulkanCommandBuffer, vk::PipelineLayout pipelineLayout) {
-        vulkanCommandBuffer.commandBuffer().bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 1, m_vkDescriptorSet, nullptr);
+    void VulkanTexture::recordResidencyChange(VulkanDevice& vulkanDevice,
+                                              vk::CommandBuffer commandBuffer,
+                                              vk::Buffer stagingBuffer,
+                                              vk::DeviceSize stagingOffset,
+                                              void* stagingData,
+                                              uint32_t baseMip) {
+        uint32_t levelCount = m_vkMipLevels - baseMip;
+
+        m_pendingImage.createImage(vulkanDevice,
+                                   m_textureData->width(baseMip),
+                                   m_textureData->height(baseMip),
+                                   levelCount,
+                                   vk::SampleCountFlagBits::e1,
+                                   vk::Format::eR8G8B8A8Srgb,
+                                   vk::ImageTiling::eOptimal,
+                                   vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+                                   vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                   MemoryCategory::TEXTURES);
+        m_pendingMip = baseMip;
+        m_hasPendingImage = true;
+
+        memcpy(stagingData, m_textureData->mipData(baseMip), static_cast<size_t>(mipChainSize(baseMip)));
+
+        m_pendingImage.recordTransitionImageLayout(commandBuffer,
+                                                   m_pendingImage.image(),
+                                                   vk::Format::eR8G8B8A8Srgb,
+                                                   vk::ImageLayout::eUndefined,
+                                                   vk::ImageLayout::eTransferDstOptimal,
+                                                   levelCount);
+
+        for (uint32_t level = baseMip; level < m_vkMipLevels; level++) {
+            m_pendingImage.recordCopyBufferToImage(commandBuffer,
+                                                   stagingBuffer,
+                                                   stagingOffset + m_textureData->mipOffset(level) - m_textureData->mipOffset(baseMip),
+                                                   m_textureData->width(level),
+                                                   m_textureData->height(level),
+                                                   level - baseMip);
+        }
     }
 
-    void VulkanTexture::load() {
-        m_pixels = stbi_load(m_filename.c_str(), &m_width, &m_height, &m_channels, STBI_rgb_alpha);
+    void VulkanTexture::createPendingImage(VulkanDevice& vulkanDevice, uint32_t baseMip) {
+        m_pendingImage.createImage(vulkanDevice,
+                                   m_textureData->width(baseMip),
+                                   m_textureData->height(baseMip),
+                                   m_vkMipLevels - baseMip,
+                                   vk::SampleCountFlagBits::e1,
+                                   vk::Format::eR8G8B8A8Srgb,
+                                   vk::ImageTiling::eOptimal,
+                                   vk::ImageUsageFlagBits::eHostTransferEXT | vk::ImageUsageFlagBits::eSampled,
+                                   vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                   MemoryCategory::TEXTURES);
+        m_pendingMip = baseMip;
+        m_hasPendingImage = true;
+    }
 
-        if (!m_pixels) {
-            std::string errMsg = "Failed to load texture image.";
-            GN_CORE_ERROR("{}", errMsg);
-            throw std::runtime_error(errMsg);
+    void VulkanTexture::hostCopyResidencyChange(VulkanDevice& vulkanDevice) {
+        uint32_t levelCount = m_vkMipLevels - m_pendingMip;
+
+        vk::HostImageLayoutTransitionInfoEXT transition = {};
+        transition.image = m_pendingImage.image();
+        transition.oldLayout = vk::ImageLayout::eUndefined;
+        transition.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        transition.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        transition.subresourceRange.baseMipLevel = 0;
+        transition.subresourceRange.levelCount = levelCount;
+        transition.subresourceRange.baseArrayLayer = 0;
+        transition.subresourceRange.layerCount = 1;
+
+        std::vector<vk::MemoryToImageCopyEXT> regions(levelCount);
+        for (uint32_t level = m_pendingMip; level < m_vkMipLevels; level++) {
+            vk::MemoryToImageCopyEXT& region = regions[level - m_pendingMip];
+            region.pHostPointer = m_textureData->mipData(level);
+            region.memoryRowLength = 0;
+            region.memoryImageHeight = 0;
+            region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+            region.imageSubresource.mipLevel = level - m_pendingMip;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = vk::Offset3D(0, 0, 0);
+            region.imageExtent = vk::Extent3D(m_textureData->width(level), m_textureData->height(level), 1);
         }
-        // m_vkMipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
-    }
 
-    void VulkanTexture::populate(VulkanDevice& vulkanDevice) {
-        vk::DeviceSize imageSize = m_width * m_height * 4;
-        VulkanBuffer stagingBuffer;
-        stagingBuffer.createBuffer(vulkanDevice,
-                                   imageSize,
-                                   vk::BufferUsageFlagBits::eTransferSrc,
-                                   vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        vk::CopyMemoryToImageInfoEXT copyInfo = {};
+        copyInfo.dstImage = m_pendingImage.image();
+        copyInfo.dstImageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        copyInfo.regionCount = static_cast<uint32_t>(regions.size());
+        copyInfo.pRegions = regions.data();
 
-        void* data;
         try {
-            data = vulkanDevice.logicalDevice().mapMemory(stagingBuffer.memory(), vk::DeviceSize(0), imageSize, vk::MemoryMapFlags());
-            memcpy(data, m_pixels, static_cast<size_t>(imageSize));
-            vulkanDevice.logicalDevice().unmapMemory(stagingBuffer.memory());
+            vulkanDevice.logicalDevice().transitionImageLayoutEXT(transition, vulkanDevice.dispatcher());
+            vulkanDevice.logicalDevice().copyMemoryToImageEXT(copyInfo, vulkanDevice.dispatcher());
         } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to copy memory: ";
+            std::string errMsg = "Failed to copy texture from host memory: ";
             GN_CORE_ERROR("{}{}", errMsg, err.what());
             throw std::runtime_error(errMsg + err.what());
         }
-
-        m_textureImage.transitionImageLayout(vulkanDevice,
-                                             m_textureImage.image(),
-                                             vk::Format::eR8G8B8A8Srgb,  // ???
-                                             vk::ImageLayout::eUndefined,
-                                             vk::ImageLayout::eTransferDstOptimal,
-                                             m_vkMipLevels,
-                                             m_vulkanCommandBuffer);
-
-        m_textureImage.copyBufferToImage(vulkanDevice,
-                                         stagingBuffer.buffer(),
-                                         static_cast<uint32_t>(m_width),
-                                         static_cast<uint32_t>(m_height),
-                                         m_vulkanCommandBuffer);
-
-        m_textureImage.transitionImageLayout(vulkanDevice,
-                                             m_textureImage.image(),
-                                             vk::Format::eR8G8B8A8Srgb,  // ???
-                                             vk::ImageLayout::eTransferDstOptimal,
-                                             vk::ImageLayout::eShaderReadOnlyOptimal,
-                                             m_vkMipLevels,
-                                             m_vulkanCommandBuffer);
-
-        vulkanDevice.logicalDevice().destroyBuffer(stagingBuffer.buffer());
-        vulkanDevice.logicalDevice().freeMemory(stagingBuffer.memory());
     }
 
-    void VulkanTexture::createTextureSampler(VulkanDevice& vulkanDevice) {
-        vk::SamplerCreateInfo samplerInfo = {};
-        samplerInfo.flags = vk::SamplerCreateFlags();
-        samplerInfo.minFilter = vk::Filter::eNearest;
-        samplerInfo.magFilter = vk::Filter::eLinear;
-        samplerInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
-        samplerInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
-        samplerInfo.addressModeW = vk::SamplerAddressMode::eRepeat;
-        samplerInfo.anisotropyEnable = true;
-        samplerInfo.maxAnisotropy = vulkanDevice.physicalDeviceProperties().limits.maxSamplerAnisotropy;
-        samplerInfo.borderColor = vk::BorderColor::eIntOpaqueBlack;
-        samplerInfo.unnormalizedCoordinates = false;
-        samplerInfo.compareEnable = false;
-        samplerInfo.compareOp = vk::CompareOp::eAlways;
-        samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
-        samplerInfo.mipLodBias = 0.0f;
-        samplerInfo.minLod = 0.0f;
-        samplerInfo.maxLod = 0.0f;  // static_cast<float>(m_vkMipLevels);
+    void VulkanTexture::commitResidencyChange(VulkanDevice& vulkanDevice) {
+        if (!m_hasPendingImage) {
+            return;
+        }
 
-        try {
-            m_vkSampler = vulkanDevice.logicalDevice().createSampler(samplerInfo);
-        } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to create texture sampler: ";
-            GN_CORE_ERROR("{}{}", errMsg, err.what());
-            throw std::runtime_error(errMsg + err.what());
+        // frames still in flight sample the old image through the old descriptor, both go once those have retired
+        if (m_textureImage.image()) {
+            releaseDescriptorSet(vulkanDevice);
+            m_textureImage.destroyDeferred(vulkanDevice);
         }
 
-        GN_CORE_INFO("Vulkan texture sampler created succesfully.");
-    }
+        m_textureImage = m_pendingImage;
+        m_pendingImage = VulkanImage();
+        m_hasPendingImage = false;
+        m_residentMip = m_pendingMip;
 
-    void VulkanTexture::makeDescriptorSet(VulkanDevice& vulkanDevice) {
-        std::vector<vk::DescriptorSetLayout> layouts = {m_vkLayout};
-        vk::DescriptorSetAllocateInfo allocInfo = {};
-        allocInfo.descriptorPool = m_vkDescriptorPool;
-        allocInfo.descriptorSetCount = 1;
-        allocInfo.pSetLayouts = layouts.data();
+        m_textureImage.createImageView(vulkanDevice,
+                                       m_textureImage.image(),
+                                       vk::Format::eR8G8B8A8Srgb,  // NOTE: unorm here???
+                                       vk::ImageAspectFlagBits::eColor,
+                                       m_vkMipLevels - m_residentMip);
 
-        std::vector<vk::DescriptorSet> descriptorSets;
-        try {
-            m_vkDescriptorSet = vulkanDevice.logicalDevice().allocateDescriptorSets(allocInfo)[0];
-        } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to allocate descriptor sets: ";
-            GN_CORE_ERROR("{}{}", errMsg, err.what());
-            throw std::runtime_error(errMsg + err.what());
+        writeDescriptorSet(vulkanDevice);
+
+        GN_CORE_TRACE("Texture {} now resident from mip {} ({}x{}).",
+                      filename(),
+                      m_residentMip,
+                      m_textureData->width(m_residentMip),
+                      m_textureData->height(m_residentMip));
+    }
+
+    void VulkanTexture::discardResidencyChange(VulkanDevice& vulkanDevice) {
+        if (!m_hasPendingImage) {
+            return;
         }
 
-        vk::DescriptorImageInfo imageDescriptor;
-        imageDescriptor.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-        imageDescriptor.imageView = m_textureImage.imageView();
-        imageDescriptor.sampler = m_vkSampler;
+        // a failed upload may still have work referencing the image, so it goes through the deletion queue as well
+        m_pendingImage.destroyDeferred(vulkanDevice);
+        m_pendingImage = VulkanImage();
+        m_hasPendingImage = false;
 
-        vk::WriteDescriptorSet descriptorWrite;
-        descriptorWrite.dstSet = m_vkDescriptorSet;
-        descriptorWrite.dstBinding = 0;
-        descriptorWrite.dstArrayElement = 0;
-        descriptorWrite.descriptorType = vk::DescriptorType::eCombinedImageSampler;
-        descriptorWrite.descriptorCount = 1;
-        descriptorWrite.pImageInfo = &imageDescriptor;
+        GN_CORE_TRACE("Texture {} upload discarded, staying resident from mip {}.", filename(), m_residentMip);
+    }
 
-        vulkanDevice.logicalDevice().updateDescriptorSets(descriptorWrite, nullptr);
+    void VulkanTexture::createTextureSampler(VulkanDevice& vulkanDevice) {
+        // identical settings across textures resolve to the same cached sampler
+        m_vkSampler = vulkanDevice.samplerCache().getTextureSampler();
+    }
+
+    void VulkanTexture::writeDescriptorSet(VulkanDevice& vulkanDevice) {
+        if (m_bindlessTextures->isEnabled()) {
+            // frames in flight still sample the old slot, so the new view goes into a fresh one and the old slot is
+            // only handed back once those have retired; the renderer picks the new index up before its next frame
+            uint32_t previousIndex = m_bindlessIndex;
+            m_bindlessIndex = m_bindlessTextures->registerTexture(vulkanDevice, m_textureImage.imageView(), m_vkSampler);
+            if (previousIndex != UINT32_MAX) {
+                VulkanBindlessTextures* bindlessTextures = m_bindlessTextures;
+                vulkanDevice.deletionQueue().defer([bindlessTextures, previousIndex]() { bindlessTextures->releaseTexture(previousIndex); });
+            }
+            return;
+        }
+
+        DescriptorBinding binding = {};
+        binding.binding = 0;
+        binding.type = vk::DescriptorType::eCombinedImageSampler;
+        binding.image.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        binding.image.imageView = m_textureImage.imageView();
+        binding.image.sampler = m_vkSampler;
 
-        GN_CORE_INFO("Vulkan texture descriptor sets created successfully.");
+        m_vkDescriptorSet = vulkanDevice.descriptorCache().getDescriptorSet(m_vkLayout, {binding});
     }
 
-    // void VulkanTexture::generateMipmaps(vk::Image image, vk::Format imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels) {
-    //     // Check if image format supports linear blitting
-    //     vk::FormatProperties formatProperties = m_vulkanDevice.physicalDevice().getFormatProperties(imageFormat);
-
-    //     if (!(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear)) {
-    //         std::string errMsg = "Texture image format does not support linear blitting.";
-    //         GN_CORE_ERROR("{}", errMsg);
-    //         throw std::runtime_error(errMsg);
-    //     }
-
-    //     vk::CommandBuffer commandBuffer = beginSingleTimeCommands();
-
-    //     vk::ImageMemoryBarrier barrier = {};
-    //     barrier.image = image;
-    //     barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    //     barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    //     barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
-    //     barrier.subresourceRange.baseArrayLayer = 0;
-    //     barrier.subresourceRange.layerCount = 1;
-    //     barrier.subresourceRange.levelCount = 1;
-
-    //     int32_t mipWidth = texWidth;
-    //     int32_t mipHeight = texHeight;
-
-    //     for (uint32_t i = 1; i < mipLevels; i++) {
-    //         barrier.subresourceRange.baseMipLevel = i - 1;
-    //         barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-    //         barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
-    //         barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-    //         barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
-
-    //         commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-    //                                       vk::PipelineStageFlagBits::eTransfer,
-    //                                       vk::DependencyFlags(),
-    //                                       0, nullptr,
-    //                                       0, nullptr,
-    //                                       1, &barrier);
-
-    //         vk::ImageBlit blit = {};
-    //         blit.srcOffsets[0] = vk::Offset3D(0, 0, 0);
-    //         blit.srcOffsets[1] = vk::Offset3D(mipWidth, mipHeight, 1);
-    //         blit.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-    //         blit.srcSubresource.mipLevel = i - 1;
-    //         blit.srcSubresource.baseArrayLayer = 0;
-    //         blit.srcSubresource.layerCount = 1;
-    //         blit.dstOffsets[0] = vk::Offset3D(0, 0, 0);
-    //         blit.dstOffsets[1] = vk::Offset3D(mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1);
-    //         blit.dstSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-    //         blit.dstSubresource.mipLevel = i;
-    //         blit.dstSubresource.baseArrayLayer = 0;
-    //         blit.dstSubresource.layerCount = 1;
-
-    //         commandBuffer.blitImage(image, vk::ImageLayout::eTransferSrcOptimal,
-    //                                 image, vk::ImageLayout::eTransferDstOptimal,
-    //                                 1, &blit,
-    //                                 vk::Filter::eLinear);
-
-    //         barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
-    //         barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-    //         barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
-    //         barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-    //         commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-    //                                       vk::PipelineStageFlagBits::eFragmentShader,
-    //                                       vk::DependencyFlags(),
-    //                                       0, nullptr,
-    //                                       0, nullptr,
-    //                                       1, &barrier);
-
-    //         if (mipWidth > 1) {
-    //             mipWidth /= 2;
-    //         }
-    //         if (mipHeight > 1) {
-    //             mipHeight /= 2;
-    //         }
-    //     }
-
-    //     barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-    //     barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-    //     barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-    //     barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-    //     barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-    //     commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-    //                                   vk::PipelineStageFlagBits::eFragmentShader,
-    //                                   vk::DependencyFlags(),
-    //                                   0, nullptr,
-    //                                   0, nullptr,
-    //                                   1, &barrier);
-
-    //     endSingleTimeCommands(commandBuffer);
-
-    //     GN_CORE_INFO("Vulkan mip maps generated successfully.");
-    // }
+    void VulkanTexture::releaseDescriptorSet(VulkanDevice& vulkanDevice) {
+        if (!m_vkDescriptorSet) {
+            return;
+        }
+
+        // frames in flight may still bind the set
+        VulkanDescriptorCache* descriptorCache = &vulkanDevice.descriptorCache();
+        vk::DescriptorSet descriptorSet = m_vkDescriptorSet;
+        vulkanDevice.deletionQueue().defer([descriptorCache, descriptorSet]() { descriptorCache->release(descriptorSet); });
+        m_vkDescriptorSet = nullptr;
+    }
 }  // namespace Genesis
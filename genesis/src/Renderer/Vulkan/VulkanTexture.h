@@ -1,48 +1,84 @@
 #pragma once
 
-#include <stb_image.h>
-
+#include "Resources/TextureData.h"
+#include "VulkanBindlessTextures.h"
+#include "VulkanBuffer.h"
 #include "VulkanCommandBuffer.h"
 #include "VulkanImage.h"
 #include "VulkanTypes.h"
+#include "VulkanUploadBatch.h"
 
 namespace Genesis {
     class VulkanTexture {
         public:
             VulkanTexture(VulkanDevice& vulkanDevice,
-                          std::string filename,
-                          VulkanCommandBuffer& vulkanCommandBuffer,
-                          vk::Queue queue,
+                          std::unique_ptr<TextureData> textureData,
+                          VulkanUploadBatch& uploadBatch,
                           vk::DescriptorSetLayout layout,
-                          vk::DescriptorPool descriptorPool);
+                          VulkanBindlessTextures& bindlessTextures);
             ~VulkanTexture();
 
-            void use(VulkanCommandBuffer& vulkanCommandBuffer, vk::PipelineLayout pipelineLayout);
+            std::string const& filename() const { return m_textureData->filename(); }
+            uint32_t mipLevels() const { return m_vkMipLevels; }
+            uint32_t residentMip() const { return m_residentMip; }
+            uint32_t tailMip() const { return m_tailMip; }
+            bool hasPendingResidency() const { return m_hasPendingImage; }
+            vk::Image const& pendingImage() const { return m_pendingImage.image(); }
+            uint32_t pendingMipLevels() const { return m_vkMipLevels - m_pendingMip; }
+            // changes when a residency change commits, read it again every frame
+            uint32_t bindlessIndex() const { return m_bindlessIndex; }
+            bool usesHostImageCopy() const { return m_hostImageCopy; }
+            vk::Extent2D mipExtent(uint32_t mipLevel) const { return vk::Extent2D(m_textureData->width(mipLevel), m_textureData->height(mipLevel)); }
+
+            void use(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout);
+
+            // bytes needed to hold mip levels [baseMip, mipLevels) in memory
+            vk::DeviceSize mipChainSize(uint32_t baseMip) const;
+            // records the upload of a new image holding mips [baseMip, mipLevels), staging must hold mipChainSize(baseMip)
+            // bytes at stagingOffset; the image is left in TransferDst for the caller to transition or release
+            void recordResidencyChange(VulkanDevice& vulkanDevice,
+                                       vk::CommandBuffer commandBuffer,
+                                       vk::Buffer stagingBuffer,
+                                       vk::DeviceSize stagingOffset,
+                                       void* stagingData,
+                                       uint32_t baseMip);
+            // creates the new image for mips [baseMip, mipLevels) to be filled by hostCopyResidencyChange
+            void createPendingImage(VulkanDevice& vulkanDevice, uint32_t baseMip);
+            // writes the pending image straight from system memory, no queue involved so it may run on a worker thread
+            void hostCopyResidencyChange(VulkanDevice& vulkanDevice);
+            // swaps in the pending image, the GPU must no longer be using the current one
+            void commitResidencyChange(VulkanDevice& vulkanDevice);
+            // drops the pending image of a failed upload and keeps the current residency
+            void discardResidencyChange(VulkanDevice& vulkanDevice);
 
         private:
-            void load();
-            void populate(VulkanDevice& vulkanDevice);
+            void populate(VulkanDevice& vulkanDevice, VulkanUploadBatch& uploadBatch);
             void createTextureSampler(VulkanDevice& vulkanDevice);
-            void makeDescriptorSet(VulkanDevice& vulkanDevice);
-            // void generateMipmaps(vk::Image image, vk::Format imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
+            void writeDescriptorSet(VulkanDevice& vulkanDevice);
+            void releaseDescriptorSet(VulkanDevice& vulkanDevice);
 
-            vk::Device m_vkLogicalDevice;
+            VulkanDevice* m_vulkanDevice = nullptr;
 
-            int m_width;
-            int m_height;
-            int m_channels;
-            std::string m_filename;
-            stbi_uc* m_pixels;
+            // full mip chain kept in system memory so levels can be streamed in and dropped at runtime
+            std::unique_ptr<TextureData> m_textureData;
 
             uint32_t m_vkMipLevels = 1;
+            uint32_t m_tailMip = 0;
+            uint32_t m_residentMip = 0;
+            bool m_hostImageCopy = false;
             VulkanImage m_textureImage;
             vk::Sampler m_vkSampler;
 
+            bool m_hasPendingImage = false;
+            uint32_t m_pendingMip = 0;
+            VulkanImage m_pendingImage;
+
             vk::DescriptorSetLayout m_vkLayout;
+            // from the device's descriptor cache, null until the first commit and in the bindless path
             vk::DescriptorSet m_vkDescriptorSet;
-            vk::DescriptorPool m_vkDescriptorPool;
 
-            VulkanCommandBuffer m_vulkanCommandBuffer;
-            vk::Queue queue;
+            VulkanBindlessTextures* m_bindlessTextures = nullptr;
+            uint32_t m_bindlessIndex = UINT32_MAX;
+
     };
 }  // namespace Genesis
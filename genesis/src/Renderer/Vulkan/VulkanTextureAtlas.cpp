@@ -0,0 +1,420 @@
+#include "VulkanTextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Core/Logger.h"
+#include "Resources/TextureData.h"
+#include "VulkanBuffer.h"
+
+namespace Genesis {
+    static constexpr uint32_t ATLAS_PAGE_SIZE = 2048;
+    static constexpr uint32_t ATLAS_MIP_LEVELS = 4;
+    // placing every block on a multiple of the coarsest mip's footprint keeps each mip texel inside one image
+    static constexpr uint32_t ATLAS_ALIGNMENT = 1 << (ATLAS_MIP_LEVELS - 1);
+    // replicated edge texels around every image, halved at each mip so the coarsest mip still has one
+    static constexpr uint32_t ATLAS_PADDING = ATLAS_ALIGNMENT;
+    static constexpr uint32_t ATLAS_INITIAL_LAYERS = 1;
+    static constexpr uint32_t ATLAS_MAX_LAYERS = 64;
+    // fraction of a page's packed area that may belong to removed images before the page is repacked
+    static constexpr float ATLAS_REPACK_WASTE = 0.25f;
+
+    static uint32_t alignUp(uint32_t value, uint32_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    static vk::DeviceSize blockSize(const PackedRect& rect) {
+        vk::DeviceSize size = 0;
+        for (uint32_t mip = 0; mip < ATLAS_MIP_LEVELS; mip++) {
+            size += static_cast<vk::DeviceSize>(rect.width >> mip) * (rect.height >> mip) * 4;
+        }
+        return size;
+    }
+
+    // writes the padded block and all of its mips into texels, mip 0 first
+    static void buildBlock(const TextureAtlasEntry& entry, uint8_t* texels) {
+        uint32_t blockWidth = entry.rect.width;
+        uint32_t blockHeight = entry.rect.height;
+        for (uint32_t y = 0; y < blockHeight; y++) {
+            uint32_t sy = static_cast<uint32_t>(std::clamp(static_cast<int32_t>(y) - static_cast<int32_t>(ATLAS_PADDING), 0, static_cast<int32_t>(entry.height) - 1));
+            for (uint32_t x = 0; x < blockWidth; x++) {
+                uint32_t sx = static_cast<uint32_t>(std::clamp(static_cast<int32_t>(x) - static_cast<int32_t>(ATLAS_PADDING), 0, static_cast<int32_t>(entry.width) - 1));
+                memcpy(texels + (y * blockWidth + x) * 4, entry.pixels.data() + (sy * entry.width + sx) * 4, 4);
+            }
+        }
+
+        // block sizes are a multiple of the alignment, so every level halves exactly
+        uint8_t* src = texels;
+        for (uint32_t mip = 1; mip < ATLAS_MIP_LEVELS; mip++) {
+            uint32_t srcWidth = blockWidth >> (mip - 1);
+            uint32_t srcHeight = blockHeight >> (mip - 1);
+            uint8_t* dst = src + static_cast<size_t>(srcWidth) * srcHeight * 4;
+            TextureData::downsample(src, srcWidth, srcHeight, dst, blockWidth >> mip, blockHeight >> mip);
+            src = dst;
+        }
+    }
+
+    VulkanTextureAtlas::VulkanTextureAtlas() {
+    }
+
+    VulkanTextureAtlas::~VulkanTextureAtlas() {
+    }
+
+    void VulkanTextureAtlas::init(VulkanDevice& vulkanDevice, vk::CommandPool commandPool) {
+        m_vkCommandPool = commandPool;
+        m_uploadCommandBuffer.create(vulkanDevice, commandPool);
+        m_maxLayers = std::min(ATLAS_MAX_LAYERS, vulkanDevice.physicalDevice().getProperties().limits.maxImageArrayLayers);
+
+        m_image = createArrayImage(vulkanDevice, ATLAS_INITIAL_LAYERS);
+        m_layerCount = ATLAS_INITIAL_LAYERS;
+
+        // anisotropic taps reach further than the padding, keep them off for atlas lookups
+        vk::SamplerCreateInfo samplerInfo = {};
+        samplerInfo.flags = vk::SamplerCreateFlags();
+        samplerInfo.minFilter = vk::Filter::eLinear;
+        samplerInfo.magFilter = vk::Filter::eLinear;
+        samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+        samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+        samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;
+        samplerInfo.anisotropyEnable = false;
+        samplerInfo.maxAnisotropy = 1.0f;
+        samplerInfo.borderColor = vk::BorderColor::eIntOpaqueBlack;
+        samplerInfo.unnormalizedCoordinates = false;
+        samplerInfo.compareEnable = false;
+        samplerInfo.compareOp = vk::CompareOp::eAlways;
+        samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+        samplerInfo.mipLodBias = 0.0f;
+        samplerInfo.minLod = 0.0f;
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+        m_vkSampler = vulkanDevice.samplerCache().getSampler(samplerInfo);
+
+        GN_CORE_INFO("Vulkan texture atlas created with {}x{} pages, up to {} layers.", ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, m_maxLayers);
+    }
+
+    VulkanImage VulkanTextureAtlas::createArrayImage(VulkanDevice& vulkanDevice, uint32_t layerCount) {
+        VulkanImage image;
+        image.createImage(vulkanDevice,
+                          ATLAS_PAGE_SIZE,
+                          ATLAS_PAGE_SIZE,
+                          ATLAS_MIP_LEVELS,
+                          vk::SampleCountFlagBits::e1,
+                          vk::Format::eR8G8B8A8Srgb,
+                          vk::ImageTiling::eOptimal,
+                          vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+                          vk::MemoryPropertyFlagBits::eDeviceLocal,
+                          MemoryCategory::TEXTURES,
+                          layerCount);
+        image.createImageView(vulkanDevice,
+                              image.image(),
+                              vk::Format::eR8G8B8A8Srgb,
+                              vk::ImageAspectFlagBits::eColor,
+                              ATLAS_MIP_LEVELS,
+                              vk::ImageViewType::e2DArray,
+                              layerCount);
+        return image;
+    }
+
+    uint32_t VulkanTextureAtlas::add(uint32_t width, uint32_t height, const uint8_t* pixels) {
+        PackedRect rect = {0, 0, alignUp(width + 2 * ATLAS_PADDING, ATLAS_ALIGNMENT), alignUp(height + 2 * ATLAS_PADDING, ATLAS_ALIGNMENT)};
+        if (width == 0 || height == 0 || rect.width > ATLAS_PAGE_SIZE || rect.height > ATLAS_PAGE_SIZE) {
+            std::string errMsg = "Image does not fit in a texture atlas page: ";
+            GN_CORE_ERROR("{}{}x{}", errMsg, width, height);
+            throw std::runtime_error(errMsg + std::to_string(width) + "x" + std::to_string(height));
+        }
+
+        uint32_t handle;
+        if (!m_freeHandles.empty()) {
+            handle = m_freeHandles.back();
+            m_freeHandles.pop_back();
+        } else {
+            handle = static_cast<uint32_t>(m_entries.size());
+            m_entries.emplace_back();
+        }
+
+        TextureAtlasEntry& entry = m_entries[handle];
+        entry.width = width;
+        entry.height = height;
+        entry.rect = rect;
+        entry.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+        entry.live = true;
+        entry.dirty = true;
+
+        place(handle);
+        return handle;
+    }
+
+    void VulkanTextureAtlas::place(uint32_t handle) {
+        TextureAtlasEntry& entry = m_entries[handle];
+        uint64_t area = static_cast<uint64_t>(entry.rect.width) * entry.rect.height;
+
+        for (uint32_t layer = 0; layer < m_pages.size(); layer++) {
+            std::optional<PackedRect> rect = m_pages[layer].packer.insert(entry.rect.width, entry.rect.height);
+            if (rect) {
+                entry.layer = layer;
+                entry.rect = *rect;
+                m_pages[layer].liveArea += area;
+                return;
+            }
+        }
+
+        if (m_pages.size() >= m_maxLayers) {
+            std::string errMsg = "Texture atlas is full.";
+            GN_CORE_ERROR("{}", errMsg);
+            throw std::runtime_error(errMsg);
+        }
+
+        // add() already checked the block fits an empty page
+        m_pages.push_back({SkylinePacker(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE), 0, false});
+        entry.layer = static_cast<uint32_t>(m_pages.size()) - 1;
+        entry.rect = *m_pages.back().packer.insert(entry.rect.width, entry.rect.height);
+        m_pages.back().liveArea += area;
+    }
+
+    void VulkanTextureAtlas::remove(uint32_t handle) {
+        TextureAtlasEntry& entry = m_entries[handle];
+        if (!entry.live) {
+            return;
+        }
+
+        TextureAtlasPage& page = m_pages[entry.layer];
+        page.liveArea -= static_cast<uint64_t>(entry.rect.width) * entry.rect.height;
+        uint64_t freedArea = page.packer.usedArea() - page.liveArea;
+        if (static_cast<float>(freedArea) > static_cast<float>(page.packer.usedArea()) * ATLAS_REPACK_WASTE) {
+            page.needsRepack = true;
+        }
+
+        entry.live = false;
+        entry.dirty = false;
+        entry.pixels.clear();
+        entry.pixels.shrink_to_fit();
+        m_freeHandles.push_back(handle);
+    }
+
+    TextureAtlasRegion VulkanTextureAtlas::region(uint32_t handle) const {
+        const TextureAtlasEntry& entry = m_entries[handle];
+        float x = static_cast<float>(entry.rect.x + ATLAS_PADDING);
+        float y = static_cast<float>(entry.rect.y + ATLAS_PADDING);
+
+        TextureAtlasRegion region = {};
+        region.layer = entry.layer;
+        region.uvRect = glm::vec4(x, y, x + static_cast<float>(entry.width), y + static_cast<float>(entry.height)) / static_cast<float>(ATLAS_PAGE_SIZE);
+        return region;
+    }
+
+    void VulkanTextureAtlas::repackPages() {
+        bool repacked = false;
+        for (uint32_t layer = 0; layer < m_pages.size(); layer++) {
+            if (!m_pages[layer].needsRepack) {
+                continue;
+            }
+
+            std::vector<uint32_t> handles;
+            for (uint32_t handle = 0; handle < m_entries.size(); handle++) {
+                if (m_entries[handle].live && m_entries[handle].layer == layer) {
+                    handles.push_back(handle);
+                }
+            }
+            // tallest first gives the skyline the flattest profile
+            std::sort(handles.begin(), handles.end(), [this](uint32_t a, uint32_t b) { return m_entries[a].rect.height > m_entries[b].rect.height; });
+
+            m_pages[layer].packer.reset();
+            m_pages[layer].liveArea = 0;
+            m_pages[layer].needsRepack = false;
+
+            for (uint32_t handle : handles) {
+                TextureAtlasEntry& entry = m_entries[handle];
+                std::optional<PackedRect> rect = m_pages[layer].packer.insert(entry.rect.width, entry.rect.height);
+                if (rect) {
+                    entry.rect = *rect;
+                    m_pages[layer].liveArea += static_cast<uint64_t>(rect->width) * rect->height;
+                } else {
+                    place(handle);
+                }
+                entry.dirty = true;
+            }
+            repacked = true;
+        }
+
+        if (repacked) {
+            m_generation++;
+        }
+    }
+
+    vk::DeviceSize VulkanTextureAtlas::dirtyUploadSize() const {
+        vk::DeviceSize size = 0;
+        for (const TextureAtlasEntry& entry : m_entries) {
+            if (entry.live && entry.dirty) {
+                size += blockSize(entry.rect);
+            }
+        }
+        return size;
+    }
+
+    void VulkanTextureAtlas::flush(VulkanDevice& vulkanDevice) {
+        repackPages();
+
+        bool grow = m_pages.size() > m_layerCount;
+        vk::DeviceSize uploadSize = dirtyUploadSize();
+        if (!grow && uploadSize == 0) {
+            return;
+        }
+
+        // layers double so a stream of additions only reallocates a handful of times
+        VulkanImage grownImage;
+        uint32_t grownLayerCount = m_layerCount;
+        if (grow) {
+            while (grownLayerCount < m_pages.size()) {
+                grownLayerCount *= 2;
+            }
+            grownLayerCount = std::min(grownLayerCount, m_maxLayers);
+            grownImage = createArrayImage(vulkanDevice, grownLayerCount);
+        }
+
+        VulkanBuffer stagingBuffer;
+        uint8_t* stagingData = nullptr;
+        if (uploadSize > 0) {
+            stagingBuffer.createBuffer(vulkanDevice,
+                                       uploadSize,
+                                       vk::BufferUsageFlagBits::eTransferSrc,
+                                       vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                       MemoryCategory::STAGING);
+            stagingData = static_cast<uint8_t*>(stagingBuffer.mappedData());
+        }
+
+        m_uploadCommandBuffer.beginSingleTimeCommands(vulkanDevice);
+        vk::CommandBuffer commandBuffer = m_uploadCommandBuffer.commandBuffer();
+
+        if (grow) {
+            recordGrow(commandBuffer, grownImage);
+        } else {
+            vk::ImageLayout oldLayout = m_imageInitialized ? vk::ImageLayout::eShaderReadOnlyOptimal : vk::ImageLayout::eUndefined;
+            recordBarrier(commandBuffer, m_image.image(), m_layerCount, oldLayout, vk::ImageLayout::eTransferDstOptimal,
+                          vk::PipelineStageFlagBits::eFragmentShader, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlags(), vk::AccessFlagBits::eTransferWrite);
+        }
+
+        vk::Image targetImage = grow ? grownImage.image() : m_image.image();
+        uint32_t targetLayerCount = grow ? grownLayerCount : m_layerCount;
+        if (uploadSize > 0) {
+            recordUploads(commandBuffer, targetImage, stagingBuffer.buffer(), stagingData);
+        }
+        recordBarrier(commandBuffer, targetImage, targetLayerCount, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+                      vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead);
+
+        m_uploadCommandBuffer.endSingleTimeCommands(vulkanDevice);
+
+        if (uploadSize > 0) {
+            stagingBuffer.destroy(vulkanDevice);
+        }
+
+        if (grow) {
+            m_image.destroyImageView(vulkanDevice);
+            m_image.destroyImage(vulkanDevice);
+            m_image.freeImageMemory(vulkanDevice);
+            m_image = grownImage;
+            m_layerCount = grownLayerCount;
+            m_generation++;
+        }
+        m_imageInitialized = true;
+
+        uint64_t usedArea = 0;
+        for (const TextureAtlasPage& page : m_pages) {
+            usedArea += page.liveArea;
+        }
+        GN_CORE_TRACE("Texture atlas flushed {} bytes, {} pages in {} layers at {:.1f}% occupancy.",
+                      uploadSize,
+                      m_pages.size(),
+                      m_layerCount,
+                      100.0 * static_cast<double>(usedArea) / (static_cast<double>(ATLAS_PAGE_SIZE) * ATLAS_PAGE_SIZE * m_pages.size()));
+    }
+
+    void VulkanTextureAtlas::recordGrow(vk::CommandBuffer commandBuffer, VulkanImage& grownImage) {
+        recordBarrier(commandBuffer, grownImage.image(), VK_REMAINING_ARRAY_LAYERS, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+                      vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlags(), vk::AccessFlagBits::eTransferWrite);
+        if (!m_imageInitialized) {
+            return;
+        }
+
+        recordBarrier(commandBuffer, m_image.image(), m_layerCount, vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eTransferSrcOptimal,
+                      vk::PipelineStageFlagBits::eFragmentShader, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlags(), vk::AccessFlagBits::eTransferRead);
+
+        std::vector<vk::ImageCopy> copies;
+        for (uint32_t mip = 0; mip < ATLAS_MIP_LEVELS; mip++) {
+            vk::ImageCopy copy = {};
+            copy.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+            copy.srcSubresource.mipLevel = mip;
+            copy.srcSubresource.baseArrayLayer = 0;
+            copy.srcSubresource.layerCount = m_layerCount;
+            copy.dstSubresource = copy.srcSubresource;
+            copy.extent = vk::Extent3D(ATLAS_PAGE_SIZE >> mip, ATLAS_PAGE_SIZE >> mip, 1);
+            copies.push_back(copy);
+        }
+        commandBuffer.copyImage(m_image.image(), vk::ImageLayout::eTransferSrcOptimal, grownImage.image(), vk::ImageLayout::eTransferDstOptimal, copies);
+    }
+
+    void VulkanTextureAtlas::recordUploads(vk::CommandBuffer commandBuffer, vk::Image image, vk::Buffer stagingBuffer, uint8_t* stagingData) {
+        std::vector<vk::BufferImageCopy> copies;
+        vk::DeviceSize offset = 0;
+        for (TextureAtlasEntry& entry : m_entries) {
+            if (!entry.live || !entry.dirty) {
+                continue;
+            }
+
+            buildBlock(entry, stagingData + offset);
+            for (uint32_t mip = 0; mip < ATLAS_MIP_LEVELS; mip++) {
+                vk::BufferImageCopy region = {};
+                region.bufferOffset = offset;
+                region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+                region.imageSubresource.mipLevel = mip;
+                region.imageSubresource.baseArrayLayer = entry.layer;
+                region.imageSubresource.layerCount = 1;
+                region.imageOffset = vk::Offset3D(static_cast<int32_t>(entry.rect.x >> mip), static_cast<int32_t>(entry.rect.y >> mip), 0);
+                region.imageExtent = vk::Extent3D(entry.rect.width >> mip, entry.rect.height >> mip, 1);
+                copies.push_back(region);
+
+                offset += static_cast<vk::DeviceSize>(entry.rect.width >> mip) * (entry.rect.height >> mip) * 4;
+            }
+            entry.dirty = false;
+        }
+
+        commandBuffer.copyBufferToImage(stagingBuffer, image, vk::ImageLayout::eTransferDstOptimal, copies);
+    }
+
+    void VulkanTextureAtlas::recordBarrier(vk::CommandBuffer commandBuffer,
+                                           vk::Image image,
+                                           uint32_t layerCount,
+                                           vk::ImageLayout oldLayout,
+                                           vk::ImageLayout newLayout,
+                                           vk::PipelineStageFlags srcStage,
+                                           vk::PipelineStageFlags dstStage,
+                                           vk::AccessFlags srcAccess,
+                                           vk::AccessFlags dstAccess) {
+        vk::ImageMemoryBarrier barrier = {};
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = ATLAS_MIP_LEVELS;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = layerCount;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+
+        commandBuffer.pipelineBarrier(srcStage, dstStage, vk::DependencyFlags(), nullptr, nullptr, barrier);
+    }
+
+    void VulkanTextureAtlas::shutdown(VulkanDevice& vulkanDevice) {
+        m_image.destroyImageView(vulkanDevice);
+        m_image.destroyImage(vulkanDevice);
+        m_image.freeImageMemory(vulkanDevice);
+        vulkanDevice.logicalDevice().freeCommandBuffers(m_vkCommandPool, m_uploadCommandBuffer.commandBuffer());
+
+        m_entries.clear();
+        m_freeHandles.clear();
+        m_pages.clear();
+        m_layerCount = 0;
+        m_imageInitialized = false;
+    }
+}  // namespace Genesis
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Resources/SkylinePacker.h"
+#include "VulkanCommandBuffer.h"
+#include "VulkanDevice.h"
+#include "VulkanImage.h"
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    struct TextureAtlasRegion {
+            uint32_t layer;
+            // xy is the top left and zw the bottom right corner of the image, in normalized page coordinates
+            glm::vec4 uvRect;
+    };
+
+    struct TextureAtlasEntry {
+            uint32_t width;
+            uint32_t height;
+            uint32_t layer;
+            PackedRect rect;
+            std::vector<uint8_t> pixels;
+            bool live;
+            bool dirty;
+    };
+
+    struct TextureAtlasPage {
+            SkylinePacker packer;
+            uint64_t liveArea;
+            bool needsRepack;
+    };
+
+    // Packs many small RGBA8 images into the layers of one mipmapped 2D array texture, so they share a single
+    // allocation and descriptor. Every image is surrounded by replicated edge texels and aligned to the mip count,
+    // which keeps the mips from bleeding into their neighbours. Pages whose freed space grows too large are repacked
+    // on the next flush, so regions can move: re-read them whenever generation() changes.
+    class VulkanTextureAtlas {
+        public:
+            VulkanTextureAtlas();
+            ~VulkanTextureAtlas();
+
+            VulkanTextureAtlas(const VulkanTextureAtlas&) = delete;
+            VulkanTextureAtlas& operator=(const VulkanTextureAtlas&) = delete;
+
+            vk::ImageView const& imageView() const { return m_image.imageView(); }
+            vk::Sampler const& sampler() const { return m_vkSampler; }
+            uint32_t layerCount() const { return m_layerCount; }
+            uint32_t pageCount() const { return static_cast<uint32_t>(m_pages.size()); }
+            uint32_t generation() const { return m_generation; }
+
+            void init(VulkanDevice& vulkanDevice, vk::CommandPool commandPool);
+            // pixels are tightly packed RGBA8 and copied, the caller can release them right away
+            uint32_t add(uint32_t width, uint32_t height, const uint8_t* pixels);
+            void remove(uint32_t handle);
+            TextureAtlasRegion region(uint32_t handle) const;
+            // repacks fragmented pages, grows the array if needed and uploads everything added since the last flush
+            void flush(VulkanDevice& vulkanDevice);
+            void shutdown(VulkanDevice& vulkanDevice);
+
+        private:
+            void place(uint32_t handle);
+            void repackPages();
+            VulkanImage createArrayImage(VulkanDevice& vulkanDevice, uint32_t layerCount);
+            void recordGrow(vk::CommandBuffer commandBuffer, VulkanImage& grownImage);
+            void recordUploads(vk::CommandBuffer commandBuffer, vk::Image image, vk::Buffer stagingBuffer, uint8_t* stagingData);
+            vk::DeviceSize dirtyUploadSize() const;
+            void recordBarrier(vk::CommandBuffer commandBuffer,
+                               vk::Image image,
+                               uint32_t layerCount,
+                               vk::ImageLayout oldLayout,
+                               vk::ImageLayout newLayout,
+                               vk::PipelineStageFlags srcStage,
+                               vk::PipelineStageFlags dstStage,
+                               vk::AccessFlags srcAccess,
+                               vk::AccessFlags dstAccess);
+
+            uint32_t m_maxLayers = 0;
+            uint32_t m_layerCount = 0;
+            uint32_t m_generation = 0;
+            bool m_imageInitialized = false;
+
+            std::vector<TextureAtlasEntry> m_entries;
+            std::vector<uint32_t> m_freeHandles;
+            std::vector<TextureAtlasPage> m_pages;
+
+            VulkanImage m_image;
+            vk::Sampler m_vkSampler;
+            VulkanCommandBuffer m_uploadCommandBuffer;
+            vk::CommandPool m_vkCommandPool;
+    };
+}  // namespace Genesis
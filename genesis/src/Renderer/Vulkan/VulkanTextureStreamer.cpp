@@ -0,0 +1,297 @@
+#include "VulkanTextureStreamer.h"
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    // streamed textures stay below this share of the device local budget, short of the allocator's warning fraction so
+    // other allocations have room before the driver starts evicting
+    static constexpr float TEXTURE_BUDGET_FRACTION = 0.8f;
+
+    VulkanTextureStreamer::VulkanTextureStreamer() {
+    }
+
+    VulkanTextureStreamer::~VulkanTextureStreamer() {
+    }
+
+    vk::DeviceSize VulkanTextureStreamer::residentBytes() const {
+        vk::DeviceSize total = 0;
+        for (const StreamedTexture& streamedTexture : m_textures) {
+            if (streamedTexture.texture->residentMip() < streamedTexture.texture->mipLevels()) {
+                total += streamedTexture.texture->mipChainSize(streamedTexture.texture->residentMip());
+            }
+        }
+        return total;
+    }
+
+    void VulkanTextureStreamer::init(VulkanUploader& uploader, ThreadPool& threadPool) {
+        m_uploader = &uploader;
+        m_threadPool = &threadPool;
+
+        GN_CORE_INFO("Vulkan texture streamer initialized.");
+    }
+
+    void VulkanTextureStreamer::registerTexture(meshTypes objectType, VulkanTexture* texture, float boundingRadius) {
+        StreamedTexture streamedTexture = {};
+        streamedTexture.texture = texture;
+        streamedTexture.objectType = objectType;
+        streamedTexture.boundingRadius = boundingRadius;
+        streamedTexture.priority = 0.0f;
+        streamedTexture.desiredMip = texture->tailMip();
+        streamedTexture.hostCopyFailed = false;
+        m_textures.push_back(streamedTexture);
+    }
+
+    void VulkanTextureStreamer::update(VulkanDevice& vulkanDevice, const Scene& scene, float viewportHeight) {
+        retireUploads(vulkanDevice);
+        updateMemoryBudget(vulkanDevice);
+        updatePriorities(scene, viewportHeight);
+        applyMemoryBudget();
+        scheduleUploads(vulkanDevice);
+    }
+
+    void VulkanTextureStreamer::shutdown(VulkanDevice& vulkanDevice) {
+        if (m_threadPool) {
+            m_threadPool->waitIdle();
+        }
+        m_uploader->waitIdle(vulkanDevice);
+        m_uploads.clear();
+        m_textures.clear();
+    }
+
+    bool VulkanTextureStreamer::isUploadComplete(VulkanDevice& vulkanDevice, const TextureUpload& upload) {
+        if (upload.hostCopy) {
+            return upload.hostCopyState->load(std::memory_order_acquire) != HostCopyState::PENDING;
+        }
+        return m_uploader->isComplete(vulkanDevice, upload.uploadValue);
+    }
+
+    void VulkanTextureStreamer::retireUploads(VulkanDevice& vulkanDevice) {
+        std::vector<size_t> completed;
+        for (size_t i = 0; i < m_uploads.size(); i++) {
+            if (isUploadComplete(vulkanDevice, m_uploads[i])) {
+                completed.push_back(i);
+            }
+        }
+
+        if (completed.empty()) {
+            return;
+        }
+
+        // committing swaps in a new image and descriptor, the old ones go through the deletion queue so frames in
+        // flight keep sampling them until they retire
+        for (auto it = completed.rbegin(); it != completed.rend(); ++it) {
+            TextureUpload& upload = m_uploads[*it];
+            if (upload.hostCopy && upload.hostCopyState->load(std::memory_order_acquire) == HostCopyState::FAILED) {
+                // the half written image is never swapped in, the texture stays at its current residency and the
+                // next refinement goes through staging instead
+                upload.texture->discardResidencyChange(vulkanDevice);
+                for (StreamedTexture& streamedTexture : m_textures) {
+                    if (streamedTexture.texture == upload.texture) {
+                        streamedTexture.hostCopyFailed = true;
+                    }
+                }
+                m_uploads.erase(m_uploads.begin() + *it);
+                continue;
+            }
+
+            upload.texture->commitResidencyChange(vulkanDevice);
+            m_uploads.erase(m_uploads.begin() + *it);
+        }
+
+        GN_CORE_TRACE("Texture streaming: {} KiB resident of {} KiB budget.", residentBytes() / 1024, m_memoryBudget / 1024);
+    }
+
+    void VulkanTextureStreamer::updateMemoryBudget(VulkanDevice& vulkanDevice) {
+        // the allocator refreshed the heap budgets at the start of the frame; whatever is not a resident streamed mip
+        // chain, other textures and uploads in flight included, is taken as fixed and the streamed textures get the rest
+        vk::DeviceSize budget = 0;
+        vk::DeviceSize usage = 0;
+        for (const VulkanHeapBudget& heapBudget : vulkanDevice.allocator().heapBudgets()) {
+            if (heapBudget.deviceLocal) {
+                budget += heapBudget.budget;
+                usage += heapBudget.usage;
+            }
+        }
+
+        vk::DeviceSize streamedBytes = residentBytes();
+        vk::DeviceSize otherBytes = usage > streamedBytes ? usage - streamedBytes : 0;
+        vk::DeviceSize textureBudget = static_cast<vk::DeviceSize>(static_cast<double>(budget) * TEXTURE_BUDGET_FRACTION);
+        m_memoryBudget = textureBudget > otherBytes ? textureBudget - otherBytes : 0;
+    }
+
+    void VulkanTextureStreamer::updatePriorities(const Scene& scene, float viewportHeight) {
+        // pixels covered by one world unit at a distance of one unit
+        float projectionScale = viewportHeight / std::tan(scene.camera.fovY * 0.5f);
+
+        // the closest instance of a type decides how large its textures get on screen, found in one pass over the
+        // instances rather than one per texture
+        m_closestInstances.clear();
+        for (const auto& [objectType, positions] : scene.positions) {
+            float closest = std::numeric_limits<float>::max();
+            for (const glm::vec3& position : positions) {
+                closest = std::min(closest, glm::length(position - scene.camera.eye));
+            }
+            m_closestInstances[objectType] = closest;
+        }
+
+        for (StreamedTexture& streamedTexture : m_textures) {
+            float projectedSize = 0.0f;
+
+            auto closest = m_closestInstances.find(streamedTexture.objectType);
+            if (closest != m_closestInstances.end() && closest->second != std::numeric_limits<float>::max()) {
+                if (closest->second <= streamedTexture.boundingRadius) {
+                    projectedSize = std::numeric_limits<float>::max();
+                } else {
+                    projectedSize = streamedTexture.boundingRadius * projectionScale / closest->second;
+                }
+            }
+
+            VulkanTexture* texture = streamedTexture.texture;
+            float textureSize = static_cast<float>(std::max(texture->mipExtent(0).width, texture->mipExtent(0).height));
+            uint32_t desiredMip = texture->tailMip();
+            if (projectedSize >= textureSize) {
+                desiredMip = 0;
+            } else if (projectedSize > 0.0f) {
+                desiredMip = std::min(static_cast<uint32_t>(std::floor(std::log2(textureSize / projectedSize))), texture->tailMip());
+            }
+
+            streamedTexture.priority = projectedSize;
+            streamedTexture.desiredMip = desiredMip;
+        }
+    }
+
+    void VulkanTextureStreamer::applyMemoryBudget() {
+        vk::DeviceSize total = 0;
+        std::vector<StreamedTexture*> byPriority;
+        for (StreamedTexture& streamedTexture : m_textures) {
+            total += streamedTexture.texture->mipChainSize(streamedTexture.desiredMip);
+            byPriority.push_back(&streamedTexture);
+        }
+
+        if (total <= m_memoryBudget) {
+            return;
+        }
+
+        // drop the top mips of the least important (smallest on screen) textures first
+        std::sort(byPriority.begin(), byPriority.end(), [](const StreamedTexture* a, const StreamedTexture* b) {
+            return a->priority < b->priority;
+        });
+
+        bool dropped = true;
+        while (total > m_memoryBudget && dropped) {
+            dropped = false;
+            for (StreamedTexture* streamedTexture : byPriority) {
+                VulkanTexture* texture = streamedTexture->texture;
+                if (streamedTexture->desiredMip < texture->tailMip()) {
+                    total -= texture->mipChainSize(streamedTexture->desiredMip) - texture->mipChainSize(streamedTexture->desiredMip + 1);
+                    streamedTexture->desiredMip++;
+                    dropped = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    void VulkanTextureStreamer::scheduleUploads(VulkanDevice& vulkanDevice) {
+        bool overBudget = residentBytes() > m_memoryBudget;
+
+        std::vector<StreamedTexture*> byPriority;
+        for (StreamedTexture& streamedTexture : m_textures) {
+            byPriority.push_back(&streamedTexture);
+        }
+        std::sort(byPriority.begin(), byPriority.end(), [](const StreamedTexture* a, const StreamedTexture* b) {
+            return a->priority > b->priority;
+        });
+
+        vk::DeviceSize bytesThisFrame = 0;
+        for (StreamedTexture* streamedTexture : byPriority) {
+            if (m_uploads.size() >= m_maxUploadsInFlight || bytesThisFrame >= m_uploadBytesPerFrame) {
+                break;
+            }
+
+            VulkanTexture* texture = streamedTexture->texture;
+            if (texture->hasPendingResidency()) {
+                continue;
+            }
+
+            uint32_t residentMip = texture->residentMip();
+            if (residentMip > streamedTexture->desiredMip) {
+                // refine one level at a time so the next-best mip shows up as early as possible
+                if (!beginUpload(vulkanDevice, *streamedTexture, residentMip - 1)) {
+                    break;
+                }
+                bytesThisFrame += texture->mipChainSize(residentMip - 1);
+            } else if (overBudget && residentMip < streamedTexture->desiredMip) {
+                if (!beginUpload(vulkanDevice, *streamedTexture, streamedTexture->desiredMip)) {
+                    break;
+                }
+                bytesThisFrame += texture->mipChainSize(streamedTexture->desiredMip);
+            }
+        }
+
+        // everything scheduled this frame goes to the transfer queue as one batch
+        m_uploader->submit(vulkanDevice);
+    }
+
+    bool VulkanTextureStreamer::beginUpload(VulkanDevice& vulkanDevice, StreamedTexture& streamedTexture, uint32_t baseMip) {
+        if (streamedTexture.texture->usesHostImageCopy() && !streamedTexture.hostCopyFailed) {
+            beginHostCopy(vulkanDevice, streamedTexture, baseMip);
+            return true;
+        }
+
+        TextureUpload upload = {};
+        upload.texture = streamedTexture.texture;
+        upload.size = streamedTexture.texture->mipChainSize(baseMip);
+        upload.hostCopy = false;
+
+        // a full ring means the transfer queue is already busy, try again once earlier batches retire
+        UploadStaging staging = m_uploader->stage(vulkanDevice, upload.size);
+        if (!staging.data) {
+            return false;
+        }
+
+        try {
+            vk::CommandBuffer commandBuffer = m_uploader->commandBuffer(vulkanDevice);
+            streamedTexture.texture->recordResidencyChange(vulkanDevice, commandBuffer, staging.buffer, staging.offset, staging.data, baseMip);
+            m_uploader->releaseImage(streamedTexture.texture->pendingImage(), streamedTexture.texture->pendingMipLevels());
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to record texture upload: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+        upload.uploadValue = m_uploader->pendingValue();
+
+        GN_CORE_TRACE("Streaming {} from mip {} ({} KiB).", streamedTexture.texture->filename(), baseMip, upload.size / 1024);
+
+        m_uploads.push_back(upload);
+        return true;
+    }
+
+    void VulkanTextureStreamer::beginHostCopy(VulkanDevice& vulkanDevice, StreamedTexture& streamedTexture, uint32_t baseMip) {
+        TextureUpload upload = {};
+        upload.texture = streamedTexture.texture;
+        upload.size = streamedTexture.texture->mipChainSize(baseMip);
+        upload.hostCopy = true;
+        upload.hostCopyState = std::make_shared<std::atomic<HostCopyState>>(HostCopyState::PENDING);
+
+        // the image is created here so the texture's pending state only ever changes on this thread
+        upload.texture->createPendingImage(vulkanDevice, baseMip);
+
+        VulkanTexture* texture = upload.texture;
+        std::shared_ptr<std::atomic<HostCopyState>> state = upload.hostCopyState;
+        m_threadPool->submit([&vulkanDevice, texture, state] {
+            try {
+                texture->hostCopyResidencyChange(vulkanDevice);
+                state->store(HostCopyState::COMPLETE, std::memory_order_release);
+            } catch (std::exception& err) {
+                // nothing may escape a worker, retireUploads discards the pending image on the render thread
+                GN_CORE_ERROR("Host texture copy for {} failed: {}", texture->filename(), err.what());
+                state->store(HostCopyState::FAILED, std::memory_order_release);
+            }
+        });
+
+        GN_CORE_TRACE("Streaming {} from mip {} via host copy ({} KiB).", texture->filename(), baseMip, upload.size / 1024);
+
+        m_uploads.push_back(upload);
+    }
+}  // namespace Genesis
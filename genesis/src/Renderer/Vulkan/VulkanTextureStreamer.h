@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+
+#include "Core/Scene.h"
+#include "Core/ThreadPool.h"
+#include "VulkanDevice.h"
+#include "VulkanTexture.h"
+#include "VulkanTypes.h"
+#include "VulkanUploader.h"
+
+namespace Genesis {
+    struct StreamedTexture {
+            VulkanTexture* texture;
+            meshTypes objectType;
+            float boundingRadius;
+            float priority;
+            uint32_t desiredMip;
+            // set once a host image copy has failed, later uploads of the texture go through staging
+            bool hostCopyFailed;
+    };
+
+    enum class HostCopyState {
+        PENDING,
+        COMPLETE,
+        FAILED
+    };
+
+    struct TextureUpload {
+            VulkanTexture* texture;
+            // the uploader batch value that completes the staging copy
+            uint64_t uploadValue;
+            vk::DeviceSize size;
+            // host image copies run on a worker and signal this instead of a fence
+            bool hostCopy;
+            std::shared_ptr<std::atomic<HostCopyState>> hostCopyState;
+    };
+
+    class VulkanTextureStreamer {
+        public:
+            VulkanTextureStreamer();
+            ~VulkanTextureStreamer();
+
+            VulkanTextureStreamer(const VulkanTextureStreamer&) = delete;
+            VulkanTextureStreamer& operator=(const VulkanTextureStreamer&) = delete;
+
+            vk::DeviceSize residentBytes() const;
+            // follows the device memory budget, recomputed every update
+            vk::DeviceSize memoryBudget() const { return m_memoryBudget; }
+
+            void init(VulkanUploader& uploader, ThreadPool& threadPool);
+            void registerTexture(meshTypes objectType, VulkanTexture* texture, float boundingRadius);
+            void update(VulkanDevice& vulkanDevice, const Scene& scene, float viewportHeight);
+            void shutdown(VulkanDevice& vulkanDevice);
+
+        private:
+            void retireUploads(VulkanDevice& vulkanDevice);
+            void updateMemoryBudget(VulkanDevice& vulkanDevice);
+            void updatePriorities(const Scene& scene, float viewportHeight);
+            void applyMemoryBudget();
+            void scheduleUploads(VulkanDevice& vulkanDevice);
+            bool beginUpload(VulkanDevice& vulkanDevice, StreamedTexture& streamedTexture, uint32_t baseMip);
+            void beginHostCopy(VulkanDevice& vulkanDevice, StreamedTexture& streamedTexture, uint32_t baseMip);
+            bool isUploadComplete(VulkanDevice& vulkanDevice, const TextureUpload& upload);
+
+            VulkanUploader* m_uploader = nullptr;
+            ThreadPool* m_threadPool = nullptr;
+            std::vector<StreamedTexture> m_textures;
+            std::vector<TextureUpload> m_uploads;
+            // distance from the camera to the closest instance of each type, rebuilt every update
+            std::unordered_map<meshTypes, float> m_closestInstances;
+
+            vk::DeviceSize m_memoryBudget = 0;
+            vk::DeviceSize m_uploadBytesPerFrame = 8 * 1024 * 1024;
+            uint32_t m_maxUploadsInFlight = 4;
+    };
+}  // namespace Genesis
@@ -13,6 +13,8 @@ namespace Genesis {
     struct QueueFamilyIndices {
             std::optional<uint32_t> graphicsFamily;
             std::optional<uint32_t> presentFamily;
+            // optional, a family that can copy but not draw, usually backed by the DMA engines
+            std::optional<uint32_t> transferFamily;
 
             bool isComplete() {
                 return graphicsFamily.has_value() && presentFamily.has_value();
@@ -71,8 +73,40 @@ namespace Genesis {
     //         }
     // };
 
-    struct ObjectData {
+    // ObjectData::flags, the instance samples the virtual texture instead of its material
+    static constexpr uint32_t OBJECT_FLAG_VIRTUAL_TEXTURE = 1;
+
+    // per instance data, matches the std140 layout of the object storage buffer
+    struct alignas(16) ObjectData {
             glm::mat4 model;
+            uint32_t textureIndex;
+            uint32_t flags;
+            // of the mesh around its origin, before the model transform
+            float boundingRadius;
+    };
+
+    // what every instance of a mesh type gets in its object data besides the transform
+    struct ObjectMaterial {
+            uint32_t textureIndex = 0;
+            uint32_t flags = 0;
+            float boundingRadius = 0.0f;
+    };
+
+    // fragment stage push constant describing how to resolve the virtual texture, pushed once per command buffer;
+    // whether an instance uses it is up to OBJECT_FLAG_VIRTUAL_TEXTURE in its object data
+    struct VirtualTextureParams {
+            uint32_t enabled;
+            uint32_t feedbackJitter;
+            uint32_t pageSize;
+            uint32_t pageBorder;
+            uint32_t pageCount;
+            uint32_t mipCount;
+            uint32_t cacheTiles;
+    };
+
+    // compute stage push constant of the culling pass, the frustum planes in world space with inward normals
+    struct CullParams {
+            glm::vec4 planes[6];
     };
 
 }  // namespace Genesis
@@ -0,0 +1,151 @@
+#include "VulkanUploadBatch.h"
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    // staging memory a batch may hold before it flushes early
+    static constexpr vk::DeviceSize UPLOAD_BATCH_STAGING_LIMIT = 256 * 1024 * 1024;
+
+    VulkanUploadBatch::VulkanUploadBatch() {
+    }
+
+    VulkanUploadBatch::~VulkanUploadBatch() {
+    }
+
+    void VulkanUploadBatch::begin(VulkanDevice& vulkanDevice, vk::CommandPool commandPool) {
+        m_vkCommandPool = commandPool;
+
+        vk::CommandBufferAllocateInfo allocInfo = {};
+        allocInfo.commandPool = m_vkCommandPool;
+        allocInfo.level = vk::CommandBufferLevel::ePrimary;
+        allocInfo.commandBufferCount = 1;
+
+        try {
+            m_vkCommandBuffer = vulkanDevice.logicalDevice().allocateCommandBuffers(allocInfo)[0];
+            m_vkFence = vulkanDevice.logicalDevice().createFence(vk::FenceCreateInfo());
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create upload batch: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        record(vulkanDevice);
+    }
+
+    VulkanBuffer VulkanUploadBatch::stage(VulkanDevice& vulkanDevice, vk::DeviceSize size) {
+        if (m_stagedBytes > 0 && m_stagedBytes + size > UPLOAD_BATCH_STAGING_LIMIT) {
+            flush(vulkanDevice);
+        }
+
+        VulkanBuffer stagingBuffer;
+        stagingBuffer.createBuffer(vulkanDevice,
+                                   size,
+                                   vk::BufferUsageFlagBits::eTransferSrc,
+                                   vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                   MemoryCategory::STAGING);
+        m_stagingBuffers.push_back(stagingBuffer);
+        m_stagedBytes += size;
+        return stagingBuffer;
+    }
+
+    void VulkanUploadBatch::submit(VulkanDevice& vulkanDevice) {
+        // buffer copies carry no barrier of their own, make them visible to everything that reads them later
+        vk::MemoryBarrier barrier = {};
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead | vk::AccessFlagBits::eShaderRead;
+        m_vkCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                          vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader,
+                                          vk::DependencyFlags(),
+                                          barrier,
+                                          nullptr,
+                                          nullptr);
+
+        try {
+            m_vkCommandBuffer.end();
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to record upload batch: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        vk::SubmitInfo submitInfo = {};
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &m_vkCommandBuffer;
+
+        try {
+            vulkanDevice.graphicsQueue().submit(submitInfo, m_vkFence);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to submit upload batch: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        m_submitted = true;
+        m_submitCount++;
+
+        GN_CORE_TRACE("Upload batch submitted: {} staging buffers, {} KiB.", m_stagingBuffers.size(), m_stagedBytes / 1024);
+    }
+
+    void VulkanUploadBatch::wait(VulkanDevice& vulkanDevice) {
+        if (m_submitted) {
+            try {
+                auto result = vulkanDevice.logicalDevice().waitForFences(1, &m_vkFence, VK_TRUE, UINT64_MAX);
+            } catch (vk::SystemError err) {
+                std::string errMsg = "Failed to wait for upload batch: ";
+                GN_CORE_ERROR("{}{}", errMsg, err.what());
+                throw std::runtime_error(errMsg + err.what());
+            }
+            m_submitted = false;
+        }
+
+        for (VulkanBuffer& stagingBuffer : m_stagingBuffers) {
+            stagingBuffer.destroy(vulkanDevice);
+        }
+        m_stagingBuffers.clear();
+        m_stagedBytes = 0;
+
+        vulkanDevice.logicalDevice().freeCommandBuffers(m_vkCommandPool, m_vkCommandBuffer);
+        vulkanDevice.logicalDevice().destroyFence(m_vkFence);
+        m_vkCommandBuffer = nullptr;
+        m_vkFence = nullptr;
+
+        GN_CORE_INFO("Vulkan upload batch completed in {} submit(s).", m_submitCount);
+        m_submitCount = 0;
+    }
+
+    void VulkanUploadBatch::record(VulkanDevice& vulkanDevice) {
+        vk::CommandBufferBeginInfo beginInfo = {};
+        beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+
+        try {
+            m_vkCommandBuffer.begin(beginInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Unable to begin recording upload batch: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+    }
+
+    void VulkanUploadBatch::flush(VulkanDevice& vulkanDevice) {
+        submit(vulkanDevice);
+
+        try {
+            auto result = vulkanDevice.logicalDevice().waitForFences(1, &m_vkFence, VK_TRUE, UINT64_MAX);
+            result = vulkanDevice.logicalDevice().resetFences(1, &m_vkFence);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to flush upload batch: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+        m_submitted = false;
+
+        for (VulkanBuffer& stagingBuffer : m_stagingBuffers) {
+            stagingBuffer.destroy(vulkanDevice);
+        }
+        m_stagingBuffers.clear();
+        m_stagedBytes = 0;
+
+        m_vkCommandBuffer.reset();
+        record(vulkanDevice);
+    }
+}  // namespace Genesis
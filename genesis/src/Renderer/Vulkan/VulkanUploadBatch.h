@@ -0,0 +1,41 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    // Collects copies and layout transitions into one command buffer that goes to the graphics queue with a single
+    // submit and fence, instead of a queue round trip per resource. Staging buffers handed out by stage() live until
+    // the fence signals. If the staged bytes grow past a limit the batch flushes and carries on in a fresh command
+    // buffer, so always fetch commandBuffer() after stage().
+    class VulkanUploadBatch {
+        public:
+            VulkanUploadBatch();
+            ~VulkanUploadBatch();
+
+            VulkanUploadBatch(const VulkanUploadBatch&) = delete;
+            VulkanUploadBatch& operator=(const VulkanUploadBatch&) = delete;
+
+            vk::CommandBuffer const& commandBuffer() const { return m_vkCommandBuffer; }
+
+            void begin(VulkanDevice& vulkanDevice, vk::CommandPool commandPool);
+            // a mapped host visible buffer of at least size bytes, owned by the batch
+            VulkanBuffer stage(VulkanDevice& vulkanDevice, vk::DeviceSize size);
+            void submit(VulkanDevice& vulkanDevice);
+            // waits for the submitted work and releases the staging buffers and the command buffer
+            void wait(VulkanDevice& vulkanDevice);
+
+        private:
+            void record(VulkanDevice& vulkanDevice);
+            void flush(VulkanDevice& vulkanDevice);
+
+            vk::CommandPool m_vkCommandPool;
+            vk::CommandBuffer m_vkCommandBuffer;
+            vk::Fence m_vkFence;
+            bool m_submitted = false;
+            std::vector<VulkanBuffer> m_stagingBuffers;
+            vk::DeviceSize m_stagedBytes = 0;
+            uint32_t m_submitCount = 0;
+    };
+}  // namespace Genesis
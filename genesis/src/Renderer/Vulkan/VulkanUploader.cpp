@@ -0,0 +1,360 @@
+#include "VulkanUploader.h"
+
+#include <algorithm>
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    static constexpr vk::DeviceSize UPLOADER_RING_SIZE = 32 * 1024 * 1024;
+
+    VulkanUploader::VulkanUploader() {
+    }
+
+    VulkanUploader::~VulkanUploader() {
+    }
+
+    void VulkanUploader::init(VulkanDevice& vulkanDevice) {
+        m_graphicsFamily = vulkanDevice.graphicsQueueFamily();
+        m_timeline = vulkanDevice.timelineSemaphoreEnabled();
+        // the graphics queue can only wait on the transfer queue through a timeline (or per batch binary) semaphore,
+        // without timelines the uploads stay on the graphics queue and are tracked with fences
+        m_dedicatedTransfer = m_timeline && vulkanDevice.transferQueueFamily() != m_graphicsFamily;
+        m_transferFamily = m_dedicatedTransfer ? vulkanDevice.transferQueueFamily() : m_graphicsFamily;
+        m_vkQueue = m_dedicatedTransfer ? vulkanDevice.transferQueue() : vulkanDevice.graphicsQueue();
+
+        m_alignment = std::max<vk::DeviceSize>(16, vulkanDevice.physicalDeviceProperties().limits.optimalBufferCopyOffsetAlignment);
+        m_ringSize = UPLOADER_RING_SIZE;
+
+        vk::CommandPoolCreateInfo poolInfo = {};
+        poolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+        poolInfo.queueFamilyIndex = m_transferFamily;
+
+        try {
+            m_vkCommandPool = vulkanDevice.logicalDevice().createCommandPool(poolInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create upload command pool: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        if (m_timeline) {
+            vk::SemaphoreTypeCreateInfo typeInfo = {};
+            typeInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+            typeInfo.initialValue = 0;
+
+            vk::SemaphoreCreateInfo semaphoreInfo = {};
+            semaphoreInfo.pNext = &typeInfo;
+
+            try {
+                m_vkTimelineSemaphore = vulkanDevice.logicalDevice().createSemaphore(semaphoreInfo);
+            } catch (vk::SystemError err) {
+                std::string errMsg = "Failed to create upload timeline semaphore: ";
+                GN_CORE_ERROR("{}{}", errMsg, err.what());
+                throw std::runtime_error(errMsg + err.what());
+            }
+        }
+
+        m_ring.createBuffer(vulkanDevice,
+                            m_ringSize,
+                            vk::BufferUsageFlagBits::eTransferSrc,
+                            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                            MemoryCategory::STAGING);
+        m_ringData = static_cast<uint8_t*>(m_ring.mappedData());
+
+        GN_CORE_INFO("Vulkan uploader initialized with a {} MiB staging ring on the {} queue.",
+                     m_ringSize / (1024 * 1024),
+                     m_dedicatedTransfer ? "transfer" : "graphics");
+    }
+
+    UploadStaging VulkanUploader::stage(VulkanDevice& vulkanDevice, vk::DeviceSize size) {
+        // anything this large would block the ring for everyone else, it gets a buffer of its own
+        if (size > m_ringSize / 2) {
+            VulkanBuffer overflowBuffer;
+            overflowBuffer.createBuffer(vulkanDevice,
+                                        size,
+                                        vk::BufferUsageFlagBits::eTransferSrc,
+                                        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                        MemoryCategory::STAGING);
+            m_openOverflowBuffers.push_back(overflowBuffer);
+            return {overflowBuffer.buffer(), 0, overflowBuffer.mappedData()};
+        }
+
+        auto place = [this, size]() {
+            uint64_t start = (m_ringHead + m_alignment - 1) / m_alignment * m_alignment;
+            vk::DeviceSize ringOffset = start % m_ringSize;
+            // a range never wraps, skip the end of the ring instead
+            if (ringOffset + size > m_ringSize) {
+                start += m_ringSize - ringOffset;
+            }
+            return start;
+        };
+
+        uint64_t start = place();
+        if (start + size - m_ringTail > m_ringSize) {
+            retireSubmissions(vulkanDevice);
+            start = place();
+            if (start + size - m_ringTail > m_ringSize) {
+                return {m_ring.buffer(), 0, nullptr};
+            }
+        }
+
+        m_ringHead = start + size;
+        vk::DeviceSize ringOffset = start % m_ringSize;
+        return {m_ring.buffer(), ringOffset, m_ringData + ringOffset};
+    }
+
+    vk::CommandBuffer VulkanUploader::commandBuffer(VulkanDevice& vulkanDevice) {
+        if (m_openCommandBuffer) {
+            return m_openCommandBuffer;
+        }
+
+        if (!m_freeCommandBuffers.empty()) {
+            m_openCommandBuffer = m_freeCommandBuffers.back();
+            m_freeCommandBuffers.pop_back();
+        } else {
+            vk::CommandBufferAllocateInfo allocInfo = {};
+            allocInfo.commandPool = m_vkCommandPool;
+            allocInfo.level = vk::CommandBufferLevel::ePrimary;
+            allocInfo.commandBufferCount = 1;
+
+            try {
+                m_openCommandBuffer = vulkanDevice.logicalDevice().allocateCommandBuffers(allocInfo)[0];
+            } catch (vk::SystemError err) {
+                std::string errMsg = "Failed to allocate upload command buffer: ";
+                GN_CORE_ERROR("{}{}", errMsg, err.what());
+                throw std::runtime_error(errMsg + err.what());
+            }
+        }
+
+        vk::CommandBufferBeginInfo beginInfo = {};
+        beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+
+        try {
+            m_openCommandBuffer.begin(beginInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to begin upload command buffer: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        return m_openCommandBuffer;
+    }
+
+    void VulkanUploader::releaseImage(vk::Image image, uint32_t mipLevels) {
+        vk::ImageMemoryBarrier barrier = {};
+        barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+        barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = mipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+
+        if (!m_dedicatedTransfer) {
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+            m_openCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                                vk::PipelineStageFlagBits::eFragmentShader,
+                                                vk::DependencyFlags(),
+                                                nullptr,
+                                                nullptr,
+                                                barrier);
+            return;
+        }
+
+        // the release half of the ownership transfer, the transfer queue knows nothing about fragment shaders
+        barrier.srcQueueFamilyIndex = m_transferFamily;
+        barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        barrier.dstAccessMask = vk::AccessFlagBits::eNoneKHR;
+        m_openCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                            vk::PipelineStageFlagBits::eBottomOfPipe,
+                                            vk::DependencyFlags(),
+                                            nullptr,
+                                            nullptr,
+                                            barrier);
+
+        barrier.srcAccessMask = vk::AccessFlagBits::eNoneKHR;
+        barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+        m_openAcquires.push_back(barrier);
+    }
+
+    void VulkanUploader::submit(VulkanDevice& vulkanDevice) {
+        if (!m_openCommandBuffer) {
+            return;
+        }
+
+        try {
+            m_openCommandBuffer.end();
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to record upload command buffer: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        UploadSubmission submission = {};
+        submission.value = ++m_submittedValue;
+        submission.commandBuffer = m_openCommandBuffer;
+        submission.ringHead = m_ringHead;
+        submission.overflowBuffers = std::move(m_openOverflowBuffers);
+        m_openOverflowBuffers.clear();
+
+        vk::SubmitInfo submitInfo = {};
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &submission.commandBuffer;
+
+        vk::TimelineSemaphoreSubmitInfo timelineInfo = {};
+        if (m_timeline) {
+            timelineInfo.signalSemaphoreValueCount = 1;
+            timelineInfo.pSignalSemaphoreValues = &submission.value;
+            submitInfo.pNext = &timelineInfo;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &m_vkTimelineSemaphore;
+        }
+
+        try {
+            if (!m_timeline) {
+                if (!m_freeFences.empty()) {
+                    submission.fence = m_freeFences.back();
+                    m_freeFences.pop_back();
+                } else {
+                    submission.fence = vulkanDevice.logicalDevice().createFence(vk::FenceCreateInfo());
+                }
+            }
+            m_vkQueue.submit(submitInfo, submission.fence);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to submit uploads: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        for (const vk::ImageMemoryBarrier& barrier : m_openAcquires) {
+            m_pendingAcquires.push_back({submission.value, barrier});
+        }
+        m_openAcquires.clear();
+
+        m_submissions.push_back(std::move(submission));
+        m_openCommandBuffer = nullptr;
+    }
+
+    bool VulkanUploader::isComplete(VulkanDevice& vulkanDevice, uint64_t value) {
+        if (value > m_completedValue) {
+            retireSubmissions(vulkanDevice);
+        }
+        return value <= m_completedValue;
+    }
+
+    void VulkanUploader::recordAcquireBarriers(vk::CommandBuffer commandBuffer) {
+        // only batches already seen complete are acquired, so the matching wait never stalls the frame and anything
+        // committed this frame has been acquired before it is drawn
+        m_acquireWaitValue = 0;
+        std::vector<vk::ImageMemoryBarrier> barriers;
+        auto it = m_pendingAcquires.begin();
+        while (it != m_pendingAcquires.end() && it->value <= m_completedValue) {
+            barriers.push_back(it->barrier);
+            m_acquireWaitValue = std::max(m_acquireWaitValue, it->value);
+            ++it;
+        }
+        m_pendingAcquires.erase(m_pendingAcquires.begin(), it);
+
+        if (barriers.empty()) {
+            return;
+        }
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                      vk::PipelineStageFlagBits::eFragmentShader,
+                                      vk::DependencyFlags(),
+                                      nullptr,
+                                      nullptr,
+                                      barriers);
+    }
+
+    uint64_t VulkanUploader::completedValue(VulkanDevice& vulkanDevice) {
+        if (m_timeline) {
+            try {
+                return vulkanDevice.logicalDevice().getSemaphoreCounterValue(m_vkTimelineSemaphore);
+            } catch (vk::SystemError err) {
+                std::string errMsg = "Failed to read upload timeline: ";
+                GN_CORE_ERROR("{}{}", errMsg, err.what());
+                throw std::runtime_error(errMsg + err.what());
+            }
+        }
+
+        // batches complete in submission order on a single queue
+        uint64_t value = m_completedValue;
+        for (const UploadSubmission& submission : m_submissions) {
+            if (vulkanDevice.logicalDevice().getFenceStatus(submission.fence) != vk::Result::eSuccess) {
+                break;
+            }
+            value = submission.value;
+        }
+        return value;
+    }
+
+    void VulkanUploader::retireSubmissions(VulkanDevice& vulkanDevice) {
+        m_completedValue = std::max(m_completedValue, completedValue(vulkanDevice));
+
+        size_t retired = 0;
+        for (UploadSubmission& submission : m_submissions) {
+            if (submission.value > m_completedValue) {
+                break;
+            }
+            m_ringTail = submission.ringHead;
+            for (VulkanBuffer& overflowBuffer : submission.overflowBuffers) {
+                overflowBuffer.destroy(vulkanDevice);
+            }
+            m_freeCommandBuffers.push_back(submission.commandBuffer);
+            if (submission.fence) {
+                auto result = vulkanDevice.logicalDevice().resetFences(1, &submission.fence);
+                m_freeFences.push_back(submission.fence);
+            }
+            retired++;
+        }
+        m_submissions.erase(m_submissions.begin(), m_submissions.begin() + retired);
+    }
+
+    void VulkanUploader::waitIdle(VulkanDevice& vulkanDevice) {
+        if (m_submissions.empty()) {
+            return;
+        }
+
+        try {
+            if (m_timeline) {
+                vk::SemaphoreWaitInfo waitInfo = {};
+                waitInfo.semaphoreCount = 1;
+                waitInfo.pSemaphores = &m_vkTimelineSemaphore;
+                waitInfo.pValues = &m_submittedValue;
+                auto result = vulkanDevice.logicalDevice().waitSemaphores(waitInfo, UINT64_MAX);
+            } else {
+                auto result = vulkanDevice.logicalDevice().waitForFences(1, &m_submissions.back().fence, VK_TRUE, UINT64_MAX);
+            }
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to wait for uploads: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        retireSubmissions(vulkanDevice);
+    }
+
+    void VulkanUploader::shutdown(VulkanDevice& vulkanDevice) {
+        submit(vulkanDevice);
+        waitIdle(vulkanDevice);
+
+        m_pendingAcquires.clear();
+        for (vk::Fence fence : m_freeFences) {
+            vulkanDevice.logicalDevice().destroyFence(fence);
+        }
+        m_freeFences.clear();
+        // destroying the pool frees the recycled command buffers with it
+        m_freeCommandBuffers.clear();
+        vulkanDevice.logicalDevice().destroyCommandPool(m_vkCommandPool);
+        if (m_vkTimelineSemaphore) {
+            vulkanDevice.logicalDevice().destroySemaphore(m_vkTimelineSemaphore);
+        }
+        m_ring.destroy(vulkanDevice);
+        m_ringData = nullptr;
+    }
+}  // namespace Genesis
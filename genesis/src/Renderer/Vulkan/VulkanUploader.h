@@ -0,0 +1,93 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    struct UploadStaging {
+            vk::Buffer buffer;
+            vk::DeviceSize offset;
+            // null when the ring has no room left until earlier uploads retire
+            void* data;
+    };
+
+    struct UploadSubmission {
+            uint64_t value;
+            vk::CommandBuffer commandBuffer;
+            // only used when timeline semaphores are unavailable
+            vk::Fence fence;
+            // the ring head when the batch was submitted, everything before it is free once the batch completes
+            uint64_t ringHead;
+            std::vector<VulkanBuffer> overflowBuffers;
+    };
+
+    // Records uploads from a persistently mapped staging ring on the transfer queue, so streaming never blocks the
+    // graphics queue. Each submit signals the next value of a timeline semaphore and the ring space a batch used is
+    // reclaimed as soon as the GPU reaches its value. With a dedicated transfer family, images are released to the
+    // graphics family here and acquired at the start of the first frame recorded after their batch completed.
+    class VulkanUploader {
+        public:
+            VulkanUploader();
+            ~VulkanUploader();
+
+            VulkanUploader(const VulkanUploader&) = delete;
+            VulkanUploader& operator=(const VulkanUploader&) = delete;
+
+            vk::Semaphore const& timelineSemaphore() const { return m_vkTimelineSemaphore; }
+            // the value the open batch will signal when submitted
+            uint64_t pendingValue() const { return m_submittedValue + 1; }
+            // the value the graphics submit has to wait on for the acquires recorded by recordAcquireBarriers, 0 for none
+            uint64_t acquireWaitValue() const { return m_acquireWaitValue; }
+
+            void init(VulkanDevice& vulkanDevice);
+            // space for size bytes in the open batch, valid until that batch completes
+            UploadStaging stage(VulkanDevice& vulkanDevice, vk::DeviceSize size);
+            // the command buffer of the open batch, begun on first use
+            vk::CommandBuffer commandBuffer(VulkanDevice& vulkanDevice);
+            // moves an image written by the open batch from TransferDst to ShaderRead and hands it to the graphics family
+            void releaseImage(vk::Image image, uint32_t mipLevels);
+            void submit(VulkanDevice& vulkanDevice);
+            bool isComplete(VulkanDevice& vulkanDevice, uint64_t value);
+            void recordAcquireBarriers(vk::CommandBuffer commandBuffer);
+            void waitIdle(VulkanDevice& vulkanDevice);
+            void shutdown(VulkanDevice& vulkanDevice);
+
+        private:
+            struct PendingAcquire {
+                    uint64_t value;
+                    vk::ImageMemoryBarrier barrier;
+            };
+
+            void retireSubmissions(VulkanDevice& vulkanDevice);
+            uint64_t completedValue(VulkanDevice& vulkanDevice);
+
+            bool m_dedicatedTransfer = false;
+            bool m_timeline = false;
+            uint32_t m_graphicsFamily = 0;
+            uint32_t m_transferFamily = 0;
+            vk::Queue m_vkQueue;
+            vk::CommandPool m_vkCommandPool;
+            vk::Semaphore m_vkTimelineSemaphore;
+
+            VulkanBuffer m_ring;
+            uint8_t* m_ringData = nullptr;
+            vk::DeviceSize m_ringSize = 0;
+            vk::DeviceSize m_alignment = 16;
+            // monotonic byte counters, the ring offset is the counter modulo the ring size
+            uint64_t m_ringHead = 0;
+            uint64_t m_ringTail = 0;
+
+            vk::CommandBuffer m_openCommandBuffer;
+            std::vector<VulkanBuffer> m_openOverflowBuffers;
+            std::vector<vk::ImageMemoryBarrier> m_openAcquires;
+
+            std::vector<UploadSubmission> m_submissions;
+            std::vector<vk::CommandBuffer> m_freeCommandBuffers;
+            std::vector<vk::Fence> m_freeFences;
+            std::vector<PendingAcquire> m_pendingAcquires;
+            uint64_t m_submittedValue = 0;
+            uint64_t m_completedValue = 0;
+            uint64_t m_acquireWaitValue = 0;
+    };
+}  // namespace Genesis
@@ -1,99 +1,361 @@
 #include "VulkanVertexMenagerie.h"
 
+#include <algorithm>
+
 #include "Core/Logger.h"
 
 namespace Genesis {
+    static constexpr uint32_t MESH_VERTEX_FLOATS = 11;
+    static constexpr vk::DeviceSize MESH_VERTEX_SIZE = sizeof(float) * MESH_VERTEX_FLOATS;
+    static constexpr vk::DeviceSize MESH_INDEX_SIZE = sizeof(uint32_t);
+    static constexpr uint32_t MESH_POOL_VERTEX_CAPACITY = 256 * 1024;
+    static constexpr uint32_t MESH_POOL_INDEX_CAPACITY = 1024 * 1024;
+    // share of the space below the highest live range that may sit in holes before meshes get moved down
+    static constexpr float MESH_POOL_FRAGMENTATION_THRESHOLD = 0.25f;
+    // bytes compaction may copy per frame
+    static constexpr vk::DeviceSize MESH_POOL_COMPACTION_BYTES = 4 * 1024 * 1024;
+
+    // first fit, only ranges that end at or before limit are considered
+    static bool allocateRange(std::map<uint32_t, uint32_t>& ranges, uint32_t count, uint32_t limit, uint32_t& offset) {
+        if (count == 0) {
+            offset = 0;
+            return true;
+        }
+
+        for (auto it = ranges.begin(); it != ranges.end(); it++) {
+            if (static_cast<uint64_t>(it->first) + count > limit) {
+                break;
+            }
+            if (it->second >= count) {
+                offset = it->first;
+                uint32_t remaining = it->second - count;
+                ranges.erase(it);
+                if (remaining > 0) {
+                    ranges.emplace(offset + count, remaining);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void freeRange(std::map<uint32_t, uint32_t>& ranges, uint32_t offset, uint32_t count) {
+        if (count == 0) {
+            return;
+        }
+
+        auto next = ranges.lower_bound(offset);
+        if (next != ranges.end() && offset + count == next->first) {
+            count += next->second;
+            next = ranges.erase(next);
+        }
+        if (next != ranges.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset) {
+                previous->second += count;
+                return;
+            }
+        }
+        ranges.emplace(offset, count);
+    }
+
+    // adds the space past the old capacity to the free list and returns the new capacity
+    static uint32_t growRanges(std::map<uint32_t, uint32_t>& ranges, uint32_t capacity, uint32_t count) {
+        uint32_t newCapacity = std::max(capacity * 2, capacity + count);
+        freeRange(ranges, capacity, newCapacity - capacity);
+        return newCapacity;
+    }
+
+    // free space below the highest used element as a share of everything below it
+    static float fragmentation(const std::map<uint32_t, uint32_t>& ranges, uint32_t capacity) {
+        uint32_t freeCount = 0;
+        uint32_t tailCount = 0;
+        for (const auto& [offset, count] : ranges) {
+            freeCount += count;
+            if (offset + count == capacity) {
+                tailCount = count;
+            }
+        }
+
+        uint32_t highWater = capacity - tailCount;
+        if (highWater == 0) {
+            return 0.0f;
+        }
+        return static_cast<float>(freeCount - tailCount) / static_cast<float>(highWater);
+    }
+
     VulkanVertexMenagerie::VulkanVertexMenagerie() {
-        m_indexOffset = 0;
+        m_vertexCapacity = MESH_POOL_VERTEX_CAPACITY;
+        m_indexCapacity = MESH_POOL_INDEX_CAPACITY;
+        m_freeVertices.emplace(0, m_vertexCapacity);
+        m_freeIndices.emplace(0, m_indexCapacity);
     }
 
     VulkanVertexMenagerie::~VulkanVertexMenagerie() {
     }
 
-    void VulkanVertexMenagerie::consume(meshTypes type, std::vector<float> vertexData, std::vector<uint32_t> indexData) {
-        int vertexCount = static_cast<int>(vertexData.size() / 11);
-        int indexCount = static_cast<int>(indexData.size());
-        int lastIndex = static_cast<int>(m_indexLump.size());
+    uint32_t VulkanVertexMenagerie::addMesh(std::vector<float> vertexData, std::vector<uint32_t> indexData) {
+        MeshRange range = {};
+        range.vertexCount = static_cast<uint32_t>(vertexData.size() / MESH_VERTEX_FLOATS);
+        range.indexCount = static_cast<uint32_t>(indexData.size());
 
-        m_firstIndices.insert(std::make_pair(type, lastIndex));
-        m_indexCounts.insert(std::make_pair(type, indexCount));
+        while (!allocateRange(m_freeVertices, range.vertexCount, UINT32_MAX, range.firstVertex)) {
+            m_vertexCapacity = growRanges(m_freeVertices, m_vertexCapacity, range.vertexCount);
+        }
+        while (!allocateRange(m_freeIndices, range.indexCount, UINT32_MAX, range.firstIndex)) {
+            m_indexCapacity = growRanges(m_freeIndices, m_indexCapacity, range.indexCount);
+        }
+
+        range.boundingRadius = 0.0f;
+        for (size_t i = 0; i + 2 < vertexData.size(); i += MESH_VERTEX_FLOATS) {
+            range.boundingRadius = std::max(range.boundingRadius, glm::length(glm::vec3(vertexData[i], vertexData[i + 1], vertexData[i + 2])));
+        }
+
+        uint32_t mesh;
+        if (!m_freeMeshes.empty()) {
+            mesh = m_freeMeshes.back();
+            m_freeMeshes.pop_back();
+        } else {
+            mesh = static_cast<uint32_t>(m_meshes.size());
+            m_meshes.push_back({});
+        }
+        m_meshes[mesh] = {range, true, true};
+
+        m_pendingUploads.push_back({mesh, std::move(vertexData), std::move(indexData)});
 
-        for (float attribute : vertexData) {
-            m_vertexLump.push_back(attribute);
+        return mesh;
+    }
+
+    void VulkanVertexMenagerie::removeMesh(VulkanDevice& vulkanDevice, uint32_t mesh) {
+        MeshSlot& slot = m_meshes[mesh];
+        if (!slot.live) {
+            return;
         }
-        for (uint32_t index : indexData) {
-            m_indexLump.push_back(index + m_indexOffset);
+
+        if (slot.pending) {
+            std::erase_if(m_pendingUploads, [mesh](const PendingUpload& upload) { return upload.mesh == mesh; });
         }
 
-        m_indexOffset += vertexCount;
+        retire(vulkanDevice, slot.range.firstVertex, slot.range.vertexCount, slot.range.firstIndex, slot.range.indexCount);
+        slot.live = false;
+        slot.pending = false;
+        m_freeMeshes.push_back(mesh);
     }
 
-    void VulkanVertexMenagerie::finalize(VulkanDevice& vulkanDevice, VulkanCommandBuffer& vulkanCommandBuffer) {
-        // create staging buffer for vertices
-        uint32_t bufferSize = sizeof(float) * m_vertexLump.size();
+    void VulkanVertexMenagerie::finalize(VulkanDevice& vulkanDevice, VulkanUploadBatch& uploadBatch) {
+        // the batch releases the staging buffer once the copies have completed
+        vk::DeviceSize stagingSize = pendingBytes();
         VulkanBuffer stagingBuffer;
-        stagingBuffer.createBuffer(vulkanDevice,
-                                   bufferSize,
-                                   vk::BufferUsageFlagBits::eTransferSrc,
-                                   vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-
-        // fill staging buffer with vertex data
-        try {
-            void* data = vulkanDevice.logicalDevice().mapMemory(stagingBuffer.memory(), vk::DeviceSize(0), bufferSize, vk::MemoryMapFlags());
-            memcpy(data, m_vertexLump.data(), (size_t)bufferSize);
-            vulkanDevice.logicalDevice().unmapMemory(stagingBuffer.memory());
-        } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to copy memory: ";
-            GN_CORE_ERROR("{}{}", errMsg, err.what());
-            throw std::runtime_error(errMsg + err.what());
-        }
-
-        // create vertex buffer
-        m_vertexBuffer.createBuffer(vulkanDevice,
-                                    bufferSize,
-                                    vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
-                                    vk::MemoryPropertyFlagBits::eDeviceLocal);
-
-        // fill vertex buffer by copying from staging
-        m_vertexBuffer.copyBufferFrom(stagingBuffer.buffer(), bufferSize, vulkanDevice, vulkanCommandBuffer);
-
-        // destroy staging buffer
-        vulkanDevice.logicalDevice().destroyBuffer(stagingBuffer.buffer());
-        vulkanDevice.logicalDevice().freeMemory(stagingBuffer.memory());
-
-        // create staging buffer for indices
-        bufferSize = sizeof(uint32_t) * m_indexLump.size();
-        stagingBuffer.createBuffer(vulkanDevice,
-                                   bufferSize,
-                                   vk::BufferUsageFlagBits::eTransferSrc,
-                                   vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-
-        // fill staging buffer with index data
-        try {
-            void* data = vulkanDevice.logicalDevice().mapMemory(stagingBuffer.memory(), vk::DeviceSize(0), bufferSize, vk::MemoryMapFlags());
-            memcpy(data, m_indexLump.data(), (size_t)bufferSize);
-            vulkanDevice.logicalDevice().unmapMemory(stagingBuffer.memory());
-        } catch (vk::SystemError err) {
-            std::string errMsg = "Failed to copy memory: ";
-            GN_CORE_ERROR("{}{}", errMsg, err.what());
-            throw std::runtime_error(errMsg + err.what());
-        }
-
-        // create index buffer
-        m_indexBuffer.createBuffer(vulkanDevice,
-                                   bufferSize,
-                                   vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
-                                   vk::MemoryPropertyFlagBits::eDeviceLocal);
-
-        // fill index buffer by copying from staging
-        m_indexBuffer.copyBufferFrom(stagingBuffer.buffer(), bufferSize, vulkanDevice, vulkanCommandBuffer);
-
-        // destroy staging buffer
-        vulkanDevice.logicalDevice().destroyBuffer(stagingBuffer.buffer());
-        vulkanDevice.logicalDevice().freeMemory(stagingBuffer.memory());
-
-        m_vertexLump.clear();
+        if (stagingSize > 0) {
+            stagingBuffer = uploadBatch.stage(vulkanDevice, stagingSize);
+        }
+
+        recordGrowth(vulkanDevice, uploadBatch.commandBuffer());
+        recordUploads(uploadBatch.commandBuffer(), stagingBuffer.buffer(), static_cast<uint8_t*>(stagingBuffer.mappedData()));
 
         GN_CORE_INFO("Vulkan vertex buffer created.");
     }
+
+    void VulkanVertexMenagerie::recordUpdates(VulkanDevice& vulkanDevice, vk::CommandBuffer commandBuffer) {
+        bool growing = m_vertexCapacity > m_vertexBufferCapacity || m_indexCapacity > m_indexBufferCapacity;
+        bool compacting = fragmentation(m_freeVertices, m_vertexCapacity) > MESH_POOL_FRAGMENTATION_THRESHOLD ||
+                          fragmentation(m_freeIndices, m_indexCapacity) > MESH_POOL_FRAGMENTATION_THRESHOLD;
+        if (!growing && !compacting && m_pendingUploads.empty()) {
+            return;
+        }
+
+        vk::MemoryBarrier transferBarrier = {};
+        transferBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        transferBarrier.dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite;
+
+        if (growing || compacting) {
+            // both read back what earlier frames copied in
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), transferBarrier, nullptr, nullptr);
+        }
+        if (growing) {
+            recordGrowth(vulkanDevice, commandBuffer);
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), transferBarrier, nullptr, nullptr);
+        }
+        if (compacting) {
+            vk::DeviceSize movedBytes = recordCompaction(vulkanDevice, commandBuffer);
+            if (movedBytes > 0) {
+                GN_CORE_TRACE("Mesh pool moved {} KiB to close holes.", movedBytes / 1024);
+            }
+        }
+
+        // uploads and moves write disjoint ranges, so they need no barrier between them
+        vk::DeviceSize stagingSize = pendingBytes();
+        if (stagingSize > 0) {
+            VulkanBuffer stagingBuffer;
+            stagingBuffer.createBuffer(vulkanDevice,
+                                       stagingSize,
+                                       vk::BufferUsageFlagBits::eTransferSrc,
+                                       vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                       MemoryCategory::STAGING);
+            recordUploads(commandBuffer, stagingBuffer.buffer(), static_cast<uint8_t*>(stagingBuffer.mappedData()));
+            stagingBuffer.destroyDeferred(vulkanDevice);
+        }
+
+        vk::MemoryBarrier barrier = {};
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eVertexInput, vk::DependencyFlags(), barrier, nullptr, nullptr);
+    }
+
+    void VulkanVertexMenagerie::destroy(VulkanDevice& vulkanDevice) {
+        m_vertexBuffer.destroy(vulkanDevice);
+        m_indexBuffer.destroy(vulkanDevice);
+        m_vertexBufferCapacity = 0;
+        m_indexBufferCapacity = 0;
+    }
+
+    void VulkanVertexMenagerie::retire(VulkanDevice& vulkanDevice, uint32_t firstVertex, uint32_t vertexCount, uint32_t firstIndex, uint32_t indexCount) {
+        vulkanDevice.deletionQueue().defer([this, firstVertex, vertexCount, firstIndex, indexCount]() {
+            freeRange(m_freeVertices, firstVertex, vertexCount);
+            freeRange(m_freeIndices, firstIndex, indexCount);
+        });
+    }
+
+    void VulkanVertexMenagerie::recordGrowth(VulkanDevice& vulkanDevice, vk::CommandBuffer commandBuffer) {
+        if (m_vertexCapacity > m_vertexBufferCapacity) {
+            VulkanBuffer vertexBuffer;
+            vertexBuffer.createBuffer(vulkanDevice,
+                                      MESH_VERTEX_SIZE * m_vertexCapacity,
+                                      vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
+                                      vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                      MemoryCategory::MESHES);
+
+            // offsets stay the same, so carrying the old contents over is a single copy
+            if (m_vertexBufferCapacity > 0) {
+                vk::BufferCopy copyRegion = {};
+                copyRegion.size = MESH_VERTEX_SIZE * m_vertexBufferCapacity;
+                commandBuffer.copyBuffer(m_vertexBuffer.buffer(), vertexBuffer.buffer(), copyRegion);
+                m_vertexBuffer.destroyDeferred(vulkanDevice);
+                GN_CORE_TRACE("Mesh pool vertex buffer grew to {} vertices.", m_vertexCapacity);
+            }
+
+            m_vertexBuffer = vertexBuffer;
+            m_vertexBufferCapacity = m_vertexCapacity;
+        }
+
+        if (m_indexCapacity > m_indexBufferCapacity) {
+            VulkanBuffer indexBuffer;
+            indexBuffer.createBuffer(vulkanDevice,
+                                     MESH_INDEX_SIZE * m_indexCapacity,
+                                     vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
+                                     vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                     MemoryCategory::MESHES);
+
+            if (m_indexBufferCapacity > 0) {
+                vk::BufferCopy copyRegion = {};
+                copyRegion.size = MESH_INDEX_SIZE * m_indexBufferCapacity;
+                commandBuffer.copyBuffer(m_indexBuffer.buffer(), indexBuffer.buffer(), copyRegion);
+                m_indexBuffer.destroyDeferred(vulkanDevice);
+                GN_CORE_TRACE("Mesh pool index buffer grew to {} indices.", m_indexCapacity);
+            }
+
+            m_indexBuffer = indexBuffer;
+            m_indexBufferCapacity = m_indexCapacity;
+        }
+    }
+
+    vk::DeviceSize VulkanVertexMenagerie::recordCompaction(VulkanDevice& vulkanDevice, vk::CommandBuffer commandBuffer) {
+        vk::DeviceSize movedBytes = 0;
+
+        // highest ranges first, each moves into the lowest hole that ends before it starts
+        std::vector<uint32_t> order;
+        for (uint32_t mesh = 0; mesh < m_meshes.size(); mesh++) {
+            if (m_meshes[mesh].live && !m_meshes[mesh].pending) {
+                order.push_back(mesh);
+            }
+        }
+
+        if (fragmentation(m_freeVertices, m_vertexCapacity) > MESH_POOL_FRAGMENTATION_THRESHOLD) {
+            std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return m_meshes[a].range.firstVertex > m_meshes[b].range.firstVertex; });
+            for (uint32_t mesh : order) {
+                MeshRange& range = m_meshes[mesh].range;
+                uint32_t firstVertex;
+                if (movedBytes >= MESH_POOL_COMPACTION_BYTES) {
+                    break;
+                }
+                if (range.vertexCount == 0 || !allocateRange(m_freeVertices, range.vertexCount, range.firstVertex, firstVertex)) {
+                    continue;
+                }
+
+                vk::BufferCopy copyRegion = {};
+                copyRegion.srcOffset = MESH_VERTEX_SIZE * range.firstVertex;
+                copyRegion.dstOffset = MESH_VERTEX_SIZE * firstVertex;
+                copyRegion.size = MESH_VERTEX_SIZE * range.vertexCount;
+                commandBuffer.copyBuffer(m_vertexBuffer.buffer(), m_vertexBuffer.buffer(), copyRegion);
+
+                retire(vulkanDevice, range.firstVertex, range.vertexCount, 0, 0);
+                range.firstVertex = firstVertex;
+                movedBytes += copyRegion.size;
+            }
+        }
+
+        if (fragmentation(m_freeIndices, m_indexCapacity) > MESH_POOL_FRAGMENTATION_THRESHOLD) {
+            std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return m_meshes[a].range.firstIndex > m_meshes[b].range.firstIndex; });
+            for (uint32_t mesh : order) {
+                MeshRange& range = m_meshes[mesh].range;
+                uint32_t firstIndex;
+                if (movedBytes >= MESH_POOL_COMPACTION_BYTES) {
+                    break;
+                }
+                if (range.indexCount == 0 || !allocateRange(m_freeIndices, range.indexCount, range.firstIndex, firstIndex)) {
+                    continue;
+                }
+
+                vk::BufferCopy copyRegion = {};
+                copyRegion.srcOffset = MESH_INDEX_SIZE * range.firstIndex;
+                copyRegion.dstOffset = MESH_INDEX_SIZE * firstIndex;
+                copyRegion.size = MESH_INDEX_SIZE * range.indexCount;
+                commandBuffer.copyBuffer(m_indexBuffer.buffer(), m_indexBuffer.buffer(), copyRegion);
+
+                retire(vulkanDevice, 0, 0, range.firstIndex, range.indexCount);
+                range.firstIndex = firstIndex;
+                movedBytes += copyRegion.size;
+            }
+        }
+
+        return movedBytes;
+    }
+
+    void VulkanVertexMenagerie::recordUploads(vk::CommandBuffer commandBuffer, vk::Buffer stagingBuffer, uint8_t* stagingData) {
+        vk::DeviceSize stagingOffset = 0;
+        for (PendingUpload& upload : m_pendingUploads) {
+            MeshSlot& slot = m_meshes[upload.mesh];
+
+            vk::BufferCopy copyRegion = {};
+            copyRegion.size = MESH_VERTEX_SIZE * slot.range.vertexCount;
+            if (copyRegion.size > 0) {
+                memcpy(stagingData + stagingOffset, upload.vertexData.data(), static_cast<size_t>(copyRegion.size));
+                copyRegion.srcOffset = stagingOffset;
+                copyRegion.dstOffset = MESH_VERTEX_SIZE * slot.range.firstVertex;
+                commandBuffer.copyBuffer(stagingBuffer, m_vertexBuffer.buffer(), copyRegion);
+                stagingOffset += copyRegion.size;
+            }
+
+            copyRegion.size = MESH_INDEX_SIZE * slot.range.indexCount;
+            if (copyRegion.size > 0) {
+                memcpy(stagingData + stagingOffset, upload.indexData.data(), static_cast<size_t>(copyRegion.size));
+                copyRegion.srcOffset = stagingOffset;
+                copyRegion.dstOffset = MESH_INDEX_SIZE * slot.range.firstIndex;
+                commandBuffer.copyBuffer(stagingBuffer, m_indexBuffer.buffer(), copyRegion);
+                stagingOffset += copyRegion.size;
+            }
+
+            slot.pending = false;
+        }
+        m_pendingUploads.clear();
+    }
+
+    vk::DeviceSize VulkanVertexMenagerie::pendingBytes() const {
+        vk::DeviceSize size = 0;
+        for (const PendingUpload& upload : m_pendingUploads) {
+            const MeshRange& range = m_meshes[upload.mesh].range;
+            size += MESH_VERTEX_SIZE * range.vertexCount + MESH_INDEX_SIZE * range.indexCount;
+        }
+        return size;
+    }
 }  // namespace Genesis
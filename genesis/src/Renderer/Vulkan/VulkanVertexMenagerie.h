@@ -1,30 +1,82 @@
 #pragma once
 
+#include <map>
+
 #include "Core/Scene.h"
 #include "VulkanBuffer.h"
-#include "VulkanCommandBuffer.h"
 #include "VulkanDevice.h"
+#include "VulkanUploadBatch.h"
 
 namespace Genesis {
+    // where a mesh lives in the shared buffers, indices are relative to firstVertex which goes in as the vertexOffset
+    struct MeshRange {
+            uint32_t firstVertex;
+            uint32_t vertexCount;
+            uint32_t firstIndex;
+            uint32_t indexCount;
+            // bounding sphere around the model origin, used to estimate on-screen size
+            float boundingRadius;
+    };
+
+    // Pool of meshes sharing one device local vertex buffer and one index buffer. Vertex and index ranges come from
+    // first fit free lists, so meshes can be added and removed while the renderer runs. Indices are stored as the
+    // model has them and rebased at draw time through vertexOffset, which lets a mesh move without rewriting them.
+    // A pool that runs out of space grows into a larger buffer; once the holes below the highest live range make up
+    // too much of it, recordUpdates moves a few meshes down per frame with GPU copies. Ranges given up by removeMesh
+    // or by a move go back to the free lists through the deletion queue, once the frame that gave them up retired.
     class VulkanVertexMenagerie {
         public:
             VulkanVertexMenagerie();
             ~VulkanVertexMenagerie();
 
+            VulkanVertexMenagerie(const VulkanVertexMenagerie&) = delete;
+            VulkanVertexMenagerie& operator=(const VulkanVertexMenagerie&) = delete;
+
             VulkanBuffer const& vertexBuffer() const { return m_vertexBuffer; }
             VulkanBuffer const& indexBuffer() const { return m_indexBuffer; }
+            MeshRange const& range(uint32_t mesh) const { return m_meshes[mesh].range; }
 
-            void consume(meshTypes type, std::vector<float> vertexData, std::vector<uint32_t> indexData);
-            void finalize(VulkanDevice& vulkanDevice, VulkanCommandBuffer& vulkanCommandBuffer);
-
-            std::unordered_map<meshTypes, int> m_firstIndices;
-            std::unordered_map<meshTypes, int> m_indexCounts;
+            // the mesh is uploaded by finalize or, after that, by the next recordUpdates
+            uint32_t addMesh(std::vector<float> vertexData, std::vector<uint32_t> indexData);
+            void removeMesh(VulkanDevice& vulkanDevice, uint32_t mesh);
+            void finalize(VulkanDevice& vulkanDevice, VulkanUploadBatch& uploadBatch);
+            // records growth, compaction and pending uploads, outside of a render pass and before the draws
+            void recordUpdates(VulkanDevice& vulkanDevice, vk::CommandBuffer commandBuffer);
+            void destroy(VulkanDevice& vulkanDevice);
 
         private:
+            struct MeshSlot {
+                    MeshRange range;
+                    bool live;
+                    // allocated but not copied to the GPU yet, compaction leaves these alone
+                    bool pending;
+            };
+
+            struct PendingUpload {
+                    uint32_t mesh;
+                    std::vector<float> vertexData;
+                    std::vector<uint32_t> indexData;
+            };
+
+            void retire(VulkanDevice& vulkanDevice, uint32_t firstVertex, uint32_t vertexCount, uint32_t firstIndex, uint32_t indexCount);
+            void recordGrowth(VulkanDevice& vulkanDevice, vk::CommandBuffer commandBuffer);
+            vk::DeviceSize recordCompaction(VulkanDevice& vulkanDevice, vk::CommandBuffer commandBuffer);
+            void recordUploads(vk::CommandBuffer commandBuffer, vk::Buffer stagingBuffer, uint8_t* stagingData);
+            vk::DeviceSize pendingBytes() const;
+
             VulkanBuffer m_vertexBuffer;
             VulkanBuffer m_indexBuffer;
-            int m_indexOffset;
-            std::vector<float> m_vertexLump;
-            std::vector<uint32_t> m_indexLump;
+            // capacities in vertices and indices, the buffers catch up with them in recordUpdates
+            uint32_t m_vertexCapacity;
+            uint32_t m_indexCapacity;
+            uint32_t m_vertexBufferCapacity = 0;
+            uint32_t m_indexBufferCapacity = 0;
+            // offset -> count of every free range
+            std::map<uint32_t, uint32_t> m_freeVertices;
+            std::map<uint32_t, uint32_t> m_freeIndices;
+
+            std::vector<MeshSlot> m_meshes;
+            std::vector<uint32_t> m_freeMeshes;
+            std::vector<PendingUpload> m_pendingUploads;
     };
 }  // namespace Genesis
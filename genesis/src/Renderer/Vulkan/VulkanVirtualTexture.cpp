@@ -0,0 +1,659 @@
+#include "VulkanVirtualTexture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Core/Logger.h"
+#include "Resources/TextureDecoder.h"
+
+namespace Genesis {
+    static constexpr uint32_t VIRTUAL_PAGE_SIZE = 128;
+    static constexpr uint32_t VIRTUAL_PAGE_BORDER = 4;
+    static constexpr uint32_t VIRTUAL_TILE_SIZE = VIRTUAL_PAGE_SIZE + 2 * VIRTUAL_PAGE_BORDER;
+    static constexpr vk::DeviceSize VIRTUAL_TILE_BYTES = VIRTUAL_TILE_SIZE * VIRTUAL_TILE_SIZE * 4;
+    // pages along each side of mip 0, 256 pages of 128 texels make a 32k x 32k virtual texture
+    static constexpr uint32_t VIRTUAL_PAGE_COUNT = 256;
+    // tiles along each side of the physical cache, this is the only thing that decides VRAM use
+    static constexpr uint32_t VIRTUAL_CACHE_TILES = 16;
+    // the coarsest mips always stay resident so every lookup has something to fall back to
+    static constexpr uint32_t VIRTUAL_PINNED_MIPS = 3;
+    static constexpr uint32_t VIRTUAL_PAGES_PER_UPLOAD = 16;
+    static constexpr uint32_t VIRTUAL_REQUESTS_PER_FRAME = 64;
+
+    static uint32_t makePageKey(uint32_t mip, uint32_t x, uint32_t y) {
+        return (mip << 24) | (y << 12) | x;
+    }
+
+    VulkanVirtualTexture::VulkanVirtualTexture() {
+    }
+
+    VulkanVirtualTexture::~VulkanVirtualTexture() {
+    }
+
+    void VulkanVirtualTexture::createDescriptorSetLayout(VulkanDevice& vulkanDevice) {
+        vk::DescriptorSetLayoutBinding cacheBinding = {};
+        cacheBinding.binding = 0;
+        cacheBinding.descriptorCount = 1;
+        cacheBinding.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+        cacheBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
+
+        vk::DescriptorSetLayoutBinding pageTableBinding = {};
+        pageTableBinding.binding = 1;
+        pageTableBinding.descriptorCount = 1;
+        pageTableBinding.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+        pageTableBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
+
+        vk::DescriptorSetLayoutBinding feedbackBinding = {};
+        feedbackBinding.binding = 2;
+        feedbackBinding.descriptorCount = 1;
+        feedbackBinding.descriptorType = vk::DescriptorType::eStorageBuffer;
+        feedbackBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
+
+        std::array<vk::DescriptorSetLayoutBinding, 3> bindings = {cacheBinding, pageTableBinding, feedbackBinding};
+        vk::DescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.flags = vk::DescriptorSetLayoutCreateFlags();
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        try {
+            m_vkDescriptorSetLayout = vulkanDevice.logicalDevice().createDescriptorSetLayout(layoutInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create virtual texture descriptor set layout: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+    }
+
+    void VulkanVirtualTexture::init(VulkanDevice& vulkanDevice,
+                                    vk::CommandPool commandPool,
+                                    ThreadPool& threadPool,
+                                    std::string filename,
+                                    uint32_t frameCount) {
+        m_vkCommandPool = commandPool;
+        m_threadPool = &threadPool;
+        m_enabled = vulkanDevice.enabledFeatures().fragmentStoresAndAtomics;
+        if (!m_enabled) {
+            GN_CORE_WARNING("Device does not support fragment shader stores, virtual texturing disabled.");
+        }
+
+        // decoding and filtering the source is the slow part, a worker does it while the GPU resources are created
+        TextureDecoder sourceDecoder(threadPool);
+        sourceDecoder.submit(filename);
+
+        m_mipCount = static_cast<uint32_t>(std::log2(VIRTUAL_PAGE_COUNT)) + 1;
+        m_pageOffsets.resize(m_mipCount);
+        m_totalPages = 0;
+        for (uint32_t mip = 0; mip < m_mipCount; mip++) {
+            uint32_t pages = VIRTUAL_PAGE_COUNT >> mip;
+            m_pageOffsets[mip] = m_totalPages;
+            m_totalPages += pages * pages;
+        }
+        m_pageTableData.resize(m_totalPages, 0);
+
+        m_tiles.resize(VIRTUAL_CACHE_TILES * VIRTUAL_CACHE_TILES);
+        for (uint32_t i = 0; i < m_tiles.size(); i++) {
+            m_tiles[i] = {};
+            m_freeTiles.push_back(static_cast<uint32_t>(m_tiles.size()) - 1 - i);
+        }
+
+        createImages(vulkanDevice);
+        createSamplers(vulkanDevice);
+        createFrameResources(vulkanDevice, frameCount);
+        createDescriptorSets(vulkanDevice);
+        m_source = sourceDecoder.next();
+        loadPinnedPages(vulkanDevice);
+
+        GN_CORE_INFO("Vulkan virtual texture created: {}x{} virtual texels backed by a {}x{} page cache.",
+                     VIRTUAL_PAGE_COUNT * VIRTUAL_PAGE_SIZE,
+                     VIRTUAL_PAGE_COUNT * VIRTUAL_PAGE_SIZE,
+                     VIRTUAL_CACHE_TILES * VIRTUAL_TILE_SIZE,
+                     VIRTUAL_CACHE_TILES * VIRTUAL_TILE_SIZE);
+    }
+
+    void VulkanVirtualTexture::createImages(VulkanDevice& vulkanDevice) {
+        m_pageCache.createImage(vulkanDevice,
+                                VIRTUAL_CACHE_TILES * VIRTUAL_TILE_SIZE,
+                                VIRTUAL_CACHE_TILES * VIRTUAL_TILE_SIZE,
+                                1,
+                                vk::SampleCountFlagBits::e1,
+                                vk::Format::eR8G8B8A8Srgb,
+                                vk::ImageTiling::eOptimal,
+                                vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+                                vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                MemoryCategory::TEXTURES);
+        m_pageCache.createImageView(vulkanDevice, m_pageCache.image(), vk::Format::eR8G8B8A8Srgb, vk::ImageAspectFlagBits::eColor, 1);
+
+        m_pageTable.createImage(vulkanDevice,
+                                VIRTUAL_PAGE_COUNT,
+                                VIRTUAL_PAGE_COUNT,
+                                m_mipCount,
+                                vk::SampleCountFlagBits::e1,
+                                vk::Format::eR8G8B8A8Uint,
+                                vk::ImageTiling::eOptimal,
+                                vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+                                vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                MemoryCategory::TEXTURES);
+        m_pageTable.createImageView(vulkanDevice, m_pageTable.image(), vk::Format::eR8G8B8A8Uint, vk::ImageAspectFlagBits::eColor, m_mipCount);
+
+        vk::DeviceSize stagingSize = VIRTUAL_PAGES_PER_UPLOAD * VIRTUAL_TILE_BYTES + m_totalPages * sizeof(uint32_t);
+        m_stagingBuffer.createBuffer(vulkanDevice,
+                                     stagingSize,
+                                     vk::BufferUsageFlagBits::eTransferSrc,
+                                     vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                     MemoryCategory::STAGING);
+
+        m_stagingData = static_cast<uint8_t*>(m_stagingBuffer.mappedData());
+
+        vk::CommandBufferAllocateInfo allocInfo = {};
+        allocInfo.commandPool = m_vkCommandPool;
+        allocInfo.level = vk::CommandBufferLevel::ePrimary;
+        allocInfo.commandBufferCount = 1;
+
+        try {
+            m_vkUploadCommandBuffer = vulkanDevice.logicalDevice().allocateCommandBuffers(allocInfo)[0];
+            m_vkUploadFence = vulkanDevice.logicalDevice().createFence(vk::FenceCreateInfo());
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to create virtual texture upload resources: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+    }
+
+    void VulkanVirtualTexture::createSamplers(VulkanDevice& vulkanDevice) {
+        vk::SamplerCreateInfo samplerInfo = {};
+        samplerInfo.flags = vk::SamplerCreateFlags();
+        samplerInfo.minFilter = vk::Filter::eLinear;
+        samplerInfo.magFilter = vk::Filter::eLinear;
+        samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+        samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+        samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;
+        samplerInfo.anisotropyEnable = false;
+        samplerInfo.maxAnisotropy = 1.0f;
+        samplerInfo.borderColor = vk::BorderColor::eIntOpaqueBlack;
+        samplerInfo.unnormalizedCoordinates = false;
+        samplerInfo.compareEnable = false;
+        samplerInfo.compareOp = vk::CompareOp::eAlways;
+        samplerInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
+        samplerInfo.mipLodBias = 0.0f;
+        samplerInfo.minLod = 0.0f;
+        samplerInfo.maxLod = 0.0f;
+
+        m_vkCacheSampler = vulkanDevice.samplerCache().getSampler(samplerInfo);
+
+        // integer page table entries can only be point sampled
+        samplerInfo.minFilter = vk::Filter::eNearest;
+        samplerInfo.magFilter = vk::Filter::eNearest;
+        samplerInfo.maxLod = static_cast<float>(m_mipCount);
+        m_vkPageTableSampler = vulkanDevice.samplerCache().getSampler(samplerInfo);
+    }
+
+    void VulkanVirtualTexture::createFrameResources(VulkanDevice& vulkanDevice, uint32_t frameCount) {
+        // feedback is read back on the CPU every frame, prefer cached memory when the device has it
+        vk::MemoryPropertyFlags feedbackProperties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+        vk::PhysicalDeviceMemoryProperties memProperties = vulkanDevice.physicalDevice().getMemoryProperties();
+        for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+            vk::MemoryPropertyFlags flags = memProperties.memoryTypes[i].propertyFlags;
+            if ((flags & (feedbackProperties | vk::MemoryPropertyFlagBits::eHostCached)) == (feedbackProperties | vk::MemoryPropertyFlagBits::eHostCached)) {
+                feedbackProperties |= vk::MemoryPropertyFlagBits::eHostCached;
+                break;
+            }
+        }
+
+        vk::DeviceSize feedbackSize = m_totalPages * sizeof(uint32_t);
+        m_frames.resize(frameCount);
+        for (VirtualTextureFrame& frame : m_frames) {
+            frame.feedbackBuffer.createBuffer(vulkanDevice,
+                                              feedbackSize,
+                                              vk::BufferUsageFlagBits::eStorageBuffer,
+                                              feedbackProperties,
+                                              MemoryCategory::FRAME_RESOURCES);
+            frame.feedbackData = static_cast<uint32_t*>(frame.feedbackBuffer.mappedData());
+            memset(frame.feedbackData, 0, static_cast<size_t>(feedbackSize));
+        }
+    }
+
+    void VulkanVirtualTexture::createDescriptorSets(VulkanDevice& vulkanDevice) {
+        std::array<vk::DescriptorPoolSize, 2> poolSizes{};
+        poolSizes[0].type = vk::DescriptorType::eCombinedImageSampler;
+        poolSizes[0].descriptorCount = static_cast<uint32_t>(m_frames.size()) * 2;
+        poolSizes[1].type = vk::DescriptorType::eStorageBuffer;
+        poolSizes[1].descriptorCount = static_cast<uint32_t>(m_frames.size());
+
+        vk::DescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.flags = vk::DescriptorPoolCreateFlags();
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = static_cast<uint32_t>(m_frames.size());
+
+        std::vector<vk::DescriptorSetLayout> layouts(m_frames.size(), m_vkDescriptorSetLayout);
+        vk::DescriptorSetAllocateInfo allocInfo = {};
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(m_frames.size());
+        allocInfo.pSetLayouts = layouts.data();
+
+        std::vector<vk::DescriptorSet> descriptorSets;
+        try {
+            m_vkDescriptorPool = vulkanDevice.logicalDevice().createDescriptorPool(poolInfo);
+            allocInfo.descriptorPool = m_vkDescriptorPool;
+            descriptorSets = vulkanDevice.logicalDevice().allocateDescriptorSets(allocInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to allocate virtual texture descriptor sets: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        vk::DescriptorImageInfo cacheDescriptor;
+        cacheDescriptor.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        cacheDescriptor.imageView = m_pageCache.imageView();
+        cacheDescriptor.sampler = m_vkCacheSampler;
+
+        vk::DescriptorImageInfo pageTableDescriptor;
+        pageTableDescriptor.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        pageTableDescriptor.imageView = m_pageTable.imageView();
+        pageTableDescriptor.sampler = m_vkPageTableSampler;
+
+        for (size_t i = 0; i < m_frames.size(); i++) {
+            m_frames[i].descriptorSet = descriptorSets[i];
+
+            vk::DescriptorBufferInfo feedbackDescriptor;
+            feedbackDescriptor.buffer = m_frames[i].feedbackBuffer.buffer();
+            feedbackDescriptor.offset = 0;
+            feedbackDescriptor.range = m_totalPages * sizeof(uint32_t);
+
+            std::array<vk::WriteDescriptorSet, 3> descriptorWrites{};
+            descriptorWrites[0].dstSet = m_frames[i].descriptorSet;
+            descriptorWrites[0].dstBinding = 0;
+            descriptorWrites[0].descriptorType = vk::DescriptorType::eCombinedImageSampler;
+            descriptorWrites[0].descriptorCount = 1;
+            descriptorWrites[0].pImageInfo = &cacheDescriptor;
+
+            descriptorWrites[1].dstSet = m_frames[i].descriptorSet;
+            descriptorWrites[1].dstBinding = 1;
+            descriptorWrites[1].descriptorType = vk::DescriptorType::eCombinedImageSampler;
+            descriptorWrites[1].descriptorCount = 1;
+            descriptorWrites[1].pImageInfo = &pageTableDescriptor;
+
+            descriptorWrites[2].dstSet = m_frames[i].descriptorSet;
+            descriptorWrites[2].dstBinding = 2;
+            descriptorWrites[2].descriptorType = vk::DescriptorType::eStorageBuffer;
+            descriptorWrites[2].descriptorCount = 1;
+            descriptorWrites[2].pBufferInfo = &feedbackDescriptor;
+
+            vulkanDevice.logicalDevice().updateDescriptorSets(descriptorWrites, nullptr);
+        }
+    }
+
+    void VulkanVirtualTexture::loadPinnedPages(VulkanDevice& vulkanDevice) {
+        uint32_t firstPinnedMip = m_mipCount - std::min(VIRTUAL_PINNED_MIPS, m_mipCount);
+        std::ptrdiff_t pinnedPages = 0;
+        for (uint32_t mip = firstPinnedMip; mip < m_mipCount; mip++) {
+            uint32_t pages = VIRTUAL_PAGE_COUNT >> mip;
+            pinnedPages += pages * pages;
+        }
+
+        // only these reads are waited for, the pool may be busy with other work
+        std::latch loaded(pinnedPages);
+        for (uint32_t mip = firstPinnedMip; mip < m_mipCount; mip++) {
+            uint32_t pages = VIRTUAL_PAGE_COUNT >> mip;
+            for (uint32_t y = 0; y < pages; y++) {
+                for (uint32_t x = 0; x < pages; x++) {
+                    requestPage(makePageKey(mip, x, y), &loaded);
+                }
+            }
+        }
+        loaded.wait();
+
+        std::vector<VirtualTextureLoadedPage> pages;
+        {
+            std::lock_guard<std::mutex> lock(m_loadedMutex);
+            pages = std::move(m_loadedPages);
+            m_loadedPages.clear();
+        }
+
+        // pinned pages may need more than one batch, the first one also moves the images out of the undefined layout
+        bool initialUpload = true;
+        while (!pages.empty()) {
+            size_t count = std::min<size_t>(pages.size(), VIRTUAL_PAGES_PER_UPLOAD);
+            std::vector<VirtualTextureLoadedPage> batch(std::make_move_iterator(pages.begin()), std::make_move_iterator(pages.begin() + count));
+            pages.erase(pages.begin(), pages.begin() + count);
+
+            for (VirtualTextureLoadedPage& page : batch) {
+                allocateTile(page.pageKey, true);
+            }
+            uploadPages(vulkanDevice, batch, initialUpload);
+            initialUpload = false;
+
+            auto result = vulkanDevice.logicalDevice().waitForFences(1, &m_vkUploadFence, VK_TRUE, UINT64_MAX);
+            m_uploadInFlight = false;
+        }
+    }
+
+    void VulkanVirtualTexture::update(VulkanDevice& vulkanDevice, uint32_t frameIndex) {
+        m_frameCounter++;
+
+        readFeedback(frameIndex % m_frames.size());
+
+        if (m_uploadInFlight) {
+            if (vulkanDevice.logicalDevice().getFenceStatus(m_vkUploadFence) != vk::Result::eSuccess) {
+                return;
+            }
+            m_uploadInFlight = false;
+        }
+
+        std::vector<VirtualTextureLoadedPage> pages;
+        {
+            std::lock_guard<std::mutex> lock(m_loadedMutex);
+            size_t count = std::min<size_t>(m_loadedPages.size(), VIRTUAL_PAGES_PER_UPLOAD);
+            pages.assign(std::make_move_iterator(m_loadedPages.begin()), std::make_move_iterator(m_loadedPages.begin() + count));
+            m_loadedPages.erase(m_loadedPages.begin(), m_loadedPages.begin() + count);
+        }
+
+        if (!pages.empty()) {
+            for (VirtualTextureLoadedPage& page : pages) {
+                allocateTile(page.pageKey, false);
+            }
+            uploadPages(vulkanDevice, pages, false);
+        }
+    }
+
+    void VulkanVirtualTexture::readFeedback(uint32_t frameIndex) {
+        // this frame's previous submission has retired, so its feedback is complete and safe to clear
+        uint32_t* requests = m_frames[frameIndex].feedbackData;
+        std::vector<uint32_t> missingPages;
+
+        for (uint32_t mip = 0; mip < m_mipCount; mip++) {
+            uint32_t pages = VIRTUAL_PAGE_COUNT >> mip;
+            uint32_t* mipRequests = requests + m_pageOffsets[mip];
+            for (uint32_t y = 0; y < pages; y++) {
+                for (uint32_t x = 0; x < pages; x++) {
+                    if (mipRequests[y * pages + x] == 0) {
+                        continue;
+                    }
+                    mipRequests[y * pages + x] = 0;
+
+                    uint32_t pageKey = makePageKey(mip, x, y);
+                    auto resident = m_residentPages.find(pageKey);
+                    if (resident != m_residentPages.end()) {
+                        m_tiles[resident->second].lastUsedFrame = m_frameCounter;
+                    } else if (!m_pendingPages.contains(pageKey)) {
+                        missingPages.push_back(pageKey);
+                    }
+                }
+            }
+        }
+
+        // coarse pages cover more of the screen and are cheap, bring those in first
+        std::sort(missingPages.begin(), missingPages.end(), [](uint32_t a, uint32_t b) { return (a >> 24) > (b >> 24); });
+        if (missingPages.size() > VIRTUAL_REQUESTS_PER_FRAME) {
+            missingPages.resize(VIRTUAL_REQUESTS_PER_FRAME);
+        }
+
+        for (uint32_t pageKey : missingPages) {
+            requestPage(pageKey);
+        }
+    }
+
+    void VulkanVirtualTexture::requestPage(uint32_t pageKey, std::latch* loaded) {
+        m_pendingPages.insert(pageKey);
+        m_threadPool->submit([this, pageKey, loaded] {
+            try {
+                VirtualTextureLoadedPage page;
+                page.pageKey = pageKey;
+                page.texels.resize(VIRTUAL_TILE_BYTES);
+                readPage(pageKey, page.texels.data());
+
+                std::lock_guard<std::mutex> lock(m_loadedMutex);
+                m_loadedPages.push_back(std::move(page));
+            } catch (std::exception err) {
+                // nothing may escape a worker, a waiter has to be counted down either way
+                GN_CORE_ERROR("Failed to read virtual texture page {}: {}", pageKey, err.what());
+            }
+            if (loaded) {
+                loaded->count_down();
+            }
+        });
+    }
+
+    void VulkanVirtualTexture::readPage(uint32_t pageKey, uint8_t* texels) const {
+        uint32_t mip = pageKey >> 24;
+        uint32_t pageY = (pageKey >> 12) & 0xfff;
+        uint32_t pageX = pageKey & 0xfff;
+
+        // the source repeats across the virtual texture at its native resolution
+        uint32_t sourceMip = std::min(mip, m_source->mipLevels() - 1);
+        uint32_t sourceWidth = m_source->width(sourceMip);
+        uint32_t sourceHeight = m_source->height(sourceMip);
+        const uint8_t* source = m_source->mipData(sourceMip);
+        int32_t virtualSize = static_cast<int32_t>((VIRTUAL_PAGE_COUNT >> mip) * VIRTUAL_PAGE_SIZE);
+
+        for (uint32_t ty = 0; ty < VIRTUAL_TILE_SIZE; ty++) {
+            int32_t vy = static_cast<int32_t>(pageY * VIRTUAL_PAGE_SIZE + ty) - static_cast<int32_t>(VIRTUAL_PAGE_BORDER);
+            vy = (vy % virtualSize + virtualSize) % virtualSize;
+            const uint8_t* sourceRow = source + static_cast<size_t>(vy % sourceHeight) * sourceWidth * 4;
+
+            for (uint32_t tx = 0; tx < VIRTUAL_TILE_SIZE; tx++) {
+                int32_t vx = static_cast<int32_t>(pageX * VIRTUAL_PAGE_SIZE + tx) - static_cast<int32_t>(VIRTUAL_PAGE_BORDER);
+                vx = (vx % virtualSize + virtualSize) % virtualSize;
+                memcpy(texels + (ty * VIRTUAL_TILE_SIZE + tx) * 4, sourceRow + static_cast<size_t>(vx % sourceWidth) * 4, 4);
+            }
+        }
+    }
+
+    uint32_t VulkanVirtualTexture::allocateTile(uint32_t pageKey, bool pinned) {
+        uint32_t tileIndex;
+        if (!m_freeTiles.empty()) {
+            tileIndex = m_freeTiles.back();
+            m_freeTiles.pop_back();
+        } else {
+            // evict the least recently requested page
+            tileIndex = UINT32_MAX;
+            uint64_t oldestFrame = UINT64_MAX;
+            for (uint32_t i = 0; i < m_tiles.size(); i++) {
+                if (!m_tiles[i].pinned && m_tiles[i].lastUsedFrame < oldestFrame) {
+                    oldestFrame = m_tiles[i].lastUsedFrame;
+                    tileIndex = i;
+                }
+            }
+            m_residentPages.erase(m_tiles[tileIndex].pageKey);
+        }
+
+        m_tiles[tileIndex].pageKey = pageKey;
+        m_tiles[tileIndex].lastUsedFrame = m_frameCounter;
+        m_tiles[tileIndex].occupied = true;
+        m_tiles[tileIndex].pinned = pinned;
+        m_residentPages[pageKey] = tileIndex;
+        m_pendingPages.erase(pageKey);
+
+        return tileIndex;
+    }
+
+    void VulkanVirtualTexture::rebuildPageTable() {
+        // every entry points at its own page if resident, otherwise at whatever its parent resolves to
+        for (int32_t mip = static_cast<int32_t>(m_mipCount) - 1; mip >= 0; mip--) {
+            uint32_t pages = VIRTUAL_PAGE_COUNT >> mip;
+            uint32_t* entries = m_pageTableData.data() + m_pageOffsets[mip];
+            for (uint32_t y = 0; y < pages; y++) {
+                for (uint32_t x = 0; x < pages; x++) {
+                    auto resident = m_residentPages.find(makePageKey(mip, x, y));
+                    if (resident != m_residentPages.end()) {
+                        uint32_t tileX = resident->second % VIRTUAL_CACHE_TILES;
+                        uint32_t tileY = resident->second / VIRTUAL_CACHE_TILES;
+                        entries[y * pages + x] = tileX | (tileY << 8) | (static_cast<uint32_t>(mip) << 16) | (0xffu << 24);
+                    } else if (mip + 1 < static_cast<int32_t>(m_mipCount)) {
+                        uint32_t parentPages = pages >> 1;
+                        entries[y * pages + x] = m_pageTableData[m_pageOffsets[mip + 1] + (y / 2) * parentPages + (x / 2)];
+                    } else {
+                        entries[y * pages + x] = 0;
+                    }
+                }
+            }
+        }
+    }
+
+    void VulkanVirtualTexture::uploadPages(VulkanDevice& vulkanDevice, std::vector<VirtualTextureLoadedPage>& pages, bool initialUpload) {
+        vk::CommandBufferBeginInfo beginInfo = {};
+        beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+
+        try {
+            m_vkUploadCommandBuffer.reset();
+            m_vkUploadCommandBuffer.begin(beginInfo);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to begin virtual texture upload: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+
+        // earlier frames on this queue may still be sampling, the barrier orders the copies after them
+        vk::ImageLayout oldLayout = initialUpload ? vk::ImageLayout::eUndefined : vk::ImageLayout::eShaderReadOnlyOptimal;
+        vk::PipelineStageFlags srcStage = initialUpload ? vk::PipelineStageFlagBits::eTopOfPipe : vk::PipelineStageFlagBits::eFragmentShader;
+        recordBarrier(m_vkUploadCommandBuffer, m_pageCache.image(), 1, oldLayout, vk::ImageLayout::eTransferDstOptimal,
+                      srcStage, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlags(), vk::AccessFlagBits::eTransferWrite);
+        recordBarrier(m_vkUploadCommandBuffer, m_pageTable.image(), m_mipCount, oldLayout, vk::ImageLayout::eTransferDstOptimal,
+                      srcStage, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlags(), vk::AccessFlagBits::eTransferWrite);
+
+        std::vector<vk::BufferImageCopy> tileCopies;
+        for (size_t i = 0; i < pages.size(); i++) {
+            uint32_t tileIndex = m_residentPages[pages[i].pageKey];
+            memcpy(m_stagingData + i * VIRTUAL_TILE_BYTES, pages[i].texels.data(), static_cast<size_t>(VIRTUAL_TILE_BYTES));
+
+            vk::BufferImageCopy region = {};
+            region.bufferOffset = i * VIRTUAL_TILE_BYTES;
+            region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+            region.imageSubresource.mipLevel = 0;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = vk::Offset3D(static_cast<int32_t>((tileIndex % VIRTUAL_CACHE_TILES) * VIRTUAL_TILE_SIZE),
+                                              static_cast<int32_t>((tileIndex / VIRTUAL_CACHE_TILES) * VIRTUAL_TILE_SIZE),
+                                              0);
+            region.imageExtent = vk::Extent3D(VIRTUAL_TILE_SIZE, VIRTUAL_TILE_SIZE, 1);
+            tileCopies.push_back(region);
+        }
+        m_vkUploadCommandBuffer.copyBufferToImage(m_stagingBuffer.buffer(), m_pageCache.image(), vk::ImageLayout::eTransferDstOptimal, tileCopies);
+
+        rebuildPageTable();
+        vk::DeviceSize pageTableOffset = VIRTUAL_PAGES_PER_UPLOAD * VIRTUAL_TILE_BYTES;
+        memcpy(m_stagingData + pageTableOffset, m_pageTableData.data(), m_pageTableData.size() * sizeof(uint32_t));
+
+        std::vector<vk::BufferImageCopy> pageTableCopies;
+        for (uint32_t mip = 0; mip < m_mipCount; mip++) {
+            uint32_t pages = VIRTUAL_PAGE_COUNT >> mip;
+            vk::BufferImageCopy region = {};
+            region.bufferOffset = pageTableOffset + m_pageOffsets[mip] * sizeof(uint32_t);
+            region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+            region.imageSubresource.mipLevel = mip;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = vk::Offset3D(0, 0, 0);
+            region.imageExtent = vk::Extent3D(pages, pages, 1);
+            pageTableCopies.push_back(region);
+        }
+        m_vkUploadCommandBuffer.copyBufferToImage(m_stagingBuffer.buffer(), m_pageTable.image(), vk::ImageLayout::eTransferDstOptimal, pageTableCopies);
+
+        recordBarrier(m_vkUploadCommandBuffer, m_pageCache.image(), 1, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+                      vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead);
+        recordBarrier(m_vkUploadCommandBuffer, m_pageTable.image(), m_mipCount, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+                      vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead);
+
+        vk::SubmitInfo submitInfo = {};
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &m_vkUploadCommandBuffer;
+
+        try {
+            m_vkUploadCommandBuffer.end();
+            auto result = vulkanDevice.logicalDevice().resetFences(1, &m_vkUploadFence);
+            vulkanDevice.graphicsQueue().submit(submitInfo, m_vkUploadFence);
+        } catch (vk::SystemError err) {
+            std::string errMsg = "Failed to submit virtual texture upload: ";
+            GN_CORE_ERROR("{}{}", errMsg, err.what());
+            throw std::runtime_error(errMsg + err.what());
+        }
+        m_uploadInFlight = true;
+
+        GN_CORE_TRACE2("Virtual texture uploaded {} pages, {} resident.", pages.size(), m_residentPages.size());
+    }
+
+    void VulkanVirtualTexture::recordBarrier(vk::CommandBuffer commandBuffer,
+                                             vk::Image image,
+                                             uint32_t mipLevels,
+                                             vk::ImageLayout oldLayout,
+                                             vk::ImageLayout newLayout,
+                                             vk::PipelineStageFlags srcStage,
+                                             vk::PipelineStageFlags dstStage,
+                                             vk::AccessFlags srcAccess,
+                                             vk::AccessFlags dstAccess) {
+        vk::ImageMemoryBarrier barrier = {};
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = mipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+
+        commandBuffer.pipelineBarrier(srcStage, dstStage, vk::DependencyFlags(), nullptr, nullptr, barrier);
+    }
+
+    void VulkanVirtualTexture::bind(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t frameIndex) {
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 2, m_frames[frameIndex % m_frames.size()].descriptorSet, nullptr);
+    }
+
+    void VulkanVirtualTexture::recordFeedbackBarrier(vk::CommandBuffer commandBuffer) {
+        // make the fragment shader's feedback writes visible to the host once the frame fence signals
+        vk::MemoryBarrier barrier = {};
+        barrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader,
+                                      vk::PipelineStageFlagBits::eHost,
+                                      vk::DependencyFlags(),
+                                      barrier,
+                                      nullptr,
+                                      nullptr);
+    }
+
+    VirtualTextureParams VulkanVirtualTexture::params(bool useVirtualTexture) const {
+        VirtualTextureParams params = {};
+        params.enabled = (m_enabled && useVirtualTexture) ? 1 : 0;
+        // only one pixel out of every 4x4 block writes feedback each frame, cycling through the block over 16 frames
+        params.feedbackJitter = static_cast<uint32_t>(m_frameCounter % 16);
+        params.pageSize = VIRTUAL_PAGE_SIZE;
+        params.pageBorder = VIRTUAL_PAGE_BORDER;
+        params.pageCount = VIRTUAL_PAGE_COUNT;
+        params.mipCount = m_mipCount;
+        params.cacheTiles = VIRTUAL_CACHE_TILES;
+        return params;
+    }
+
+    void VulkanVirtualTexture::shutdown(VulkanDevice& vulkanDevice) {
+        if (m_threadPool) {
+            m_threadPool->waitIdle();
+        }
+        if (m_uploadInFlight) {
+            auto result = vulkanDevice.logicalDevice().waitForFences(1, &m_vkUploadFence, VK_TRUE, UINT64_MAX);
+        }
+
+        for (VirtualTextureFrame& frame : m_frames) {
+            frame.feedbackBuffer.destroy(vulkanDevice);
+        }
+        m_frames.clear();
+
+        m_stagingBuffer.destroy(vulkanDevice);
+        vulkanDevice.logicalDevice().destroyFence(m_vkUploadFence);
+        vulkanDevice.logicalDevice().freeCommandBuffers(m_vkCommandPool, m_vkUploadCommandBuffer);
+
+        m_pageCache.destroyImageView(vulkanDevice);
+        m_pageCache.destroyImage(vulkanDevice);
+        m_pageCache.freeImageMemory(vulkanDevice);
+        m_pageTable.destroyImageView(vulkanDevice);
+        m_pageTable.destroyImage(vulkanDevice);
+        m_pageTable.freeImageMemory(vulkanDevice);
+
+        vulkanDevice.logicalDevice().destroyDescriptorPool(m_vkDescriptorPool);
+        vulkanDevice.logicalDevice().destroyDescriptorSetLayout(m_vkDescriptorSetLayout);
+    }
+}  // namespace Genesis
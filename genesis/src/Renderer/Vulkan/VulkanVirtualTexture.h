@@ -0,0 +1,114 @@
+#pragma once
+
+#include <latch>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Core/ThreadPool.h"
+#include "Resources/TextureData.h"
+#include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+#include "VulkanImage.h"
+#include "VulkanTypes.h"
+
+namespace Genesis {
+    struct VirtualTextureTile {
+            uint32_t pageKey;
+            uint64_t lastUsedFrame;
+            bool occupied;
+            bool pinned;
+    };
+
+    struct VirtualTextureLoadedPage {
+            uint32_t pageKey;
+            std::vector<uint8_t> texels;
+    };
+
+    struct VirtualTextureFrame {
+            VulkanBuffer feedbackBuffer;
+            uint32_t* feedbackData;
+            vk::DescriptorSet descriptorSet;
+    };
+
+    // Software virtual texture: a fixed size cache of bordered pages, a page table with one mip per virtual mip
+    // and a per-frame feedback buffer the fragment shader marks requested pages in. VRAM use does not depend on
+    // the size of the source data, pages are produced on worker threads and only the resident working set is uploaded.
+    class VulkanVirtualTexture {
+        public:
+            VulkanVirtualTexture();
+            ~VulkanVirtualTexture();
+
+            VulkanVirtualTexture(const VulkanVirtualTexture&) = delete;
+            VulkanVirtualTexture& operator=(const VulkanVirtualTexture&) = delete;
+
+            vk::DescriptorSetLayout const& descriptorSetLayout() const { return m_vkDescriptorSetLayout; }
+            bool isEnabled() const { return m_enabled; }
+
+            void createDescriptorSetLayout(VulkanDevice& vulkanDevice);
+            void init(VulkanDevice& vulkanDevice, vk::CommandPool commandPool, ThreadPool& threadPool, std::string filename, uint32_t frameCount);
+            void update(VulkanDevice& vulkanDevice, uint32_t frameIndex);
+            void bind(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t frameIndex);
+            void recordFeedbackBarrier(vk::CommandBuffer commandBuffer);
+            VirtualTextureParams params(bool useVirtualTexture) const;
+            void shutdown(VulkanDevice& vulkanDevice);
+
+        private:
+            void createImages(VulkanDevice& vulkanDevice);
+            void createSamplers(VulkanDevice& vulkanDevice);
+            void createFrameResources(VulkanDevice& vulkanDevice, uint32_t frameCount);
+            void createDescriptorSets(VulkanDevice& vulkanDevice);
+            void loadPinnedPages(VulkanDevice& vulkanDevice);
+
+            void readFeedback(uint32_t frameIndex);
+            // reads the page on a worker, loaded is counted down once it has been read when given
+            void requestPage(uint32_t pageKey, std::latch* loaded = nullptr);
+            void readPage(uint32_t pageKey, uint8_t* texels) const;
+            uint32_t allocateTile(uint32_t pageKey, bool pinned);
+            void rebuildPageTable();
+            void uploadPages(VulkanDevice& vulkanDevice, std::vector<VirtualTextureLoadedPage>& pages, bool initialUpload);
+            void recordBarrier(vk::CommandBuffer commandBuffer,
+                               vk::Image image,
+                               uint32_t mipLevels,
+                               vk::ImageLayout oldLayout,
+                               vk::ImageLayout newLayout,
+                               vk::PipelineStageFlags srcStage,
+                               vk::PipelineStageFlags dstStage,
+                               vk::AccessFlags srcAccess,
+                               vk::AccessFlags dstAccess);
+
+            bool m_enabled = false;
+            ThreadPool* m_threadPool = nullptr;
+            std::unique_ptr<TextureData> m_source;
+
+            uint32_t m_mipCount = 0;
+            std::vector<uint32_t> m_pageOffsets;
+            uint32_t m_totalPages = 0;
+            uint64_t m_frameCounter = 0;
+
+            VulkanImage m_pageCache;
+            VulkanImage m_pageTable;
+            vk::Sampler m_vkCacheSampler;
+            vk::Sampler m_vkPageTableSampler;
+
+            std::vector<VirtualTextureTile> m_tiles;
+            std::vector<uint32_t> m_freeTiles;
+            std::unordered_map<uint32_t, uint32_t> m_residentPages;
+            std::unordered_set<uint32_t> m_pendingPages;
+            std::vector<uint32_t> m_pageTableData;
+
+            std::mutex m_loadedMutex;
+            std::vector<VirtualTextureLoadedPage> m_loadedPages;
+
+            vk::CommandPool m_vkCommandPool;
+            vk::CommandBuffer m_vkUploadCommandBuffer;
+            vk::Fence m_vkUploadFence;
+            bool m_uploadInFlight = false;
+            VulkanBuffer m_stagingBuffer;
+            uint8_t* m_stagingData = nullptr;
+
+            std::vector<VirtualTextureFrame> m_frames;
+            vk::DescriptorSetLayout m_vkDescriptorSetLayout;
+            vk::DescriptorPool m_vkDescriptorPool;
+    };
+}  // namespace Genesis
@@ -0,0 +1,98 @@
+#include "SkylinePacker.h"
+
+namespace Genesis {
+    SkylinePacker::SkylinePacker(uint32_t width, uint32_t height) : m_width(width), m_height(height) {
+        reset();
+    }
+
+    SkylinePacker::~SkylinePacker() {
+    }
+
+    void SkylinePacker::reset() {
+        m_nodes.clear();
+        m_nodes.push_back({0, 0, m_width});
+        m_usedArea = 0;
+    }
+
+    std::optional<PackedRect> SkylinePacker::insert(uint32_t width, uint32_t height) {
+        // pick the position with the lowest resulting top edge, ties go to the narrowest node to limit waste
+        size_t bestIndex = SIZE_MAX;
+        uint32_t bestTop = UINT32_MAX;
+        uint32_t bestWidth = UINT32_MAX;
+        PackedRect rect = {0, 0, width, height};
+
+        for (size_t i = 0; i < m_nodes.size(); i++) {
+            std::optional<uint32_t> y = fit(i, width, height);
+            if (!y) {
+                continue;
+            }
+
+            uint32_t top = *y + height;
+            if (top < bestTop || (top == bestTop && m_nodes[i].width < bestWidth)) {
+                bestIndex = i;
+                bestTop = top;
+                bestWidth = m_nodes[i].width;
+                rect.x = m_nodes[i].x;
+                rect.y = *y;
+            }
+        }
+
+        if (bestIndex == SIZE_MAX) {
+            return std::nullopt;
+        }
+
+        addLevel(bestIndex, rect);
+        m_usedArea += static_cast<uint64_t>(width) * height;
+        return rect;
+    }
+
+    std::optional<uint32_t> SkylinePacker::fit(size_t nodeIndex, uint32_t width, uint32_t height) const {
+        uint32_t x = m_nodes[nodeIndex].x;
+        if (x + width > m_width) {
+            return std::nullopt;
+        }
+
+        // the rectangle rests on the highest node it spans
+        uint32_t y = 0;
+        uint32_t widthLeft = width;
+        for (size_t i = nodeIndex; widthLeft > 0; i++) {
+            y = std::max(y, m_nodes[i].y);
+            if (y + height > m_height) {
+                return std::nullopt;
+            }
+            widthLeft -= std::min(widthLeft, m_nodes[i].width);
+        }
+        return y;
+    }
+
+    void SkylinePacker::addLevel(size_t nodeIndex, const PackedRect& rect) {
+        m_nodes.insert(m_nodes.begin() + nodeIndex, {rect.x, rect.y + rect.height, rect.width});
+
+        // trim or drop the nodes now covered by the new one
+        for (size_t i = nodeIndex + 1; i < m_nodes.size();) {
+            uint32_t coveredEnd = m_nodes[i - 1].x + m_nodes[i - 1].width;
+            if (m_nodes[i].x >= coveredEnd) {
+                break;
+            }
+
+            uint32_t shrink = coveredEnd - m_nodes[i].x;
+            if (m_nodes[i].width <= shrink) {
+                m_nodes.erase(m_nodes.begin() + i);
+                continue;
+            }
+            m_nodes[i].x += shrink;
+            m_nodes[i].width -= shrink;
+            break;
+        }
+
+        // neighbours at the same height become one node
+        for (size_t i = 0; i + 1 < m_nodes.size();) {
+            if (m_nodes[i].y == m_nodes[i + 1].y) {
+                m_nodes[i].width += m_nodes[i + 1].width;
+                m_nodes.erase(m_nodes.begin() + i + 1);
+            } else {
+                i++;
+            }
+        }
+    }
+}  // namespace Genesis
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <optional>
+
+namespace Genesis {
+    struct PackedRect {
+            uint32_t x;
+            uint32_t y;
+            uint32_t width;
+            uint32_t height;
+    };
+
+    // Bottom-left skyline rectangle packer. The free space is described by the top edge of everything placed so
+    // far, which keeps inserts cheap and works well for many small rectangles of similar height.
+    class SkylinePacker {
+        public:
+            SkylinePacker(uint32_t width, uint32_t height);
+            ~SkylinePacker();
+
+            uint32_t width() const { return m_width; }
+            uint32_t height() const { return m_height; }
+            uint64_t usedArea() const { return m_usedArea; }
+            float occupancy() const { return static_cast<float>(m_usedArea) / (static_cast<float>(m_width) * m_height); }
+
+            std::optional<PackedRect> insert(uint32_t width, uint32_t height);
+            void reset();
+
+        private:
+            struct SkylineNode {
+                    uint32_t x;
+                    uint32_t y;
+                    uint32_t width;
+            };
+
+            std::optional<uint32_t> fit(size_t nodeIndex, uint32_t width, uint32_t height) const;
+            void addLevel(size_t nodeIndex, const PackedRect& rect);
+
+            uint32_t m_width;
+            uint32_t m_height;
+            uint64_t m_usedArea = 0;
+            std::vector<SkylineNode> m_nodes;
+    };
+}  // namespace Genesis
@@ -0,0 +1,124 @@
+#include "TextureData.h"
+
+// this code is to work around a GCC bug when also using FMT (which is included by quill logger)
+#if defined(__GNUC__) && !defined(NDEBUG) && defined(__OPTIMIZE__)
+    #undef __OPTIMIZE__
+#endif
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    static float srgbToLinear(float value) {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    // every byte decoded once, the filter only looks values up
+    static const std::array<float, 256>& srgbDecodeTable() {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> values;
+            for (uint32_t i = 0; i < values.size(); i++) {
+                values[i] = srgbToLinear(i / 255.0f);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    // the linear values halfway between neighbouring bytes, searching them rounds to the nearest byte in sRGB space
+    static const std::array<float, 255>& srgbEncodeThresholds() {
+        static const std::array<float, 255> table = [] {
+            std::array<float, 255> values;
+            for (uint32_t i = 0; i < values.size(); i++) {
+                values[i] = srgbToLinear((i + 0.5f) / 255.0f);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    TextureData::TextureData(std::string filename) : m_filename(filename) {
+        load();
+        generateMipChain();
+    }
+
+    TextureData::~TextureData() {
+    }
+
+    void TextureData::load() {
+        int width, height, channels;
+        stbi_uc* pixels = stbi_load(m_filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+        if (!pixels) {
+            std::string errMsg = "Failed to load texture image: ";
+            GN_CORE_ERROR("{}{}", errMsg, m_filename);
+            throw std::runtime_error(errMsg + m_filename);
+        }
+
+        uint32_t mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+        m_mipOffsets.resize(mipLevels);
+        m_mipWidths.resize(mipLevels);
+        m_mipHeights.resize(mipLevels);
+
+        size_t totalSize = 0;
+        uint32_t mipWidth = static_cast<uint32_t>(width);
+        uint32_t mipHeight = static_cast<uint32_t>(height);
+        for (uint32_t level = 0; level < mipLevels; level++) {
+            m_mipOffsets[level] = totalSize;
+            m_mipWidths[level] = mipWidth;
+            m_mipHeights[level] = mipHeight;
+            totalSize += static_cast<size_t>(mipWidth) * mipHeight * 4;
+
+            mipWidth = std::max(mipWidth / 2, 1u);
+            mipHeight = std::max(mipHeight / 2, 1u);
+        }
+
+        m_mipChain.resize(totalSize);
+        memcpy(m_mipChain.data(), pixels, static_cast<size_t>(width) * height * 4);
+
+        stbi_image_free(pixels);
+    }
+
+    void TextureData::generateMipChain() {
+        // each level is built from the one above it
+        for (uint32_t level = 1; level < mipLevels(); level++) {
+            downsample(m_mipChain.data() + m_mipOffsets[level - 1],
+                       m_mipWidths[level - 1],
+                       m_mipHeights[level - 1],
+                       m_mipChain.data() + m_mipOffsets[level],
+                       m_mipWidths[level],
+                       m_mipHeights[level]);
+        }
+    }
+
+    void TextureData::downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight) {
+        const std::array<float, 256>& decode = srgbDecodeTable();
+        const std::array<float, 255>& thresholds = srgbEncodeThresholds();
+
+        for (uint32_t y = 0; y < dstHeight; y++) {
+            uint32_t y0 = std::min(y * 2, srcHeight - 1);
+            uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+            for (uint32_t x = 0; x < dstWidth; x++) {
+                uint32_t x0 = std::min(x * 2, srcWidth - 1);
+                uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+                const uint8_t* texels[4] = {src + (y0 * srcWidth + x0) * 4,
+                                            src + (y0 * srcWidth + x1) * 4,
+                                            src + (y1 * srcWidth + x0) * 4,
+                                            src + (y1 * srcWidth + x1) * 4};
+                uint8_t* out = dst + (y * dstWidth + x) * 4;
+
+                for (uint32_t c = 0; c < 3; c++) {
+                    float linear = (decode[texels[0][c]] + decode[texels[1][c]] + decode[texels[2][c]] + decode[texels[3][c]]) * 0.25f;
+                    out[c] = static_cast<uint8_t>(std::upper_bound(thresholds.begin(), thresholds.end(), linear) - thresholds.begin());
+                }
+                uint32_t alpha = texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3];
+                out[3] = static_cast<uint8_t>((alpha + 2) / 4);
+            }
+        }
+    }
+}  // namespace Genesis
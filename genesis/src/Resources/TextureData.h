@@ -0,0 +1,37 @@
+#pragma once
+
+namespace Genesis {
+    // Decoded sRGB RGBA8 image together with its full box-filtered mip chain, stored contiguously from mip 0 down.
+    // Decoding and filtering are slow, construct it on a worker thread.
+    class TextureData {
+        public:
+            TextureData(std::string filename);
+            ~TextureData();
+
+            TextureData(const TextureData&) = delete;
+            TextureData& operator=(const TextureData&) = delete;
+
+            std::string const& filename() const { return m_filename; }
+            uint32_t mipLevels() const { return static_cast<uint32_t>(m_mipOffsets.size()); }
+            uint32_t width(uint32_t mipLevel = 0) const { return m_mipWidths[mipLevel]; }
+            uint32_t height(uint32_t mipLevel = 0) const { return m_mipHeights[mipLevel]; }
+            size_t mipOffset(uint32_t mipLevel) const { return m_mipOffsets[mipLevel]; }
+            size_t size() const { return m_mipChain.size(); }
+            const uint8_t* data() const { return m_mipChain.data(); }
+            const uint8_t* mipData(uint32_t mipLevel) const { return m_mipChain.data() + m_mipOffsets[mipLevel]; }
+
+            // Halves an sRGB RGBA8 image with a 2x2 box filter, odd sizes clamp at the last row and column. Colour is
+            // averaged in linear light and encoded again, averaging the encoded bytes would darken every level.
+            static void downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight);
+
+        private:
+            void load();
+            void generateMipChain();
+
+            std::string m_filename;
+            std::vector<uint8_t> m_mipChain;
+            std::vector<size_t> m_mipOffsets;
+            std::vector<uint32_t> m_mipWidths;
+            std::vector<uint32_t> m_mipHeights;
+    };
+}  // namespace Genesis
@@ -0,0 +1,56 @@
+#include "TextureDecoder.h"
+
+#include "Core/Logger.h"
+
+namespace Genesis {
+    TextureDecoder::TextureDecoder(ThreadPool& threadPool) : m_threadPool(threadPool) {
+    }
+
+    TextureDecoder::~TextureDecoder() {
+        // jobs hold a pointer to this decoder, drain them before it goes away
+        while (m_outstanding > 0) {
+            try {
+                next();
+            } catch (const std::exception&) {
+            }
+        }
+    }
+
+    void TextureDecoder::submit(std::string filename) {
+        m_outstanding++;
+        m_threadPool.submit([this, filename] {
+            DecodeResult result;
+            try {
+                result.textureData = std::make_unique<TextureData>(filename);
+            } catch (...) {
+                result.error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_results.push(std::move(result));
+            }
+            m_resultReady.notify_one();
+        });
+    }
+
+    std::unique_ptr<TextureData> TextureDecoder::next() {
+        if (m_outstanding == 0) {
+            return nullptr;
+        }
+
+        DecodeResult result;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_resultReady.wait(lock, [this] { return !m_results.empty(); });
+            result = std::move(m_results.front());
+            m_results.pop();
+        }
+        m_outstanding--;
+
+        if (result.error) {
+            std::rethrow_exception(result.error);
+        }
+        return std::move(result.textureData);
+    }
+}  // namespace Genesis
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <queue>
+
+#include "Core/ThreadPool.h"
+#include "Resources/TextureData.h"
+
+namespace Genesis {
+    // Decodes image files on a worker pool, one file per job, and hands the results back in the order they finish
+    // so the uploader can start on whatever is ready instead of waiting on the slowest file.
+    class TextureDecoder {
+        public:
+            TextureDecoder(ThreadPool& threadPool);
+            ~TextureDecoder();
+
+            TextureDecoder(const TextureDecoder&) = delete;
+            TextureDecoder& operator=(const TextureDecoder&) = delete;
+
+            uint32_t outstanding() const { return m_outstanding; }
+
+            void submit(std::string filename);
+            // blocks until the next decode finishes, returns nullptr once every submitted file has been returned
+            std::unique_ptr<TextureData> next();
+
+        private:
+            struct DecodeResult {
+                    std::unique_ptr<TextureData> textureData;
+                    std::exception_ptr error;
+            };
+
+            ThreadPool& m_threadPool;
+            uint32_t m_outstanding = 0;
+
+            std::mutex m_mutex;
+            std::condition_variable m_resultReady;
+            std::queue<DecodeResult> m_results;
+    };
+}  // namespace Genesis
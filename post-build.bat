@@ -13,6 +13,26 @@ echo "assets/shaders/shader.frag.glsl -> bin/assets/shaders/shader.frag.spv"
 %VULKAN_SDK%\bin\glslc.exe -fshader-stage=frag assets/shaders/shader.frag.glsl -o bin/assets/shaders/shader.frag.spv
 IF %ERRORLEVEL% NEQ 0 (echo Error: %ERRORLEVEL% && exit)
 
+echo "assets/shaders/shader.frag.glsl -> bin/assets/shaders/shader.bindless.frag.spv"
+%VULKAN_SDK%\bin\glslc.exe -fshader-stage=frag -DBINDLESS --target-env=vulkan1.2 assets/shaders/shader.frag.glsl -o bin/assets/shaders/shader.bindless.frag.spv
+IF %ERRORLEVEL% NEQ 0 (echo Error: %ERRORLEVEL% && exit)
+
+echo "assets/shaders/shader.frag.glsl -> bin/assets/shaders/shader.nofeedback.frag.spv"
+%VULKAN_SDK%\bin\glslc.exe -fshader-stage=frag -DNO_FEEDBACK assets/shaders/shader.frag.glsl -o bin/assets/shaders/shader.nofeedback.frag.spv
+IF %ERRORLEVEL% NEQ 0 (echo Error: %ERRORLEVEL% && exit)
+
+echo "assets/shaders/shader.frag.glsl -> bin/assets/shaders/shader.bindless.nofeedback.frag.spv"
+%VULKAN_SDK%\bin\glslc.exe -fshader-stage=frag -DBINDLESS -DNO_FEEDBACK --target-env=vulkan1.2 assets/shaders/shader.frag.glsl -o bin/assets/shaders/shader.bindless.nofeedback.frag.spv
+IF %ERRORLEVEL% NEQ 0 (echo Error: %ERRORLEVEL% && exit)
+
+echo "assets/shaders/shader.vert.glsl -> bin/assets/shaders/shader.culled.vert.spv"
+%VULKAN_SDK%\bin\glslc.exe -fshader-stage=vert -DCULLING assets/shaders/shader.vert.glsl -o bin/assets/shaders/shader.culled.vert.spv
+IF %ERRORLEVEL% NEQ 0 (echo Error: %ERRORLEVEL% && exit)
+
+echo "assets/shaders/cull.comp.glsl -> bin/assets/shaders/cull.comp.spv"
+%VULKAN_SDK%\bin\glslc.exe -fshader-stage=comp --target-env=vulkan1.1 assets/shaders/cull.comp.glsl -o bin/assets/shaders/cull.comp.spv
+IF %ERRORLEVEL% NEQ 0 (echo Error: %ERRORLEVEL% && exit)
+
 echo "Copying assets..."
 echo xcopy "assets" "bin\assets" /h /i /c /k /e /r /y
 xcopy "assets" "bin\assets" /h /i /c /k /e /r /y
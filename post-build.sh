@@ -22,6 +22,46 @@ then
 echo "Error:"$ERRORLEVEL && exit
 fi
 
+echo "assets/shaders/shader.frag.glsl -> bin/assets/shader/shader.bindless.frag.spv"
+$VULKAN_SDK/bin/glslc -fshader-stage=frag -DBINDLESS --target-env=vulkan1.2 assets/shaders/shader.frag.glsl -o bin/assets/shaders/shader.bindless.frag.spv
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
+echo "assets/shaders/shader.frag.glsl -> bin/assets/shader/shader.nofeedback.frag.spv"
+$VULKAN_SDK/bin/glslc -fshader-stage=frag -DNO_FEEDBACK assets/shaders/shader.frag.glsl -o bin/assets/shaders/shader.nofeedback.frag.spv
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
+echo "assets/shaders/shader.frag.glsl -> bin/assets/shader/shader.bindless.nofeedback.frag.spv"
+$VULKAN_SDK/bin/glslc -fshader-stage=frag -DBINDLESS -DNO_FEEDBACK --target-env=vulkan1.2 assets/shaders/shader.frag.glsl -o bin/assets/shaders/shader.bindless.nofeedback.frag.spv
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
+echo "assets/shaders/shader.vert.glsl -> bin/assets/shader/shader.culled.vert.spv"
+$VULKAN_SDK/bin/glslc -fshader-stage=vert -DCULLING assets/shaders/shader.vert.glsl -o bin/assets/shaders/shader.culled.vert.spv
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
+echo "assets/shaders/cull.comp.glsl -> bin/assets/shader/cull.comp.spv"
+$VULKAN_SDK/bin/glslc -fshader-stage=comp --target-env=vulkan1.1 assets/shaders/cull.comp.glsl -o bin/assets/shaders/cull.comp.spv
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
 echo "Copying assets..."
 echo cp -R "assets" "bin"
 cp -R "assets" "bin"